@@ -9,6 +9,7 @@
  */
 
 #include <cstring>
+#include <unordered_map>
 #include "anti_tear/anti_tearer.h"
 #include "anti_tear/anti_tear.h"
 #include "display/display.h"
@@ -24,14 +25,49 @@ static bool ANTI_TEARING_ENABLED = false;
 
 static anti_tearer_c ANTI_TEARER;
 
-u8* kat_anti_tear(u8 *const pixels, const resolution_s &r)
+// Anti-tearers for input channels being captured concurrently with the current
+// one, keyed by channel index. Their back buffers are separate from
+// ANTI_TEARER's, but their parameters are kept in sync with it.
+static std::unordered_map<unsigned, anti_tearer_c*> CONCURRENT_ANTI_TEARERS;
+
+// Returns the anti-tearer for the given input channel, creating it if need be.
+static anti_tearer_c& anti_tearer_of(const unsigned channelIdx)
+{
+    if (channelIdx == kc_get_device_input_channel_idx())
+    {
+        return ANTI_TEARER;
+    }
+
+    anti_tearer_c *&antiTearer = CONCURRENT_ANTI_TEARERS[channelIdx];
+
+    if (!antiTearer)
+    {
+        antiTearer = new anti_tearer_c;
+        antiTearer->initialize({MAX_CAPTURE_WIDTH, MAX_CAPTURE_HEIGHT, MAX_CAPTURE_BPP});
+    }
+
+    antiTearer->scanStartOffset = ANTI_TEARER.scanStartOffset;
+    antiTearer->scanEndOffset = ANTI_TEARER.scanEndOffset;
+    antiTearer->scanDirection = ANTI_TEARER.scanDirection;
+    antiTearer->scanHint = ANTI_TEARER.scanHint;
+    antiTearer->threshold = ANTI_TEARER.threshold;
+    antiTearer->stepSize = ANTI_TEARER.stepSize;
+    antiTearer->windowLength = ANTI_TEARER.windowLength;
+    antiTearer->matchesRequired = ANTI_TEARER.matchesRequired;
+    antiTearer->visualizeTears = ANTI_TEARER.visualizeTears;
+    antiTearer->visualizeScanRange = ANTI_TEARER.visualizeScanRange;
+
+    return *antiTearer;
+}
+
+u8* kat_anti_tear(u8 *const pixels, const resolution_s &r, const unsigned channelIdx)
 {
     if (!ANTI_TEARING_ENABLED)
     {
         return pixels;
     }
 
-    return ANTI_TEARER.process(pixels, r);
+    return anti_tearer_of(channelIdx).process(pixels, r);
 }
 
 void kat_initialize_anti_tear(void)
@@ -51,6 +87,14 @@ void kat_release_anti_tear(void)
 
     ANTI_TEARER.release();
 
+    for (auto &antiTearer: CONCURRENT_ANTI_TEARERS)
+    {
+        antiTearer.second->release();
+        delete antiTearer.second;
+    }
+
+    CONCURRENT_ANTI_TEARERS.clear();
+
     return;
 }
 
@@ -61,6 +105,11 @@ void kat_set_anti_tear_enabled(const bool state)
     return;
 }
 
+bool kat_is_anti_tear_enabled(void)
+{
+    return ANTI_TEARING_ENABLED;
+}
+
 void kat_set_visualization(const bool visualizeTear,
                            const bool visualizeRange)
 {
@@ -164,6 +164,11 @@ void kat_release_anti_tear(void);
  * 
  * The input data won't be modified. 
  * 
+ * @p channelIdx identifies the input channel the image was captured from. Each
+ * channel is de-torn separately, so that images captured concurrently from
+ * different channels (see kc_open_concurrent_input_channel()) don't get mixed.
+ * All channels share the same anti-tearing parameters.
+ * 
  * @note
  * This function returns the most recent fully de-torn image; meaning e.g. that if
  * an image is torn into two consecutive frames, the effective frame rate of the
@@ -182,7 +187,7 @@ void kat_release_anti_tear(void);
  * @see
  * kat_set_anti_tear_enabled()
  */
-u8* kat_anti_tear(u8 *const pixels, const resolution_s &r);
+u8* kat_anti_tear(u8 *const pixels, const resolution_s &r, const unsigned channelIdx);
 
 /*!
  * Sets the current anti-tearing scan hint.
@@ -225,6 +230,14 @@ void kat_set_range(const u32 min, const u32 max);
  */
 void kat_set_anti_tear_enabled(const bool state);
 
+/*!
+ * Returns true if anti-tearing is enabled; false otherwise.
+ *
+ * @see
+ * kat_set_anti_tear_enabled()
+ */
+bool kat_is_anti_tear_enabled(void);
+
 /*!
  * Toggles visualizing options.
  * 
@@ -6,9 +6,18 @@
  *
  */
 
+#include <atomic>
+#include <map>
 #include "common/propagate/vcs_event.h"
 #include "capture/capture.h"
+#include "capture/capture_event_queue.h"
 #include "common/timer/timer.h"
+#include "common/command_line/command_line.h"
+
+#ifdef __linux__
+    #include <sys/eventfd.h>
+    #include <unistd.h>
+#endif
 
 vcs_event_c<const captured_frame_s&> kc_evNewCapturedFrame;
 vcs_event_c<const video_mode_s&> kc_evNewProposedVideoMode;
@@ -20,6 +29,7 @@ vcs_event_c<void> kc_evSignalGained;
 vcs_event_c<void> kc_evInvalidSignal;
 vcs_event_c<void> kc_evUnrecoverableError;
 vcs_event_c<unsigned> kc_evMissedFramesCount;
+vcs_event_c<unsigned> kc_evUniqueFramesPerSecond;
 
 // We'll keep a running count of the number of frames we've missed, in total,
 // during capturing.
@@ -27,6 +37,37 @@ static unsigned LAST_KNOWN_MISSED_FRAMES_COUNT = 0;
 
 static std::mutex CAPTURE_MUTEX;
 
+// Capture events waiting to be handled by the main VCS thread.
+static capture_event_queue_c CAPTURE_EVENT_QUEUE;
+
+// An eventfd counter through which the capture subsystem wakes up the main VCS
+// thread when it has new capture events. Will be -1 if not available.
+static int CAPTURE_EVENT_FD = -1;
+
+// The time (steady_clock ticks) at which the capture device reported a new
+// video mode for which no valid frame has yet been captured; or 0 if there's no
+// such mode.
+static std::atomic<std::chrono::steady_clock::rep> PENDING_VIDEO_MODE_CHANGE_TIME = {0};
+
+// In milliseconds; see kc_get_video_mode_change_latency().
+static double VIDEO_MODE_CHANGE_LATENCY = -1;
+
+// Read by the capture threads for each frame they capture.
+static std::atomic<duplicate_frame_handling_e> DUPLICATE_FRAME_HANDLING = {duplicate_frame_handling_e::none};
+
+// In Hz, or 0 for no limit. Read by the capture threads for each frame they
+// capture; see kc_set_frame_rate_limit().
+static std::atomic<double> FRAME_RATE_LIMIT = {0};
+
+// For keeping track of the number of unique frames per second on each input
+// channel, keyed by the channel's index; see kc_get_unique_frame_rate().
+static std::map<unsigned, unsigned> NUM_UNIQUE_FRAMES_THIS_SECOND;
+static std::map<unsigned, unsigned> UNIQUE_FRAME_RATE;
+
+// The intervals between the current input channel's frames; see
+// kc_get_frame_interval_stats().
+static frame_interval_tracker_c FRAME_INTERVALS;
+
 std::mutex& kc_capture_mutex(void)
 {
     return CAPTURE_MUTEX;
@@ -36,8 +77,70 @@ void kc_initialize_capture(void)
 {
      INFO(("Initializing the capture subsystem."));
 
+    #ifdef __linux__
+        CAPTURE_EVENT_FD = eventfd(0, (EFD_NONBLOCK | EFD_CLOEXEC));
+
+        if (CAPTURE_EVENT_FD < 0)
+        {
+            DEBUG(("Failed to create the capture event fd (error %d). Falling back to polling.", errno));
+        }
+    #endif
+
+    DUPLICATE_FRAME_HANDLING = kcom_duplicate_frame_handling();
+    FRAME_RATE_LIMIT = kcom_frame_rate_limit();
+
     kc_initialize_device();
 
+    kc_evNewCapturedFrame.listen([](const captured_frame_s &frame)
+    {
+        if (!frame.isDuplicate)
+        {
+            NUM_UNIQUE_FRAMES_THIS_SECOND[frame.channel]++;
+        }
+    });
+
+    kc_evNewCapturedFrame.listen([](const captured_frame_s &frame)
+    {
+        const std::chrono::steady_clock::rep modeChangeTime = PENDING_VIDEO_MODE_CHANGE_TIME;
+
+        // Frames captured before the mode change may still be arriving.
+        if (modeChangeTime &&
+            (frame.channel == kc_get_device_input_channel_idx()) &&
+            (frame.timestamp.time_since_epoch().count() >= modeChangeTime))
+        {
+            const auto latency = (frame.timestamp.time_since_epoch() - std::chrono::steady_clock::duration(modeChangeTime));
+
+            VIDEO_MODE_CHANGE_LATENCY = std::chrono::duration<double, std::milli>(latency).count();
+            PENDING_VIDEO_MODE_CHANGE_TIME = 0;
+        }
+    });
+
+    kc_evNewCapturedFrame.listen([](const captured_frame_s &frame)
+    {
+        if (frame.channel == kc_get_device_input_channel_idx())
+        {
+            FRAME_INTERVALS.add_frame(frame.timestamp, frame.sequence);
+        }
+    });
+
+    // Intervals from before a change in the signal don't reflect its cadence.
+    {
+        kc_evNewVideoMode.listen([](const video_mode_s&)
+        {
+            FRAME_INTERVALS.reset();
+        });
+
+        kc_evSignalLost.listen([]
+        {
+            FRAME_INTERVALS.reset();
+        });
+
+        ks_evInputChannelChanged.listen([]
+        {
+            FRAME_INTERVALS.reset();
+        });
+    }
+
     kt_timer(1000, [](const unsigned)
     {
         const unsigned numMissedCurrent = kc_get_missed_frames_count();
@@ -46,6 +149,14 @@ void kc_initialize_capture(void)
         LAST_KNOWN_MISSED_FRAMES_COUNT = numMissedCurrent;
 
         kc_evMissedFramesCount.fire(numMissedFrames);
+
+        if (DUPLICATE_FRAME_HANDLING != duplicate_frame_handling_e::none)
+        {
+            UNIQUE_FRAME_RATE = NUM_UNIQUE_FRAMES_THIS_SECOND;
+            kc_evUniqueFramesPerSecond.fire(kc_get_unique_frame_rate(kc_get_device_input_channel_idx()));
+        }
+
+        NUM_UNIQUE_FRAMES_THIS_SECOND.clear();
     });
 
     return;
@@ -57,6 +168,91 @@ void kc_release_capture(void)
 
     kc_release_device();
 
+    #ifdef __linux__
+        if (CAPTURE_EVENT_FD >= 0)
+        {
+            close(CAPTURE_EVENT_FD);
+            CAPTURE_EVENT_FD = -1;
+        }
+    #endif
+
+    return;
+}
+
+void kc_push_capture_event(const capture_event_e type, const unsigned payload, const int channelIdx)
+{
+    const unsigned currentChannelIdx = kc_get_device_input_channel_idx();
+    const unsigned channel = ((channelIdx < 0)? currentChannelIdx : unsigned(channelIdx));
+
+    // Keep track of the time it takes for the first frame in a new video mode
+    // to arrive. If the mode changes again before that, we measure from the
+    // first change. Only the current input channel's video mode is of interest.
+    switch ((channel == currentChannelIdx)? type : capture_event_e::none)
+    {
+        case capture_event_e::new_video_mode:
+        {
+            std::chrono::steady_clock::rep noPendingChange = 0;
+            PENDING_VIDEO_MODE_CHANGE_TIME.compare_exchange_strong(noPendingChange, std::chrono::steady_clock::now().time_since_epoch().count());
+            break;
+        }
+        case capture_event_e::signal_lost:
+        {
+            PENDING_VIDEO_MODE_CHANGE_TIME = 0;
+            break;
+        }
+        default: break;
+    }
+
+    // Note: We only report the first overflow, in case the queue stays full
+    // for a while.
+    if (!CAPTURE_EVENT_QUEUE.push(type, payload, channel) &&
+        (CAPTURE_EVENT_QUEUE.num_overflowed() == 1))
+    {
+        NBENE(("The capture event queue is full. Dropping events."));
+    }
+
+    kc_signal_capture_event();
+
+    return;
+}
+
+capture_event_queue_c& kc_capture_event_queue(void)
+{
+    return CAPTURE_EVENT_QUEUE;
+}
+
+void kc_signal_capture_event(void)
+{
+    #ifdef __linux__
+        if (CAPTURE_EVENT_FD >= 0)
+        {
+            const uint64_t increment = 1;
+
+            // Note: This won't fail other than by overflowing the counter, in
+            // which case the fd is readable anyway.
+            (void)!write(CAPTURE_EVENT_FD, &increment, sizeof(increment));
+        }
+    #endif
+
+    return;
+}
+
+int kc_capture_event_fd(void)
+{
+    return CAPTURE_EVENT_FD;
+}
+
+void kc_clear_capture_event_signal(void)
+{
+    #ifdef __linux__
+        if (CAPTURE_EVENT_FD >= 0)
+        {
+            uint64_t counter = 0;
+
+            (void)!read(CAPTURE_EVENT_FD, &counter, sizeof(counter));
+        }
+    #endif
+
     return;
 }
 
@@ -68,6 +264,52 @@ video_mode_s kc_get_capture_video_mode(void)
     };
 }
 
+double kc_get_video_mode_change_latency(void)
+{
+    return VIDEO_MODE_CHANGE_LATENCY;
+}
+
+frame_interval_stats_s kc_get_frame_interval_stats(void)
+{
+    return FRAME_INTERVALS.stats();
+}
+
+void kc_set_duplicate_frame_handling(const duplicate_frame_handling_e handling)
+{
+    DUPLICATE_FRAME_HANDLING = handling;
+
+    if (handling == duplicate_frame_handling_e::none)
+    {
+        UNIQUE_FRAME_RATE.clear();
+    }
+
+    return;
+}
+
+duplicate_frame_handling_e kc_get_duplicate_frame_handling(void)
+{
+    return DUPLICATE_FRAME_HANDLING;
+}
+
+unsigned kc_get_unique_frame_rate(const unsigned channelIdx)
+{
+    const auto rate = UNIQUE_FRAME_RATE.find(channelIdx);
+
+    return ((rate == UNIQUE_FRAME_RATE.end())? 0 : rate->second);
+}
+
+void kc_set_frame_rate_limit(const refresh_rate_s &rate)
+{
+    FRAME_RATE_LIMIT = rate.value<double>();
+
+    return;
+}
+
+refresh_rate_s kc_get_frame_rate_limit(void)
+{
+    return refresh_rate_s(FRAME_RATE_LIMIT.load());
+}
+
 bool kc_force_capture_resolution(const resolution_s &r)
 {
     #if CAPTURE_DEVICE_VISION_V4L
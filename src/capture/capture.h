@@ -74,15 +74,18 @@
 
 #include <vector>
 #include <mutex>
+#include <chrono>
 #include "display/display.h"
 #include "common/globals.h"
 #include "scaler/scaler.h"
 #include "common/refresh_rate.h"
+#include "capture/frame_interval_tracker.h"
 #include "common/memory/heap_mem.h"
 #include "common/types.h"
 #include "common/propagate/vcs_event.h"
 
 struct video_mode_s;
+class capture_event_queue_c;
 
 /*!
  * An event fired when the capture subsystem makes a new captured frame available.
@@ -92,12 +95,16 @@ struct video_mode_s;
  * words, the event is fired by VCS's event loop rather than by the capture
  * subsystem.
  * 
- * Frames that don't register on calls to kc_pop_capture_event_queue() won't
+ * Frames that don't register on calls to kc_drain_capture_event_queue() won't
  * generate this event.
  * 
  * A reference to the frame's data is provided as an argument to event listeners.
  * The data will remain valid for each listener until the listener function
  * returns.
+ *
+ * If input channels are being captured concurrently (see
+ * kc_open_concurrent_input_channel()), the event fires for the frames of each
+ * of them. The frame's @a channel member identifies its input channel.
  * 
  * @code
  * // Register an event listener that gets run each time a new frame is captured.
@@ -258,6 +265,18 @@ extern vcs_event_c<void> kc_evUnrecoverableError;
 // the count of missed frames during that interval).
 extern vcs_event_c<unsigned> kc_evMissedFramesCount;
 
+/*!
+ * An event fired once per second with the number of unique frames -- frames
+ * not identical to their predecessor -- captured on the current input channel
+ * during that second.
+ *
+ * Only fired while duplicate frame detection is enabled.
+ *
+ * @see
+ * kc_set_duplicate_frame_handling(), captured_frame_s::isDuplicate
+ */
+extern vcs_event_c<unsigned> kc_evUniqueFramesPerSecond;
+
 /*!
  * Enumerates the de-interlacing modes recognized by the capture subsystem.
  *
@@ -278,6 +297,52 @@ enum class capture_deinterlacing_mode_e
     field_1,
 };
 
+/*!
+ * Enumerates the ways in which the capture subsystem can handle captured frames
+ * whose pixels are identical to those of the previous frame on the same input
+ * channel; as happens e.g. when the source renders at a fraction of its video
+ * mode's refresh rate.
+ *
+ * @see
+ * kc_set_duplicate_frame_handling()
+ */
+enum class duplicate_frame_handling_e
+{
+    /*! Duplicate frames aren't looked for.*/
+    none,
+
+    /*! Duplicate frames are passed on to VCS with captured_frame_s::isDuplicate
+     *  set. The scaler then passes on its output for the previous frame again
+     *  rather than processing the duplicate, so that e.g. video recording keeps
+     *  the capture's frame rate; see ks_scale_frame().*/
+    flag,
+
+    /*! Duplicate frames are dropped by the capture subsystem.*/
+    drop,
+};
+
+/*!
+ * Enumerates the kinds of memory into which the capture device can be asked to
+ * deliver captured frames, for capture devices that offer a choice.
+ *
+ * @note
+ * If the capture device doesn't support the requested kind of memory, the
+ * interface is expected to try the next item in the list, down to the final
+ * item, which all devices are expected to support.
+ */
+enum class capture_memory_e
+{
+    /*! Buffers exported by a DMA-BUF heap, shared with the capture device.*/
+    dmabuf,
+
+    /*! Page-aligned buffers allocated by VCS in its own address space.*/
+    userptr,
+
+    /*! Buffers allocated by the capture device and mapped into VCS's address
+     *  space.*/
+    mmap,
+};
+
 /*!
  * Enumerates the pixel color formats recognized by the capture subsystem for
  * captured frames.
@@ -312,7 +377,7 @@ enum class capture_pixel_format_e
  * back.
  * 
  * @see
- * kc_pop_capture_event_queue()
+ * kc_drain_capture_event_queue(), capture_event_s
  */
 enum class capture_event_e
 {
@@ -361,6 +426,29 @@ enum class capture_event_e
     num_enumerators
 };
 
+/*!
+ * @brief
+ * A capture event, as reported to VCS by the capture subsystem.
+ *
+ * @see
+ * kc_drain_capture_event_queue(), kc_push_capture_event()
+ */
+struct capture_event_s
+{
+    capture_event_e type;
+
+    /*! Event-specific data, or 0 if the event type doesn't define any.*/
+    unsigned payload;
+
+    /*! When the event was pushed into the capture subsystem's event queue.*/
+    std::chrono::steady_clock::time_point timestamp;
+
+    /*! The index of the input channel the event concerns. For new frame
+     *  events, this is the channel whose frame kc_get_frame_buffer() should be
+     *  asked for.*/
+    unsigned channel;
+};
+
 /*!
  * @brief
  * A video mode of the capture device's input signal.
@@ -384,11 +472,98 @@ struct captured_frame_s
 
     heap_mem<u8> pixels;
 
+    // When the frame was captured, as reported by the capture device if it
+    // provides timestamps and by VCS on receipt of the frame otherwise. A
+    // default-constructed (zero) value means the time is unknown.
+    std::chrono::steady_clock::time_point timestamp;
+
+    // A running count of frames produced by the capture device, as reported by
+    // the device if it provides one. Gaps in the sequence indicate frames that
+    // were lost before they reached VCS.
+    u32 sequence = 0;
+
+    // The index of the input channel on which the frame was captured (see
+    // kc_get_device_input_channel_idx()). With concurrent capture, frames may
+    // come from channels other than the current one.
+    unsigned channel = 0;
+
+    // Whether the frame's pixels are identical to those of the previous frame
+    // captured on the same input channel. Only detected while duplicate frame
+    // handling is enabled (see kc_set_duplicate_frame_handling()).
+    bool isDuplicate = false;
+
     // Will be set to true after the frame's data has been processed for
     // display and is no longer needed.
     bool processed = false;
 };
 
+/*!
+ * @brief
+ * Describes how full the queue of captured frames awaiting processing by VCS
+ * is.
+ *
+ * @see
+ * kc_get_frame_queue_status()
+ */
+struct frame_queue_status_s
+{
+    /*! The maximum number of frames the queue can hold.*/
+    unsigned capacity;
+
+    /*! The number of frames currently in the queue.*/
+    unsigned numOccupied;
+
+    /*! The highest number of frames the queue has held at once since the
+     *  capture device was last reset (e.g. on input channel change).*/
+    unsigned peakOccupied;
+};
+
+/*!
+ * @brief
+ * A change the interface made to the number of back buffers into which the
+ * capture device captures frames.
+ *
+ * @see
+ * back_buffer_status_s
+ */
+struct back_buffer_adjustment_s
+{
+    /*! When the change was made.*/
+    std::chrono::steady_clock::time_point timestamp;
+
+    unsigned oldCount;
+    unsigned newCount;
+
+    /*! A human-readable explanation of why the change was made.*/
+    std::string reason;
+};
+
+/*!
+ * @brief
+ * Describes the back buffers into which the capture device captures frames
+ * before they're handed over to VCS.
+ *
+ * @see
+ * kc_get_back_buffer_status()
+ */
+struct back_buffer_status_s
+{
+    /*! The number of back buffers currently in use. Interfaces that don't
+     *  manage back buffers report 0.*/
+    unsigned count;
+
+    /*! Whether the interface adjusts the number of back buffers at run-time.
+     *  If false, the other members below are to be ignored.*/
+    bool isAdaptive;
+
+    /*! The range within which the number of back buffers is adjusted.*/
+    unsigned minCount;
+    unsigned maxCount;
+
+    /*! The most recent adjustments, oldest first.*/
+    std::vector<back_buffer_adjustment_s> history;
+};
+
 struct signal_info_s
 {
     resolution_s r;
@@ -397,6 +572,43 @@ struct signal_info_s
     bool isDigital;
 };
 
+/*!
+ * @brief
+ * A rectangular region of the input signal's frames, in pixels from the frame's
+ * top left corner, to which the capture device can be asked to restrict its
+ * capturing.
+ *
+ * A region whose width or height is 0 covers the whole frame.
+ *
+ * @see
+ * kc_set_capture_region()
+ */
+struct capture_region_s
+{
+    unsigned long x;
+    unsigned long y;
+    unsigned long w;
+    unsigned long h;
+
+    bool is_full_frame(void) const
+    {
+        return (!this->w || !this->h);
+    }
+
+    bool operator==(const capture_region_s &other) const
+    {
+        return ((this->x == other.x) &&
+                (this->y == other.y) &&
+                (this->w == other.w) &&
+                (this->h == other.h));
+    }
+
+    bool operator!=(const capture_region_s &other) const
+    {
+        return !(*this == other);
+    }
+};
+
 struct video_signal_parameters_s
 {
     resolution_s r; // For legacy (VCS <= 1.6.5) support.
@@ -436,12 +648,12 @@ struct video_signal_parameters_s
  * // Blocks execution until the capture mutex allows us to access the capture data.
  * std::lock_guard<std::mutex> lock(kc_capture_mutex());
  *
- * // Handle the most recent capture event (having locked the mutex prevents
- * // the capture subsystem from pushing new events while we're doing this).
- * switch (kc_pop_capture_event_queue())
- * {
- *     // ...
- * }
+ * // Handle the pending capture events (having locked the mutex prevents the
+ * // capture subsystem from modifying e.g. the capture video mode while we're
+ * // doing this).
+ * capture_event_s events[16];
+ * const unsigned numEvents = kc_drain_capture_event_queue(events, 16);
+ * // ...
  * @endcode
  *
  * @note
@@ -451,6 +663,64 @@ struct video_signal_parameters_s
  */
 std::mutex& kc_capture_mutex(void);
 
+/*!
+ * Adds the given event, timestamped with the current time, to the end of the
+ * capture subsystem's event queue, and notifies the main VCS thread of it (see
+ * kc_signal_capture_event()). Can be called from any thread, and doesn't block.
+ *
+ * The event concerns the input channel of the given index, or the current
+ * input channel if the index is negative.
+ *
+ * If the queue is full, the event is dropped.
+ *
+ * @see
+ * kc_drain_capture_event_queue(), kc_capture_event_queue()
+ */
+void kc_push_capture_event(const capture_event_e type, const unsigned payload = 0, const int channelIdx = -1);
+
+/*!
+ * Returns a reference to the capture subsystem's event queue, into which events
+ * are pushed via kc_push_capture_event(). Interfaces drain the queue in their
+ * implementation of kc_drain_capture_event_queue().
+ */
+capture_event_queue_c& kc_capture_event_queue(void);
+
+/*!
+ * Notifies the main VCS thread that the capture subsystem has a new capture
+ * event for it, waking it up if it's waiting for one. Can be called from any
+ * thread.
+ *
+ * Interfaces should call this function whenever they add an event to their
+ * event queue.
+ *
+ * @see
+ * kc_capture_event_fd(), kc_clear_capture_event_signal()
+ */
+void kc_signal_capture_event(void);
+
+/*!
+ * Returns a file descriptor that becomes readable when kc_signal_capture_event()
+ * is called, and stays so until kc_clear_capture_event_signal() is called. The
+ * main VCS thread can block on it (e.g. with poll() or a Qt QSocketNotifier)
+ * rather than polling the capture event queue.
+ *
+ * Returns -1 if the platform doesn't support this, in which case the capture
+ * event queue must be polled.
+ *
+ * @see
+ * kc_signal_capture_event()
+ */
+int kc_capture_event_fd(void);
+
+/*!
+ * Resets the capture event file descriptor (see kc_capture_event_fd()) to not
+ * readable.
+ *
+ * To avoid missing events, call this before, not after, emptying the capture
+ * event queue.
+ */
+void kc_clear_capture_event_signal(void);
+
 /*!
  * Initializes the capture subsystem.
  *
@@ -524,6 +794,83 @@ bool kc_release_device(void);
  */
 video_mode_s kc_get_capture_video_mode(void);
 
+/*!
+ * Returns the number of milliseconds that passed, on the most recent change in
+ * the input signal's video mode, between the capture device reporting the new
+ * mode and its capturing the first valid frame in that mode. Returns a negative
+ * value if no such change has yet been measured.
+ *
+ * A high value indicates that the capture device is slow to adapt to new video
+ * modes, with VCS's output going blank for a while on each change.
+ *
+ * @see
+ * capture_event_e::new_video_mode, kc_evNewCapturedFrame
+ */
+double kc_get_video_mode_change_latency(void);
+
+/*!
+ * Sets how the capture subsystem handles captured frames that are identical to
+ * the previous frame on the same input channel.
+ *
+ * Detecting duplicates costs one pass over each frame's pixels on the capture
+ * thread; but with a source that e.g. renders at 35 FPS in a 70 Hz video mode,
+ * dropping them saves VCS from processing half of the frames.
+ *
+ * Interfaces whose capture device can't provide the frame data in time for the
+ * check may ignore this setting.
+ *
+ * @see
+ * kc_get_duplicate_frame_handling(), kc_evUniqueFramesPerSecond
+ */
+void kc_set_duplicate_frame_handling(const duplicate_frame_handling_e handling);
+
+/*!
+ * Returns the capture subsystem's current handling of duplicate frames.
+ *
+ * @see
+ * kc_set_duplicate_frame_handling()
+ */
+duplicate_frame_handling_e kc_get_duplicate_frame_handling(void);
+
+/*!
+ * Returns the number of unique frames captured on the given input channel
+ * during the most recent full second, or 0 if duplicate frame detection isn't
+ * enabled.
+ *
+ * @see
+ * kc_evUniqueFramesPerSecond
+ */
+unsigned kc_get_unique_frame_rate(const unsigned channelIdx);
+
+/*!
+ * Caps the rate at which the capture subsystem passes captured frames on to
+ * VCS to the given rate, or removes the cap if the rate is 0.
+ *
+ * The capture threads use the frames' capture timestamps to pick which frames
+ * to pass on, so that they're evenly spaced at the given rate on average, and
+ * hand the rest straight back to the capture device without copying or
+ * otherwise processing them. With e.g. a 70 Hz source recorded at 30 FPS, VCS
+ * then only processes the 30 frames per second it needs.
+ *
+ * Has no effect if the rate is at or above the source's refresh rate.
+ *
+ * Interfaces whose capture device doesn't provide per-frame timestamps may
+ * ignore this setting.
+ *
+ * @see
+ * kc_get_frame_rate_limit()
+ */
+void kc_set_frame_rate_limit(const refresh_rate_s &rate);
+
+/*!
+ * Returns the rate to which the capture subsystem currently caps its captured
+ * frames, or 0 if there's no cap.
+ *
+ * @see
+ * kc_set_frame_rate_limit()
+ */
+refresh_rate_s kc_get_frame_rate_limit(void);
+
 /*!
  * Asks the capture device to set its input resolution to the one given,
  * overriding the current input resolution.
@@ -681,7 +1028,9 @@ video_signal_parameters_s kc_get_device_video_parameter_maximums(void);
  * @note
  * The capture device's input and output resolutions are expected to always
  * be equal; any scaling of captured frames is expected to be done by VCS and
- * not the capture device.
+ * not the capture device. The exception is scaling requested via
+ * kc_set_hardware_scaling_resolution(), which changes the resolution of the
+ * captured frames but not the value returned here.
  *
  * @warning
  * Don't take this to be the resolution of the latest captured frame
@@ -694,6 +1043,61 @@ video_signal_parameters_s kc_get_device_video_parameter_maximums(void);
  */
 resolution_s kc_get_capture_resolution(void);
 
+/*!
+ * Returns the resolution of the capture device's input signal.
+ *
+ * This equals the capture resolution unless the capture device has been asked
+ * to capture only a region of the signal's frames.
+ *
+ * @see
+ * kc_get_capture_resolution(), kc_set_capture_region()
+ */
+resolution_s kc_get_source_resolution(void);
+
+/*!
+ * Asks the capture device to capture only the given region of the input
+ * signal's frames, so that the pixels outside of it (e.g. a letterboxed
+ * image's borders) don't get transferred and processed at all. A region
+ * covering the whole frame cancels any previous one.
+ *
+ * The region is clipped to the input signal's resolution, including when the
+ * signal's video mode changes. Once the capture device has adopted the region,
+ * it reports the region's size as the new capture resolution via a
+ * capture_event_e::new_video_mode event.
+ *
+ * Returns true on success; false otherwise, e.g. if the capture device doesn't
+ * support capture regions.
+ *
+ * @see
+ * kc_get_capture_region(), kc_get_source_resolution()
+ */
+bool kc_set_capture_region(const capture_region_s &region);
+
+/*!
+ * Returns the capture region most recently set via kc_set_capture_region().
+ */
+capture_region_s kc_get_capture_region(void);
+
+/*!
+ * Asks the capture device to scale the current input channel's frames down to
+ * the given resolution in hardware, so that fewer bytes get transferred and VCS
+ * needn't scale the frames itself. A resolution whose width or height is 0
+ * cancels any previous scaling.
+ *
+ * The scaling applies only while the given resolution is no larger than the
+ * capture resolution (see kc_get_capture_resolution()), which it doesn't
+ * change. The captured frames' resolution (captured_frame_s::r) will be the
+ * scaled one. If the capture device turns out not to support scaling, it
+ * carries on at the capture resolution.
+ *
+ * Returns true on success; false otherwise, e.g. if the interface doesn't
+ * support hardware scaling.
+ *
+ * @see
+ * ks_scale_frame()
+ */
+bool kc_set_hardware_scaling_resolution(const resolution_s &r);
+
 /*!
  * Returns the minimum capture resolution supported by the capture device.
  *
@@ -736,6 +1140,42 @@ resolution_s kc_get_device_maximum_resolution(void);
  */
 unsigned kc_get_missed_frames_count(void);
 
+/*!
+ * Returns the number of frames the interface has deliberately skipped, in
+ * favor of newer frames, to keep the latency from capture to display low; e.g.
+ * by handing VCS only the newest of several frames the capture device has
+ * completed while VCS was busy (see the --drain-to-newest command-line option).
+ *
+ * Unlike the frames counted by kc_get_missed_frames_count(), these weren't
+ * dropped for lack of room to hold them.
+ *
+ * @note
+ * This value must be cumulative over the lifetime of the program's
+ * execution and must not decrease during that time.
+ */
+unsigned kc_get_skipped_frames_count(void);
+
+/*!
+ * Returns the current status of the queue in which the interface holds captured
+ * frames until VCS has processed them.
+ *
+ * A peak occupancy close to the queue's capacity indicates that VCS is at times
+ * falling behind the capture device, and that frames may be dropped as a
+ * result (see kc_get_missed_frames_count()).
+ *
+ * Interfaces that don't queue frames should report a capacity of 1.
+ */
+frame_queue_status_s kc_get_frame_queue_status(void);
+
+/*!
+ * Returns the current status of the capture device's back buffers.
+ *
+ * Interfaces that adapt the number of back buffers to the capture device's
+ * needs (e.g. growing it when the device drops frames for lack of a free
+ * buffer) should report the adjustments they've made in the status's history.
+ */
+back_buffer_status_s kc_get_back_buffer_status(void);
+
 /*!
  * Returns the index value of the capture device's input channel on which the
  * device is currently listening for signals. The value is in the range [0,n-1],
@@ -760,6 +1200,28 @@ unsigned kc_get_device_input_channel_idx(void);
  */
 refresh_rate_s kc_get_capture_refresh_rate(void);
 
+/*!
+ * Returns statistics of the intervals between the capture timestamps of the
+ * current input channel's most recent frames: the refresh rate they imply,
+ * their jitter, and a histogram of them.
+ *
+ * Unlike kc_get_capture_refresh_rate(), which returns the refresh rate the
+ * capture device reports for the signal, this reflects the cadence at which
+ * frames actually arrive. Irregular intervals, e.g. from the device delivering
+ * frames in bursts, will show up as judder in VCS's output.
+ *
+ * The statistics are reset when the video mode or the input channel changes,
+ * or the signal is lost. If the capture device numbers its frames (see
+ * captured_frame_s::sequence), an interval across frames that weren't passed
+ * on to VCS -- e.g. because of the frame rate limit, or dropped as duplicates
+ * (see kc_set_duplicate_frame_handling()) -- counts as that many intervals of
+ * its average length; otherwise, such gaps count as longer intervals.
+ *
+ * @see
+ * kc_get_capture_refresh_rate(), frame_interval_tracker_c
+ */
+frame_interval_stats_s kc_get_frame_interval_stats(void);
+
 /*!
  * Returns the color depth, in bits, that the interface currently expects
  * the capture device to send captured frames in.
@@ -806,40 +1268,72 @@ bool kc_has_valid_device(void);
 bool kc_is_receiving_signal(void);
 
 /*!
- * Returns a reference to the most recent captured frame.
+ * Returns a reference to the oldest captured frame not yet marked as processed
+ * on the given input channel, which is either the current channel or one
+ * opened with kc_open_concurrent_input_channel().
  * 
  * To ensure that the frame buffer's data isn't modified by another thread while
  * you're accessing it, acquire the capture mutex before calling this function.
  *
+ * @warning
+ * The frame's pixel data may point directly into the capture device's memory
+ * (e.g. with the @a --zero-copy-capture command-line option), in which case it's
+ * valid only until kc_mark_frame_buffer_as_processed() is called. Don't hold on
+ * to the reference beyond that.
+ *
  * @code
  * // The capture mutex should be locked first, to ensure that the frame buffer
  * // isn't modified by another thread while we're accessing its data.
  * std::lock_guard<std::mutex> lock(kc_capture_mutex());
  *
- * const auto &frameBuffer = kc_get_frame_buffer();
+ * const auto &frameBuffer = kc_get_frame_buffer(kc_get_device_input_channel_idx());
  * // Access the frame buffer's data...
  * @endcode
  *
  * @see
  * kc_capture_mutex(), kc_evNewCapturedFrame
  */
-const captured_frame_s& kc_get_frame_buffer(void);
+const captured_frame_s& kc_get_frame_buffer(const unsigned channelIdx);
 
 /*!
  * Called by VCS to notify the interface that VCS has finished processing the
- * latest frame obtained via kc_get_frame_buffer(). The inteface is then free
- * to e.g. overwrite the frame's data.
+ * latest frame obtained via kc_get_frame_buffer() for the given input channel.
+ * The inteface is then free to e.g. overwrite the frame's data.
  *
  * Returns true on success; false otherwise.
  */
-bool kc_mark_frame_buffer_as_processed(void);
+bool kc_mark_frame_buffer_as_processed(const unsigned channelIdx);
 
 /*!
- * Returns the latest capture event and removes it from the interface's
- * event queue. The caller can then respond to the event; e.g. by calling
- * kc_get_frame_buffer() if the event is a new frame.
+ * Removes up to @p maxCount of the oldest pending capture events from the
+ * interface's event queue and copies them into @p dst, in the order in which
+ * they occurred. Returns the number of events copied. The caller can then
+ * respond to the events; e.g. by calling kc_get_frame_buffer() for a new frame
+ * event.
+ *
+ * Events are typically pushed into the queue by the interface's capture
+ * threads via kc_push_capture_event(), but the interface may also act on them
+ * first, or report events of its own; e.g. a new frame event for a frame in its
+ * frame queue.
+ *
+ * The interface should report at most one new frame event per input channel
+ * per call, and only if kc_get_frame_buffer() will then return a valid frame
+ * for the event's channel.
+ *
+ * @code
+ * capture_event_s events[16];
+ * const unsigned numEvents = kc_drain_capture_event_queue(events, 16);
+ *
+ * for (unsigned i = 0; i < numEvents; i++)
+ * {
+ *     switch (events[i].type)
+ *     {
+ *         // ...
+ *     }
+ * }
+ * @endcode
  */
-capture_event_e kc_pop_capture_event_queue(void);
+unsigned kc_drain_capture_event_queue(capture_event_s *const dst, const unsigned maxCount);
 
 /*!
  * Assigns to the capture device the given video signal parameters.
@@ -867,6 +1361,9 @@ bool kc_set_deinterlacing_mode(const capture_deinterlacing_mode_e mode);
  * Tells the capture device to start listening for signals on the given
  * input channel.
  *
+ * If the channel is on standby (see kc_open_standby_input_channel()) or
+ * capturing concurrently, the switch takes effect immediately.
+ *
  * Returns true on success; false otherwise.
  *
  * @see
@@ -874,6 +1371,82 @@ bool kc_set_deinterlacing_mode(const capture_deinterlacing_mode_e mode);
  */
 bool kc_set_capture_input_channel(const unsigned idx);
 
+/*!
+ * Starts capturing on the given input channel concurrently with the current
+ * one, with its own capture thread and frame queue. The channel's frames are
+ * reported via capture_event_e::new_frame events whose channel is the given
+ * index, and are processed by VCS in their own pipeline (anti-tearing,
+ * filtering, scaling), but aren't displayed. Other events on the channel, like
+ * loss of signal, are handled by the interface and not reported to VCS.
+ *
+ * If the given channel is later made the current channel (see
+ * kc_set_capture_input_channel()), it stops capturing concurrently, taking
+ * over as the current channel without being re-opened. If the channel is on
+ * standby (see kc_open_standby_input_channel()), it's made to capture
+ * concurrently instead.
+ *
+ * Interfaces that can't capture from more than one input channel at a time
+ * return false.
+ *
+ * Returns true on success; false otherwise.
+ *
+ * @see
+ * kc_close_concurrent_input_channel(), kc_get_concurrent_input_channels()
+ */
+bool kc_open_concurrent_input_channel(const unsigned idx);
+
+/*!
+ * Stops capturing on the given input channel previously opened with
+ * kc_open_concurrent_input_channel().
+ *
+ * Returns true on success; false otherwise.
+ */
+bool kc_close_concurrent_input_channel(const unsigned idx);
+
+/*!
+ * Returns the indices of the input channels currently capturing concurrently
+ * with the current one (see kc_open_concurrent_input_channel()).
+ */
+std::vector<unsigned> kc_get_concurrent_input_channels(void);
+
+/*!
+ * Opens the given input channel on standby, so that it can be made the current
+ * channel (see kc_set_capture_input_channel()) without the delay of opening the
+ * device, negotiating its format and allocating its buffers. A standby channel
+ * keeps capturing with its own capture thread and frame queue, but its frames
+ * are discarded and its events aren't reported to VCS.
+ *
+ * When a standby channel is made the current channel, the previous current
+ * channel goes on standby in its place, so that switching back is just as
+ * quick.
+ *
+ * If the given channel is capturing concurrently (see
+ * kc_open_concurrent_input_channel()), it's put on standby instead.
+ *
+ * Interfaces that can't capture from more than one input channel at a time
+ * return false.
+ *
+ * Returns true on success; false otherwise.
+ *
+ * @see
+ * kc_close_standby_input_channel(), kc_get_standby_input_channels()
+ */
+bool kc_open_standby_input_channel(const unsigned idx);
+
+/*!
+ * Closes the given input channel previously opened with
+ * kc_open_standby_input_channel().
+ *
+ * Returns true on success; false otherwise.
+ */
+bool kc_close_standby_input_channel(const unsigned idx);
+
+/*!
+ * Returns the indices of the input channels currently on standby (see
+ * kc_open_standby_input_channel()).
+ */
+std::vector<unsigned> kc_get_standby_input_channels(void);
+
 /*!
  * Tells the capture device to store its captured frames using the given
  * pixel format.
@@ -0,0 +1,118 @@
+/*
+ * 2021 Tarpeeksi Hyvae Soft
+ *
+ * Software: VCS
+ *
+ */
+
+#include "capture/capture_event_queue.h"
+
+// The queue follows the design of Dmitry Vyukov's bounded MPMC queue, where each
+// cell's sequence number tells whose turn it is to access the cell: a producer
+// may write into the cell at position 'pos' when the cell's sequence is 'pos',
+// and the consumer may read from it when the sequence is 'pos + 1'.
+
+static_assert(((capture_event_queue_c::capacity & (capture_event_queue_c::capacity - 1)) == 0),
+              "The capture event queue's capacity must be a power of two.");
+
+capture_event_queue_c::capture_event_queue_c(void)
+{
+    for (unsigned i = 0; i < capture_event_queue_c::capacity; i++)
+    {
+        this->cells[i].sequence.store(i, std::memory_order_relaxed);
+    }
+
+    return;
+}
+
+bool capture_event_queue_c::push(const capture_event_e type, const unsigned payload, const unsigned channel)
+{
+    unsigned pos = this->pushPos.load(std::memory_order_relaxed);
+    cell_s *cell = nullptr;
+
+    // Claim the next free cell, competing with any other producers.
+    while (true)
+    {
+        cell = &this->cells[pos & (capture_event_queue_c::capacity - 1)];
+
+        const unsigned sequence = cell->sequence.load(std::memory_order_acquire);
+        const int lap = int(sequence - pos);
+
+        if (lap == 0)
+        {
+            if (this->pushPos.compare_exchange_weak(pos, (pos + 1), std::memory_order_relaxed))
+            {
+                break;
+            }
+        }
+        // The consumer hasn't yet read the cell's previous event, so the queue
+        // is full.
+        else if (lap < 0)
+        {
+            this->numOverflowed++;
+
+            return false;
+        }
+        // Another producer claimed the cell before us.
+        else
+        {
+            pos = this->pushPos.load(std::memory_order_relaxed);
+        }
+    }
+
+    cell->event.type = type;
+    cell->event.payload = payload;
+    cell->event.channel = channel;
+    cell->event.timestamp = std::chrono::steady_clock::now();
+
+    cell->sequence.store((pos + 1), std::memory_order_release);
+
+    return true;
+}
+
+bool capture_event_queue_c::pop(capture_event_s *const dst)
+{
+    cell_s &cell = this->cells[this->popPos & (capture_event_queue_c::capacity - 1)];
+
+    if (cell.sequence.load(std::memory_order_acquire) != (this->popPos + 1))
+    {
+        return false;
+    }
+
+    *dst = cell.event;
+
+    cell.sequence.store((this->popPos + capture_event_queue_c::capacity), std::memory_order_release);
+    this->popPos++;
+
+    return true;
+}
+
+unsigned capture_event_queue_c::drain(capture_event_s *const dst, const unsigned maxCount)
+{
+    unsigned numEvents = 0;
+
+    while ((numEvents < maxCount) &&
+           this->pop(&dst[numEvents]))
+    {
+        numEvents++;
+    }
+
+    return numEvents;
+}
+
+void capture_event_queue_c::clear(void)
+{
+    capture_event_s discarded;
+
+    while (this->pop(&discarded))
+    {
+        ;
+    }
+
+    return;
+}
+
+unsigned capture_event_queue_c::num_overflowed(void) const
+{
+    return this->numOverflowed;
+}
@@ -0,0 +1,85 @@
+/*
+ * 2021 Tarpeeksi Hyvae Soft
+ *
+ * Software: VCS
+ *
+ * A bounded, lock-free queue of capture events, for handing events from the
+ * capture subsystem's threads over to the main VCS thread in the order in which
+ * they occurred.
+ *
+ * Any number of threads can push events into the queue, but only one thread (the
+ * main VCS thread) may pop them.
+ *
+ * Usage:
+ *
+ *   1. In any thread, push events into the queue:
+ *
+ *      capture_event_queue_c queue;
+ *      queue.push(capture_event_e::new_frame);
+ *
+ *   2. In the main VCS thread, pop the queued events, oldest first, either one
+ *      at a time or in batches:
+ *
+ *      capture_event_s events[16];
+ *      const unsigned numEvents = queue.drain(events, 16);
+ *
+ */
+
+#ifndef VCS_CAPTURE_CAPTURE_EVENT_QUEUE_H
+#define VCS_CAPTURE_CAPTURE_EVENT_QUEUE_H
+
+#include <atomic>
+#include "capture/capture.h"
+
+class capture_event_queue_c
+{
+public:
+    // The maximum number of events the queue can hold. Must be a power of two.
+    static const unsigned capacity = 256;
+
+    capture_event_queue_c(void);
+
+    // Adds the given event, with the given payload and concerning the given
+    // input channel, to the end of the queue, timestamping it with the current
+    // time. Returns false if the queue was full, in which case the event is
+    // dropped (and counted; see num_overflowed()). Can be called from any
+    // thread.
+    bool push(const capture_event_e type, const unsigned payload = 0, const unsigned channel = 0);
+
+    // Removes the oldest event from the queue and copies it into *dst. Returns
+    // false if the queue was empty. Must only be called from the consumer thread.
+    bool pop(capture_event_s *const dst);
+
+    // Removes up to maxCount of the oldest events from the queue, copying them
+    // into dst in the order in which they were pushed. Returns the number of
+    // events copied. Must only be called from the consumer thread.
+    unsigned drain(capture_event_s *const dst, const unsigned maxCount);
+
+    // Removes all events from the queue. Must only be called from the consumer
+    // thread.
+    void clear(void);
+
+    // The number of events dropped due to the queue being full, cumulative over
+    // the lifetime of the queue.
+    unsigned num_overflowed(void) const;
+
+private:
+    struct cell_s
+    {
+        // Tells the producers and the consumer whether the cell is free to be
+        // written into or holds an event waiting to be read, and on which lap
+        // around the queue.
+        std::atomic<unsigned> sequence;
+
+        capture_event_s event;
+    };
+
+    cell_s cells[capacity];
+
+    std::atomic<unsigned> pushPos = {0};
+    unsigned popPos = 0;
+
+    std::atomic<unsigned> numOverflowed = {0};
+};
+
+#endif
@@ -0,0 +1,145 @@
+/*
+ * 2021 Tarpeeksi Hyvae Soft
+ *
+ * Software: VCS
+ *
+ */
+
+#include <mutex>
+#include <cerrno>
+#include <cstring>
+#include <algorithm>
+#include "common/command_line/command_line.h"
+#include "capture/capture_thread.h"
+#include "common/globals.h"
+
+#ifdef __linux__
+    #include <pthread.h>
+    #include <sched.h>
+    #include <sys/mman.h>
+#endif
+
+static latency_tracker_c SCHEDULING_LATENCY;
+static std::mutex SCHEDULING_LATENCY_MUTEX;
+
+void kc_tune_capture_thread(void)
+{
+    #ifdef __linux__
+        const int cpu = kcom_capture_thread_cpu();
+
+        if (cpu >= 0)
+        {
+            cpu_set_t cpuSet;
+            CPU_ZERO(&cpuSet);
+            CPU_SET(cpu, &cpuSet);
+
+            const int err = ((cpu < CPU_SETSIZE)? pthread_setaffinity_np(pthread_self(), sizeof(cpuSet), &cpuSet) : EINVAL);
+
+            if (err)
+            {
+                NBENE(("Failed to pin the capture thread to CPU %d (%s).", cpu, strerror(err)));
+            }
+            else
+            {
+                INFO(("Pinned the capture thread to CPU %d.", cpu));
+            }
+        }
+
+        if (kcom_capture_thread_scheduling() != capture_thread_scheduling_e::standard)
+        {
+            const bool isFifo = (kcom_capture_thread_scheduling() == capture_thread_scheduling_e::fifo);
+            const int policy = (isFifo? SCHED_FIFO : SCHED_RR);
+            const int minPriority = sched_get_priority_min(policy);
+            const int maxPriority = sched_get_priority_max(policy);
+
+            sched_param param;
+            memset(&param, 0, sizeof(param));
+            param.sched_priority = ((kcom_capture_thread_priority() < 0)? minPriority
+                                                                         : std::max(minPriority, std::min(maxPriority, kcom_capture_thread_priority())));
+
+            const int err = pthread_setschedparam(pthread_self(), policy, &param);
+
+            if (err == EPERM)
+            {
+                NBENE(("Not permitted to use real-time scheduling for the capture thread. This requires "
+                       "the CAP_SYS_NICE capability or a sufficient RLIMIT_RTPRIO. Using the default "
+                       "scheduling instead."));
+            }
+            else if (err)
+            {
+                NBENE(("Failed to set the capture thread's scheduling policy (%s).", strerror(err)));
+            }
+            else
+            {
+                INFO(("Scheduling the capture thread with %s at priority %d.",
+                      (isFifo? "SCHED_FIFO" : "SCHED_RR"), param.sched_priority));
+            }
+        }
+    #else
+        if ((kcom_capture_thread_cpu() >= 0) ||
+            (kcom_capture_thread_scheduling() != capture_thread_scheduling_e::standard))
+        {
+            NBENE(("Capture thread scheduling options aren't supported on this platform. Ignoring them."));
+        }
+    #endif
+
+    return;
+}
+
+bool kc_lock_capture_memory(const void *const ptr, const std::size_t numBytes)
+{
+    if (!kcom_lock_capture_memory() ||
+        !ptr ||
+        !numBytes)
+    {
+        return false;
+    }
+
+    #ifdef __linux__
+        if (mlock(ptr, numBytes) != 0)
+        {
+            NBENE(("Failed to lock %lu KB of capture memory (%s). Raising RLIMIT_MEMLOCK may help.",
+                   (unsigned long)(numBytes / 1024), strerror(errno)));
+
+            return false;
+        }
+
+        return true;
+    #else
+        NBENE(("Locking capture memory isn't supported on this platform."));
+
+        return false;
+    #endif
+}
+
+void kc_unlock_capture_memory(const void *const ptr, const std::size_t numBytes)
+{
+    if (!kcom_lock_capture_memory() ||
+        !ptr ||
+        !numBytes)
+    {
+        return;
+    }
+
+    #ifdef __linux__
+        munlock(ptr, numBytes);
+    #endif
+
+    return;
+}
+
+void kc_report_capture_scheduling_latency(const std::chrono::steady_clock::time_point frameNoticedAt)
+{
+    std::lock_guard<std::mutex> lock(SCHEDULING_LATENCY_MUTEX);
+
+    SCHEDULING_LATENCY.add_sample(frameNoticedAt);
+
+    return;
+}
+
+latency_stats_s kc_get_capture_scheduling_latency(void)
+{
+    std::lock_guard<std::mutex> lock(SCHEDULING_LATENCY_MUTEX);
+
+    return SCHEDULING_LATENCY.stats();
+}
@@ -0,0 +1,56 @@
+/*
+ * 2021 Tarpeeksi Hyvae Soft
+ *
+ * Software: VCS
+ *
+ * Tuning for the threads in which capture devices receive their frames, so
+ * that they keep up with the capture hardware's deadlines while the rest of
+ * the system (e.g. the video encoder) is busy.
+ *
+ */
+
+#ifndef VCS_CAPTURE_CAPTURE_THREAD_H
+#define VCS_CAPTURE_CAPTURE_THREAD_H
+
+#include <chrono>
+#include <cstddef>
+#include "common/latency/latency_tracker.h"
+
+// The scheduling policies a capture thread can request.
+enum class capture_thread_scheduling_e
+{
+    // The operating system's default (time-sharing) scheduling.
+    standard,
+
+    // Real-time first in, first out (SCHED_FIFO).
+    fifo,
+
+    // Real-time round-robin (SCHED_RR).
+    round_robin,
+};
+
+// Applies to the calling thread the CPU affinity and scheduling policy the user
+// has asked for (see --capture-thread-cpu, --capture-thread-scheduling and
+// --capture-thread-priority). Should be called by each capture thread as it
+// starts. Failures, e.g. due to lacking the privileges for real-time scheduling,
+// are reported but otherwise ignored.
+void kc_tune_capture_thread(void);
+
+// If the user has asked for capture memory to be locked (--lock-capture-memory),
+// locks the given memory into RAM so that the capture thread won't page fault
+// on it. Returns true if the memory was locked; false otherwise.
+bool kc_lock_capture_memory(const void *const ptr, const std::size_t numBytes);
+
+// Unlocks memory locked with kc_lock_capture_memory(). Memory that gets
+// unmapped is unlocked automatically and needn't be passed to this.
+void kc_unlock_capture_memory(const void *const ptr, const std::size_t numBytes);
+
+// To be called by a capture thread once it has queued a new frame for VCS,
+// given the time at which it learned of the frame (e.g. when poll() returned).
+// Thread-safe.
+void kc_report_capture_scheduling_latency(const std::chrono::steady_clock::time_point frameNoticedAt);
+
+// Returns statistics of the latencies reported via kc_report_capture_scheduling_latency().
+latency_stats_s kc_get_capture_scheduling_latency(void);
+
+#endif
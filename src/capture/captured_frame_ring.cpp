@@ -0,0 +1,243 @@
+/*
+ * 2021 Tarpeeksi Hyvae Soft
+ *
+ * Software: VCS
+ *
+ */
+
+#include "capture/captured_frame_ring.h"
+#include "capture/capture_thread.h"
+
+void captured_frame_ring_c::allocate(const unsigned numSlots, const char *const reason)
+{
+    k_assert(((numSlots > 0) && (numSlots <= maxNumSlots)),
+             "Invalid number of slots for the captured frame queue.");
+
+    this->numSlots = numSlots;
+
+    for (unsigned i = 0; i < this->numSlots; i++)
+    {
+        captured_frame_s &frame = this->slots[i].frame;
+
+        frame.r = {640, 480, 32};
+        frame.pixelFormat = capture_pixel_format_e::rgb_888;
+        frame.pixels.allocate(MAX_NUM_BYTES_IN_CAPTURED_FRAME, reason);
+
+        kc_lock_capture_memory(frame.pixels.data(), frame.pixels.size());
+    }
+
+    this->reset();
+
+    return;
+}
+
+void captured_frame_ring_c::release(void)
+{
+    for (unsigned i = 0; i < this->numSlots; i++)
+    {
+        heap_mem<u8> &pixels = this->slots[i].frame.pixels;
+
+        kc_unlock_capture_memory(pixels.data(), pixels.size());
+        pixels.release();
+    }
+
+    this->numSlots = 0;
+
+    return;
+}
+
+void captured_frame_ring_c::reset(void)
+{
+    for (unsigned i = 0; i < this->numSlots; i++)
+    {
+        this->slots[i].state = slot_state_e::empty;
+        this->slots[i].view = nullptr;
+    }
+
+    this->head = 0;
+    this->tail = 0;
+    this->peakOccupancy = 0;
+    this->writeSlot = nullptr;
+    this->isFrontClaimed = false;
+
+    return;
+}
+
+void captured_frame_ring_c::set_overflow_policy(const overflow_policy_e policy)
+{
+    this->overflowPolicy = policy;
+
+    return;
+}
+
+captured_frame_ring_c::slot_s* captured_frame_ring_c::acquire_write_slot(void)
+{
+    k_assert_optional(!this->writeSlot, "Expected the previous write to have been ended.");
+
+    const unsigned head = this->head.load(std::memory_order_relaxed);
+    const unsigned tail = this->tail.load(std::memory_order_acquire);
+
+    // There's a free slot. It's guaranteed to be empty, since the consumer only
+    // advances the tail after having released the slot.
+    if ((head - tail) < this->numSlots)
+    {
+        this->writeSlot = &this->slots[head % this->numSlots];
+        this->writeSlot->state.store(slot_state_e::writing, std::memory_order_relaxed);
+        this->isOverwrite = false;
+
+        return this->writeSlot;
+    }
+
+    // The queue is full, so one frame will be lost regardless of what we do.
+    this->numDropped++;
+
+    if (this->overflowPolicy == overflow_policy_e::keep_oldest)
+    {
+        return nullptr;
+    }
+
+    // Replace the most recently queued frame with the incoming one, unless the
+    // consumer has already claimed it.
+    {
+        slot_s &newest = this->slots[(head - 1) % this->numSlots];
+        unsigned expectedState = slot_state_e::ready;
+
+        if (!newest.state.compare_exchange_strong(expectedState, slot_state_e::writing, std::memory_order_acq_rel))
+        {
+            return nullptr;
+        }
+
+        this->writeSlot = &newest;
+        this->isOverwrite = true;
+
+        return this->writeSlot;
+    }
+}
+
+captured_frame_s* captured_frame_ring_c::begin_write(void)
+{
+    slot_s *const slot = this->acquire_write_slot();
+
+    if (!slot)
+    {
+        return nullptr;
+    }
+
+    slot->view = nullptr;
+
+    return &slot->frame;
+}
+
+bool captured_frame_ring_c::push_view(const captured_frame_s *const frame,
+                                      const captured_frame_s **replacedFrame)
+{
+    k_assert(frame, "Expected a non-null frame.");
+
+    slot_s *const slot = this->acquire_write_slot();
+
+    *replacedFrame = nullptr;
+
+    if (!slot)
+    {
+        return false;
+    }
+
+    if (this->isOverwrite)
+    {
+        *replacedFrame = slot->view;
+    }
+
+    slot->view = frame;
+
+    this->end_write();
+
+    return true;
+}
+
+void captured_frame_ring_c::end_write(void)
+{
+    k_assert_optional(this->writeSlot, "Expected a write to have been begun.");
+
+    this->writeSlot->state.store(slot_state_e::ready, std::memory_order_release);
+    this->writeSlot = nullptr;
+
+    if (!this->isOverwrite)
+    {
+        const unsigned head = (this->head.load(std::memory_order_relaxed) + 1);
+
+        this->head.store(head, std::memory_order_release);
+
+        const unsigned occupancy = (head - this->tail.load(std::memory_order_acquire));
+
+        if (occupancy > this->peakOccupancy)
+        {
+            this->peakOccupancy = occupancy;
+        }
+    }
+
+    return;
+}
+
+const captured_frame_s* captured_frame_ring_c::front(void)
+{
+    const unsigned tail = this->tail.load(std::memory_order_relaxed);
+    slot_s &slot = this->slots[tail % this->numSlots];
+
+    if (this->isFrontClaimed)
+    {
+        return (slot.view? slot.view : &slot.frame);
+    }
+
+    if (tail == this->head.load(std::memory_order_acquire))
+    {
+        return nullptr;
+    }
+
+    // If the producer is currently overwriting this frame, we'll have to wait
+    // for it to finish.
+    unsigned expectedState = slot_state_e::ready;
+    if (!slot.state.compare_exchange_strong(expectedState, slot_state_e::reading, std::memory_order_acq_rel))
+    {
+        return nullptr;
+    }
+
+    this->isFrontClaimed = true;
+
+    return (slot.view? slot.view : &slot.frame);
+}
+
+void captured_frame_ring_c::pop_front(void)
+{
+    if (!this->isFrontClaimed)
+    {
+        return;
+    }
+
+    const unsigned tail = this->tail.load(std::memory_order_relaxed);
+
+    this->slots[tail % this->numSlots].state.store(slot_state_e::empty, std::memory_order_release);
+    this->tail.store((tail + 1), std::memory_order_release);
+    this->isFrontClaimed = false;
+
+    return;
+}
+
+unsigned captured_frame_ring_c::capacity(void) const
+{
+    return this->numSlots;
+}
+
+unsigned captured_frame_ring_c::occupancy(void) const
+{
+    return (this->head.load(std::memory_order_acquire) - this->tail.load(std::memory_order_acquire));
+}
+
+unsigned captured_frame_ring_c::peak_occupancy(void) const
+{
+    return this->peakOccupancy;
+}
+
+unsigned captured_frame_ring_c::num_dropped(void) const
+{
+    return this->numDropped;
+}
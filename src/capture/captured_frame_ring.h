@@ -0,0 +1,169 @@
+/*
+ * 2021 Tarpeeksi Hyvae Soft
+ *
+ * Software: VCS
+ *
+ * A bounded single-producer, single-consumer queue of captured frames, for
+ * handing frames from a capture thread over to the main VCS thread without
+ * either side having to wait on the other.
+ *
+ * Usage:
+ *
+ *   1. Allocate the queue's frame slots (in the main VCS thread):
+ *
+ *      captured_frame_ring_c ring;
+ *      ring.allocate(3, "Capture frame queue");
+ *
+ *   2. In the capture thread, acquire a free slot, copy the frame's data into
+ *      it, and commit it to the queue:
+ *
+ *      captured_frame_s *const slot = ring.begin_write();
+ *      if (slot)
+ *      {
+ *          // Copy the frame's data into *slot...
+ *          ring.end_write();
+ *      }
+ *
+ *      Alternatively, if the capture thread owns memory that stays valid until
+ *      the frame has been popped (e.g. a capture device's mmap buffers), it can
+ *      queue a pointer to the frame instead of a copy of it:
+ *
+ *      const captured_frame_s *replacedFrame = nullptr;
+ *      if (!ring.push_view(&deviceFrame, &replacedFrame))
+ *      {
+ *          // The frame was dropped; reclaim deviceFrame...
+ *      }
+ *      else if (replacedFrame)
+ *      {
+ *          // deviceFrame replaced this previously-queued frame; reclaim it...
+ *      }
+ *
+ *   3. In the main VCS thread, access the oldest committed frame, then pop it
+ *      once you're done with it:
+ *
+ *      const captured_frame_s *const frame = ring.front();
+ *      if (frame)
+ *      {
+ *          // Process *frame...
+ *          ring.pop_front();
+ *      }
+ *
+ */
+
+#ifndef VCS_CAPTURE_CAPTURED_FRAME_RING_H
+#define VCS_CAPTURE_CAPTURED_FRAME_RING_H
+
+#include <atomic>
+#include "capture/capture.h"
+
+class captured_frame_ring_c
+{
+public:
+    // What the producer should do when it has a new frame but all of the
+    // queue's slots are occupied.
+    enum class overflow_policy_e
+    {
+        // Drop the incoming frame, leaving the queued frames as they are.
+        keep_oldest,
+
+        // Overwrite the most recently queued frame (unless VCS is currently
+        // accessing it) with the incoming one.
+        keep_newest,
+    };
+
+    // The largest number of frame slots a queue can have.
+    static const unsigned maxNumSlots = 16;
+
+    // Allocates memory for the given number of frame slots. Must be called
+    // from the main VCS thread.
+    void allocate(const unsigned numSlots, const char *const reason);
+
+    void release(void);
+
+    // Discards all queued frames. Must not be called while the producer is
+    // active or while the consumer holds a frame from front().
+    void reset(void);
+
+    void set_overflow_policy(const overflow_policy_e policy);
+
+    // Producer interface. Returns a pointer to a slot into which the caller
+    // can write a new frame, or nullptr if the frame should be dropped (in
+    // which case the drop gets counted). Each successful call must be matched
+    // by a call to end_write(), which makes the frame available to the consumer.
+    captured_frame_s* begin_write(void);
+    void end_write(void);
+
+    // Producer interface. Queues a pointer to the given frame, whose data the
+    // caller guarantees to keep valid and unmodified until the consumer pops it.
+    // Returns false if the frame was dropped due to the queue being full. If the
+    // frame instead replaced a previously queued one, *replacedFrame is set to
+    // point to that frame; otherwise to nullptr.
+    bool push_view(const captured_frame_s *const frame,
+                   const captured_frame_s **replacedFrame);
+
+    // Consumer interface. Returns a pointer to the oldest queued frame, or
+    // nullptr if there's none available. The frame stays valid and unmodified
+    // until pop_front() is called.
+    const captured_frame_s* front(void);
+    void pop_front(void);
+
+    unsigned capacity(void) const;
+
+    // The number of slots currently holding frames not yet popped by the
+    // consumer.
+    unsigned occupancy(void) const;
+
+    // The highest occupancy reached since the most recent reset().
+    unsigned peak_occupancy(void) const;
+
+    // The number of frames dropped or overwritten due to the queue being full,
+    // cumulative over the lifetime of the queue.
+    unsigned num_dropped(void) const;
+
+private:
+    enum slot_state_e : unsigned
+    {
+        empty,
+        writing,
+        ready,
+        reading,
+    };
+
+    struct slot_s
+    {
+        captured_frame_s frame;
+
+        // If not null, the slot holds this frame instead of its own copy.
+        const captured_frame_s *view = nullptr;
+
+        std::atomic<unsigned> state = {slot_state_e::empty};
+    };
+
+    // Reserves a slot for the producer to write into, or returns nullptr if the
+    // incoming frame should be dropped.
+    slot_s* acquire_write_slot(void);
+
+    slot_s slots[maxNumSlots];
+
+    unsigned numSlots = 0;
+
+    std::atomic<overflow_policy_e> overflowPolicy = {overflow_policy_e::keep_newest};
+
+    // Monotonically increasing counters of frames pushed by the producer and
+    // popped by the consumer. Their difference is the current occupancy.
+    std::atomic<unsigned> head = {0};
+    std::atomic<unsigned> tail = {0};
+
+    std::atomic<unsigned> peakOccupancy = {0};
+    std::atomic<unsigned> numDropped = {0};
+
+    // The slot being written into between begin_write() and end_write(); and
+    // whether the write is replacing an already-queued frame.
+    slot_s *writeSlot = nullptr;
+    bool isOverwrite = false;
+
+    // Set while the consumer holds the frame returned by front().
+    bool isFrontClaimed = false;
+};
+
+#endif
@@ -17,14 +17,14 @@
 #include <cstring>
 #include "common/globals.h"
 #include "capture/capture.h"
+#include "capture/capture_event_queue.h"
+#include "capture/capture_thread.h"
 
 // For shared memory.
 #include <sys/mman.h>
 #include <fcntl.h>
 #include <unistd.h>
 
-static bool CAPTURE_EVENT_FLAGS[(int)capture_event_e::num_enumerators];
-
 static bool IS_VALID_SIGNAL = true;
 
 static double CURRENT_REFRESH_RATE = 0;
@@ -39,6 +39,10 @@ static uint8_t *MMAP_STATUS_BUF = nullptr;
 static uint8_t *MMAP_SCREEN_BUF = nullptr;
 
 static std::atomic<bool> RUN_CAPTURE_THREAD = {false};
+
+// Set while VCS has yet to process the frame in FRAME_BUFFER. Since there's only
+// the one frame buffer, we'll report at most one new frame at a time.
+static std::atomic<bool> IS_FRAME_PENDING = {false};
 static std::future<int> CAPTURE_THREAD_FUTURE;
 
 enum class screen_buffer_value_e : unsigned
@@ -122,30 +126,18 @@ static void set_status_buffer_value(const status_buffer_value_e valueEnum, const
     return;
 }
 
-static void push_capture_event(const capture_event_e event)
-{
-    CAPTURE_EVENT_FLAGS[(int)event] = true;
-
-    return;
-}
-
-static bool pop_capture_event(const capture_event_e event)
-{
-    const bool oldFlagValue = CAPTURE_EVENT_FLAGS[(int)event];
-
-    CAPTURE_EVENT_FLAGS[(int)event] = false;
-
-    return oldFlagValue;
-}
-
 // Runs in its own thread, polling the memory shared with DOSBox for new frames.
 // Returns 1 on successful exit; 0 otherwise.
 static int capture_thread(void)
 {
+    kc_tune_capture_thread();
+
     while (RUN_CAPTURE_THREAD)
     {
         if (get_status_buffer_value(status_buffer_value_e::is_new_frame_available))
         {
+            const auto frameNoticedAt = std::chrono::steady_clock::now();
+
             std::lock_guard<std::mutex> lock(kc_capture_mutex());
 
             IS_VALID_SIGNAL = true;
@@ -159,7 +151,12 @@ static int capture_thread(void)
                 (frameHeight < MIN_CAPTURE_HEIGHT))
             {
                 IS_VALID_SIGNAL = false;
-                push_capture_event(capture_event_e::invalid_signal);
+                kc_push_capture_event(capture_event_e::invalid_signal);
+
+                // Skip the frame, rather than reporting it again on every spin
+                // of this loop until DOSBox sends the next one.
+                set_status_buffer_value(status_buffer_value_e::is_new_frame_available, false);
+
                 continue;
             }
 
@@ -167,14 +164,22 @@ static int capture_thread(void)
                 (frameHeight != FRAME_BUFFER.r.h))
             {
                 FRAME_BUFFER.r = {frameWidth, frameHeight, FRAME_BUFFER.r.bpp};
-                push_capture_event(capture_event_e::new_video_mode);
+                kc_push_capture_event(capture_event_e::new_video_mode);
             }
 
+            FRAME_BUFFER.timestamp = std::chrono::steady_clock::now();
+            FRAME_BUFFER.sequence++;
+
             memcpy(FRAME_BUFFER.pixels.data(),
                    (char*)get_screen_buffer_value(screen_buffer_value_e::pixels_ptr),
                    FRAME_BUFFER.pixels.size_check(frameWidth * frameHeight * 4));
 
-            push_capture_event(capture_event_e::new_frame);
+            if (!IS_FRAME_PENDING.exchange(true))
+            {
+                kc_push_capture_event(capture_event_e::new_frame);
+            }
+
+            kc_report_capture_scheduling_latency(frameNoticedAt);
 
             set_status_buffer_value(status_buffer_value_e::is_new_frame_available, false);
         }
@@ -190,6 +195,7 @@ bool kc_initialize_device(void)
     FRAME_BUFFER.r = {640, 480, 32};
     FRAME_BUFFER.pixelFormat = capture_pixel_format_e::rgb_888;
     FRAME_BUFFER.pixels.allocate(MAX_NUM_BYTES_IN_CAPTURED_FRAME, "Capture frame buffer (virtual)");
+    kc_lock_capture_memory(FRAME_BUFFER.pixels.data(), FRAME_BUFFER.pixels.size());
 
     // Initialize the shared memory interface.
     {
@@ -206,6 +212,8 @@ bool kc_initialize_device(void)
         k_assert((ftrerr == 0), "Failed to initialize the shared memory file (screen).");
         MMAP_SCREEN_BUF = (uint8_t*)mmap(nullptr, MMAP_SCREEN_BUF_SIZE, 0666, MAP_SHARED, fd, 0);
         k_assert(MMAP_SCREEN_BUF, "Failed to MMAP into the shared memory file (screen).");
+
+        kc_lock_capture_memory(MMAP_SCREEN_BUF, MMAP_SCREEN_BUF_SIZE);
     }
 
     // Start the capture thread.
@@ -226,11 +234,12 @@ bool kc_initialize_device(void)
 
 bool kc_release_device(void)
 {
-    FRAME_BUFFER.pixels.release();
-
     RUN_CAPTURE_THREAD = false;
     CAPTURE_THREAD_FUTURE.wait();
 
+    kc_unlock_capture_memory(FRAME_BUFFER.pixels.data(), FRAME_BUFFER.pixels.size());
+    FRAME_BUFFER.pixels.release();
+
     return true;
 }
 
@@ -266,27 +275,63 @@ bool kc_set_capture_input_channel(const unsigned idx)
     return false;
 }
 
-const captured_frame_s& kc_get_frame_buffer(void)
+bool kc_open_concurrent_input_channel(const unsigned idx)
 {
-    return FRAME_BUFFER;
+    // Not supported.
+
+    (void)idx;
+
+    return false;
 }
 
-capture_event_e kc_pop_capture_event_queue(void)
+bool kc_close_concurrent_input_channel(const unsigned idx)
 {
-    if (pop_capture_event(capture_event_e::invalid_signal))
-    {
-        return capture_event_e::invalid_signal;
-    }
-    else if (pop_capture_event(capture_event_e::new_video_mode))
-    {
-        return capture_event_e::new_video_mode;
-    }
-    else if (pop_capture_event(capture_event_e::new_frame))
-    {
-        return capture_event_e::new_frame;
-    }
+    // Not supported.
+
+    (void)idx;
+
+    return false;
+}
+
+std::vector<unsigned> kc_get_concurrent_input_channels(void)
+{
+    return {};
+}
 
-    return capture_event_e::none;
+bool kc_open_standby_input_channel(const unsigned idx)
+{
+    // Not supported.
+
+    (void)idx;
+
+    return false;
+}
+
+bool kc_close_standby_input_channel(const unsigned idx)
+{
+    // Not supported.
+
+    (void)idx;
+
+    return false;
+}
+
+std::vector<unsigned> kc_get_standby_input_channels(void)
+{
+    return {};
+}
+
+const captured_frame_s& kc_get_frame_buffer(const unsigned channelIdx)
+{
+    // Only the current input channel is captured.
+    (void)channelIdx;
+
+    return FRAME_BUFFER;
+}
+
+unsigned kc_drain_capture_event_queue(capture_event_s *const dst, const unsigned maxCount)
+{
+    return kc_capture_event_queue().drain(dst, maxCount);
 }
 
 bool kc_device_supports_component_capture(void)
@@ -351,6 +396,25 @@ uint kc_get_missed_frames_count(void)
     return 0;
 }
 
+uint kc_get_skipped_frames_count(void)
+{
+    // Not supported.
+
+    return 0;
+}
+
+frame_queue_status_s kc_get_frame_queue_status(void)
+{
+    // Frames aren't queued; the single frame buffer is refilled on demand.
+    return {1, 0, 1};
+}
+
+back_buffer_status_s kc_get_back_buffer_status(void)
+{
+    // Frames are copied directly out of DOSBox's memory.
+    return {0, false, 0, 0, {}};
+}
+
 uint kc_get_device_input_channel_idx(void)
 {
     return 0;
@@ -361,6 +425,30 @@ resolution_s kc_get_capture_resolution(void)
     return FRAME_BUFFER.r;
 }
 
+resolution_s kc_get_source_resolution(void)
+{
+    return kc_get_capture_resolution();
+}
+
+bool kc_set_capture_region(const capture_region_s &region)
+{
+    // Not supported, other than for capturing the whole frame.
+
+    return region.is_full_frame();
+}
+
+capture_region_s kc_get_capture_region(void)
+{
+    return capture_region_s{};
+}
+
+bool kc_set_hardware_scaling_resolution(const resolution_s &r)
+{
+    // Not supported, other than for not scaling.
+
+    return (!r.w || !r.h);
+}
+
 resolution_s kc_get_device_minimum_resolution(void)
 {
     return {MIN_CAPTURE_WIDTH, MIN_CAPTURE_HEIGHT, MAX_CAPTURE_BPP};
@@ -425,11 +513,13 @@ bool kc_set_deinterlacing_mode(const capture_deinterlacing_mode_e mode)
     return false;
 }
 
-bool kc_mark_frame_buffer_as_processed(void)
+bool kc_mark_frame_buffer_as_processed(const unsigned channelIdx)
 {
-    // Not supported.
-    
-    return false;
+    (void)channelIdx;
+
+    IS_FRAME_PENDING = false;
+
+    return true;
 }
 
 bool kc_has_valid_signal(void)
@@ -0,0 +1,118 @@
+/*
+ * 2021 Tarpeeksi Hyvae Soft
+ *
+ * Software: VCS
+ *
+ */
+
+#include <cstring>
+#include "capture/frame_hash.h"
+
+static const u64 PRIME_1 = 0x9E3779B185EBCA87ull;
+static const u64 PRIME_2 = 0xC2B2AE3D27D4EB4Full;
+static const u64 PRIME_3 = 0x165667B19E3779F9ull;
+static const u64 PRIME_4 = 0x85EBCA77C2B2AE63ull;
+static const u64 PRIME_5 = 0x27D4EB2F165667C5ull;
+
+static inline u64 rotl(const u64 x, const unsigned r)
+{
+    return ((x << r) | (x >> (64 - r)));
+}
+
+static inline u64 read_u64(const u8 *const src)
+{
+    u64 value;
+    memcpy(&value, src, sizeof(value));
+
+    return value;
+}
+
+static inline u32 read_u32(const u8 *const src)
+{
+    u32 value;
+    memcpy(&value, src, sizeof(value));
+
+    return value;
+}
+
+static inline u64 accumulate(u64 acc, const u64 input)
+{
+    acc += (input * PRIME_2);
+    acc = rotl(acc, 31);
+    acc *= PRIME_1;
+
+    return acc;
+}
+
+static inline u64 merge_round(u64 acc, const u64 val)
+{
+    acc ^= accumulate(0, val);
+    acc = ((acc * PRIME_1) + PRIME_4);
+
+    return acc;
+}
+
+// Note: The data are consumed in 32-byte stripes by four independent
+// accumulators, which lets the CPU overlap their multiplies; so the hash runs at
+// close to memory bandwidth on frame-sized inputs.
+u64 kc_hash_frame_pixels(const u8 *const pixels, const unsigned numBytes)
+{
+    const u8 *src = pixels;
+    const u8 *const end = (pixels + numBytes);
+    u64 hash = 0;
+
+    if (numBytes >= 32)
+    {
+        u64 v1 = (PRIME_1 + PRIME_2);
+        u64 v2 = PRIME_2;
+        u64 v3 = 0;
+        u64 v4 = (0 - PRIME_1);
+
+        for (; (end - src) >= 32; src += 32)
+        {
+            v1 = accumulate(v1, read_u64(src + 0));
+            v2 = accumulate(v2, read_u64(src + 8));
+            v3 = accumulate(v3, read_u64(src + 16));
+            v4 = accumulate(v4, read_u64(src + 24));
+        }
+
+        hash = (rotl(v1, 1) + rotl(v2, 7) + rotl(v3, 12) + rotl(v4, 18));
+        hash = merge_round(hash, v1);
+        hash = merge_round(hash, v2);
+        hash = merge_round(hash, v3);
+        hash = merge_round(hash, v4);
+    }
+    else
+    {
+        hash = PRIME_5;
+    }
+
+    hash += numBytes;
+
+    for (; (end - src) >= 8; src += 8)
+    {
+        hash ^= accumulate(0, read_u64(src));
+        hash = ((rotl(hash, 27) * PRIME_1) + PRIME_4);
+    }
+
+    if ((end - src) >= 4)
+    {
+        hash ^= (u64(read_u32(src)) * PRIME_1);
+        hash = ((rotl(hash, 23) * PRIME_2) + PRIME_3);
+        src += 4;
+    }
+
+    for (; src < end; src++)
+    {
+        hash ^= (*src * PRIME_5);
+        hash = (rotl(hash, 11) * PRIME_1);
+    }
+
+    hash ^= (hash >> 33);
+    hash *= PRIME_2;
+    hash ^= (hash >> 29);
+    hash *= PRIME_3;
+    hash ^= (hash >> 32);
+
+    return hash;
+}
@@ -0,0 +1,20 @@
+/*
+ * 2021 Tarpeeksi Hyvae Soft
+ *
+ * Software: VCS
+ *
+ * Hashing of captured frames' pixel data, for detecting frames identical to
+ * their predecessor -- e.g. when the source renders at a fraction of its video
+ * mode's refresh rate -- before VCS spends time processing them.
+ *
+ */
+
+#ifndef VCS_CAPTURE_FRAME_HASH_H
+#define VCS_CAPTURE_FRAME_HASH_H
+
+#include "common/types.h"
+
+// Returns a 64-bit hash (XXH64) of the given bytes.
+u64 kc_hash_frame_pixels(const u8 *const pixels, const unsigned numBytes);
+
+#endif
@@ -0,0 +1,103 @@
+/*
+ * 2021 Tarpeeksi Hyvae Soft
+ *
+ * Software: VCS
+ *
+ */
+
+#include <algorithm>
+#include <cmath>
+#include "capture/frame_interval_tracker.h"
+
+void frame_interval_tracker_c::add_frame(const std::chrono::steady_clock::time_point captureTimestamp,
+                                         const unsigned long sequence)
+{
+    if (captureTimestamp.time_since_epoch().count() == 0)
+    {
+        return;
+    }
+
+    // The number of the signal's frame periods since the previous frame; more
+    // than one if frames in between went unrecorded, or 0 if the sequence
+    // restarted.
+    const unsigned long numFramePeriods = ((sequence && this->prevSequence)
+                                           ? ((sequence > this->prevSequence)? (sequence - this->prevSequence) : 0)
+                                           : 1);
+
+    if (this->isPrevTimestampValid &&
+        numFramePeriods &&
+        (captureTimestamp > this->prevTimestamp))
+    {
+        const auto interval = (captureTimestamp - this->prevTimestamp);
+
+        this->intervalsMs[this->numSamplesRecorded % windowSize] = (std::chrono::duration<double, std::milli>(interval).count() / numFramePeriods);
+        this->numSamplesRecorded++;
+    }
+
+    this->prevTimestamp = captureTimestamp;
+    this->prevSequence = sequence;
+    this->isPrevTimestampValid = true;
+
+    return;
+}
+
+frame_interval_stats_s frame_interval_tracker_c::stats(void) const
+{
+    frame_interval_stats_s stats;
+
+    stats.numSamples = unsigned(std::min<unsigned long>(this->numSamplesRecorded, windowSize));
+
+    if (!stats.numSamples)
+    {
+        return stats;
+    }
+
+    double sorted[windowSize];
+    std::copy(this->intervalsMs, (this->intervalsMs + stats.numSamples), sorted);
+    std::sort(sorted, (sorted + stats.numSamples));
+
+    double sum = 0;
+    for (unsigned i = 0; i < stats.numSamples; i++)
+    {
+        sum += sorted[i];
+    }
+
+    stats.meanMs = (sum / stats.numSamples);
+    stats.refreshRate = (1000 / stats.meanMs);
+
+    double sumSquaredDeviations = 0;
+    for (unsigned i = 0; i < stats.numSamples; i++)
+    {
+        sumSquaredDeviations += ((sorted[i] - stats.meanMs) * (sorted[i] - stats.meanMs));
+    }
+
+    // Nearest-rank percentile.
+    const unsigned p99Rank = ((stats.numSamples * 99 + 99) / 100);
+
+    stats.stddevMs = std::sqrt(sumSquaredDeviations / stats.numSamples);
+    stats.minMs = sorted[0];
+    stats.maxMs = sorted[stats.numSamples - 1];
+    stats.p99Ms = sorted[p99Rank - 1];
+
+    stats.histogramStartMs = (stats.meanMs / 2);
+    stats.histogramBinWidthMs = (stats.meanMs / frame_interval_stats_s::numHistogramBins);
+
+    for (unsigned i = 0; i < stats.numSamples; i++)
+    {
+        const double bin = std::floor((sorted[i] - stats.histogramStartMs) / stats.histogramBinWidthMs);
+        const double maxBin = (frame_interval_stats_s::numHistogramBins - 1);
+
+        stats.histogram[unsigned(std::max(0.0, std::min(maxBin, bin)))]++;
+    }
+
+    return stats;
+}
+
+void frame_interval_tracker_c::reset(void)
+{
+    this->numSamplesRecorded = 0;
+    this->prevSequence = 0;
+    this->isPrevTimestampValid = false;
+
+    return;
+}
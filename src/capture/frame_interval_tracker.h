@@ -0,0 +1,98 @@
+/*
+ * 2021 Tarpeeksi Hyvae Soft
+ *
+ * Software: VCS
+ *
+ */
+
+#ifndef VCS_CAPTURE_FRAME_INTERVAL_TRACKER_H
+#define VCS_CAPTURE_FRAME_INTERVAL_TRACKER_H
+
+#include <chrono>
+
+// Summary statistics of the intervals between consecutive captured frames, as
+// recorded by a frame interval tracker. Durations are in milliseconds.
+struct frame_interval_stats_s
+{
+    static const unsigned numHistogramBins = 16;
+
+    // The refresh rate implied by the mean interval, in Hz.
+    double refreshRate = 0;
+
+    double meanMs = 0;
+    double stddevMs = 0;
+    double minMs = 0;
+    double maxMs = 0;
+    double p99Ms = 0;
+
+    // Counts of the intervals by length. Bin i covers intervals from
+    // (histogramStartMs + (i * histogramBinWidthMs)) up to the next bin; the
+    // bins span half to one and a half times the mean interval, with the first
+    // and last bins also counting the intervals below and above that range.
+    unsigned histogram[numHistogramBins] = {0};
+    double histogramStartMs = 0;
+    double histogramBinWidthMs = 0;
+
+    // The number of intervals the statistics were derived from. Zero if fewer
+    // than two frames have been recorded.
+    unsigned numSamples = 0;
+};
+
+// Records the intervals between the capture timestamps of consecutive frames,
+// keeping a sliding window of the most recent intervals; for measuring the
+// cadence at which frames actually arrive, as opposed to the refresh rate the
+// capture device reports.
+//
+// Usage:
+//
+//   1. Create a tracker:
+//
+//      frame_interval_tracker_c tracker;
+//
+//   2. Record each captured frame:
+//
+//      tracker.add_frame(frame.timestamp, frame.sequence);
+//
+//   3. Query the interval statistics over the window:
+//
+//      const frame_interval_stats_s stats = tracker.stats();
+//
+// The tracker isn't thread-safe; all calls should come from the same thread.
+//
+class frame_interval_tracker_c
+{
+public:
+    // The number of most recent intervals the statistics are computed over.
+    static const unsigned windowSize = 256;
+
+    // Records the interval between the given capture timestamp and that of the
+    // previously-recorded frame. Timestamps with no value are ignored, and a
+    // timestamp that isn't later than the previous one starts a new sequence.
+    //
+    // If given, the frames' sequence numbers (see captured_frame_s::sequence)
+    // are used to account for gaps in the sequence, i.e. for frames that were
+    // captured but not recorded -- e.g. because VCS dropped them: an interval
+    // across a gap is recorded as the interval divided by the number of frame
+    // periods it spans. A sequence number of 0 is taken to be unknown, and one
+    // lower than the previous starts a new sequence.
+    void add_frame(const std::chrono::steady_clock::time_point captureTimestamp,
+                   const unsigned long sequence = 0);
+
+    frame_interval_stats_s stats(void) const;
+
+    // Discards the recorded intervals, e.g. when the video mode changes.
+    void reset(void);
+
+private:
+    double intervalsMs[windowSize];
+
+    // The total number of intervals recorded since the most recent reset(); the
+    // index of the next interval in the window is this modulo the window size.
+    unsigned long numSamplesRecorded = 0;
+
+    std::chrono::steady_clock::time_point prevTimestamp;
+    unsigned long prevSequence = 0;
+    bool isPrevTimestampValid = false;
+};
+
+#endif
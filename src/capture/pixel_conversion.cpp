@@ -0,0 +1,122 @@
+/*
+ * 2021 Tarpeeksi Hyvae Soft
+ *
+ * Software: VCS
+ *
+ */
+
+#include <cstring>
+#include "capture/pixel_conversion.h"
+
+#ifdef __SSE2__
+    #include <emmintrin.h>
+#endif
+
+// The number of pixels the SIMD kernels process per iteration.
+static const unsigned SIMD_BLOCK_SIZE = 8;
+
+static void convert_rgb565(u8 *dst, const u8 *src, unsigned numPixels)
+{
+    #ifdef __SSE2__
+        const __m128i maskRB = _mm_set1_epi16(0x00f8);
+        const __m128i maskG = _mm_set1_epi16(0x00fc);
+        const __m128i alpha = _mm_set1_epi16(short(0xff00));
+
+        for (; numPixels >= SIMD_BLOCK_SIZE; numPixels -= SIMD_BLOCK_SIZE)
+        {
+            const __m128i px = _mm_loadu_si128((const __m128i*)src);
+
+            const __m128i b = _mm_and_si128(_mm_slli_epi16(px, 3), maskRB);
+            const __m128i g = _mm_and_si128(_mm_srli_epi16(px, 3), maskG);
+            const __m128i r = _mm_and_si128(_mm_srli_epi16(px, 8), maskRB);
+
+            // Interleave into 16-bit BG and RA pairs, then into 32-bit BGRA.
+            const __m128i bg = _mm_or_si128(b, _mm_slli_epi16(g, 8));
+            const __m128i ra = _mm_or_si128(r, alpha);
+
+            _mm_storeu_si128((__m128i*)dst, _mm_unpacklo_epi16(bg, ra));
+            _mm_storeu_si128((__m128i*)(dst + 16), _mm_unpackhi_epi16(bg, ra));
+
+            src += (SIMD_BLOCK_SIZE * 2);
+            dst += (SIMD_BLOCK_SIZE * 4);
+        }
+    #endif
+
+    for (unsigned i = 0; i < numPixels; i++)
+    {
+        u16 px;
+        memcpy(&px, (src + i * 2), 2);
+
+        dst[i*4 + 0] = u8(px << 3);
+        dst[i*4 + 1] = u8((px >> 3) & ~3);
+        dst[i*4 + 2] = u8((px >> 8) & ~7);
+        dst[i*4 + 3] = 255;
+    }
+
+    return;
+}
+
+static void convert_rgb555(u8 *dst, const u8 *src, unsigned numPixels)
+{
+    #ifdef __SSE2__
+        const __m128i mask = _mm_set1_epi16(0x00f8);
+
+        for (; numPixels >= SIMD_BLOCK_SIZE; numPixels -= SIMD_BLOCK_SIZE)
+        {
+            const __m128i px = _mm_loadu_si128((const __m128i*)src);
+
+            const __m128i b = _mm_and_si128(_mm_slli_epi16(px, 3), mask);
+            const __m128i g = _mm_and_si128(_mm_srli_epi16(px, 2), mask);
+            const __m128i r = _mm_and_si128(_mm_srli_epi16(px, 7), mask);
+
+            // The alpha channel is the pixel's top bit, expanded to 8 bits.
+            const __m128i a = _mm_slli_epi16(_mm_srai_epi16(px, 15), 8);
+
+            const __m128i bg = _mm_or_si128(b, _mm_slli_epi16(g, 8));
+            const __m128i ra = _mm_or_si128(r, a);
+
+            _mm_storeu_si128((__m128i*)dst, _mm_unpacklo_epi16(bg, ra));
+            _mm_storeu_si128((__m128i*)(dst + 16), _mm_unpackhi_epi16(bg, ra));
+
+            src += (SIMD_BLOCK_SIZE * 2);
+            dst += (SIMD_BLOCK_SIZE * 4);
+        }
+    #endif
+
+    for (unsigned i = 0; i < numPixels; i++)
+    {
+        u16 px;
+        memcpy(&px, (src + i * 2), 2);
+
+        dst[i*4 + 0] = u8(px << 3);
+        dst[i*4 + 1] = u8((px >> 2) & ~7);
+        dst[i*4 + 2] = u8((px >> 7) & ~7);
+        dst[i*4 + 3] = ((px & 0x8000)? 255 : 0);
+    }
+
+    return;
+}
+
+bool kc_is_pixel_conversion_supported(const capture_pixel_format_e srcFormat)
+{
+    return ((srcFormat == capture_pixel_format_e::rgb_565) ||
+            (srcFormat == capture_pixel_format_e::rgb_555));
+}
+
+void kc_convert_pixels_to_bgra(u8 *const dst,
+                               const u8 *const src,
+                               const unsigned numPixels,
+                               const capture_pixel_format_e srcFormat)
+{
+    k_assert(kc_is_pixel_conversion_supported(srcFormat),
+             "Was asked to convert pixels of an unsupported format.");
+
+    switch (srcFormat)
+    {
+        case capture_pixel_format_e::rgb_565: convert_rgb565(dst, src, numPixels); break;
+        case capture_pixel_format_e::rgb_555: convert_rgb555(dst, src, numPixels); break;
+        default: break;
+    }
+
+    return;
+}
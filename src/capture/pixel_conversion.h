@@ -0,0 +1,30 @@
+/*
+ * 2021 Tarpeeksi Hyvae Soft
+ *
+ * Software: VCS
+ *
+ * Conversion of captured pixel data into the BGRA format VCS's scaler and
+ * output operate on. Meant to be applied while copying frames out of capture
+ * device memory, so that the frame's bytes only need to be touched once.
+ *
+ */
+
+#ifndef VCS_CAPTURE_PIXEL_CONVERSION_H
+#define VCS_CAPTURE_PIXEL_CONVERSION_H
+
+#include "capture/capture.h"
+
+// Returns true if kc_convert_pixels_to_bgra() can convert pixels of the given
+// format.
+bool kc_is_pixel_conversion_supported(const capture_pixel_format_e srcFormat);
+
+// Converts the given number of 'srcFormat' pixels from 'src' into BGRA pixels
+// in 'dst', which must have room for (numPixels * 4) bytes. The result matches
+// that of OpenCV's BGR565/BGR555-to-BGRA conversions, so frames converted here
+// look the same as those converted by the scaler.
+void kc_convert_pixels_to_bgra(u8 *const dst,
+                               const u8 *const src,
+                               const unsigned numPixels,
+                               const capture_pixel_format_e srcFormat);
+
+#endif
@@ -0,0 +1,787 @@
+/*
+ * 2021 Tarpeeksi Hyvae Soft
+ *
+ * Software: VCS
+ *
+ * A replay capture device, which plays back the frames of a raw frame dump
+ * file (see frame_dump.h) in place of capturing them; for reproducing capture
+ * conditions offline, e.g. when profiling the capture pipeline.
+ *
+ * The file is memory-mapped, and the frames are copied out of it into the
+ * frame queue by a replay thread, either at the timing recorded in the file or
+ * as fast as VCS processes them (see kcom_replay_as_fast_as_possible()). The
+ * pages ahead of the replay position are prefetched with madvise(), so that
+ * reading the file from disk doesn't stall the replay.
+ *
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <atomic>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <cstring>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include "common/globals.h"
+#include "common/propagate/vcs_event.h"
+#include "common/command_line/command_line.h"
+#include "capture/capture.h"
+#include "capture/capture_event_queue.h"
+#include "capture/capture_thread.h"
+#include "capture/captured_frame_ring.h"
+#include "capture/replay/frame_dump.h"
+
+static const resolution_s MAX_RESOLUTION = resolution_s{MAX_CAPTURE_WIDTH, MAX_CAPTURE_HEIGHT, 32};
+static const resolution_s MIN_RESOLUTION = resolution_s{MIN_CAPTURE_WIDTH, MIN_CAPTURE_HEIGHT, 32};
+
+// How many bytes of the file ahead of the replay position we ask the kernel to
+// have read in. Large enough to cover the time it takes the disk to deliver a
+// burst of frames, while small enough not to crowd other data out of RAM.
+static const std::size_t PREFETCH_WINDOW_SIZE = (64 * 1024 * 1024);
+
+// The memory-mapped frame dump file.
+static const u8 *FILE_DATA = nullptr;
+static std::size_t FILE_SIZE = 0;
+
+// Where each frame's record is in the file; built when the file is opened.
+struct dumped_frame_s
+{
+    resolution_s resolution;
+    capture_pixel_format_e pixelFormat;
+    std::chrono::microseconds timestamp;
+    const u8 *pixels;
+    unsigned numBytes;
+    std::size_t fileOffset;
+};
+static std::vector<dumped_frame_s> FRAMES;
+
+// The average interval between the file's frames.
+static std::chrono::microseconds MEAN_FRAME_INTERVAL = std::chrono::microseconds(0);
+
+// The video mode of the frame most recently replayed. Set by the replay thread.
+static resolution_s RESOLUTION = {640, 480, 32};
+static capture_pixel_format_e PIXEL_FORMAT = capture_pixel_format_e::rgb_888;
+static std::mutex MODE_MUTEX;
+
+// Frames we've replayed but which VCS hasn't yet finished processing, oldest
+// first.
+static captured_frame_ring_c FRAME_RING;
+
+static bool IS_VALID_DEVICE = false;
+
+// Set once the replay has reached the end of the file, unless looping.
+static std::atomic<bool> IS_REPLAY_FINISHED = {false};
+
+static std::atomic<bool> RUN_REPLAY_THREAD = {false};
+static std::future<int> REPLAY_THREAD_FUTURE;
+
+// Asks the kernel to start reading in the given range of the file, if it isn't
+// already in RAM.
+static void prefetch_file_range(const std::size_t offset, const std::size_t length)
+{
+    const std::size_t pageSize = std::size_t(sysconf(_SC_PAGESIZE));
+    const std::size_t start = ((offset / pageSize) * pageSize);
+    const std::size_t end = std::min(FILE_SIZE, (offset + length));
+
+    if (start >= end)
+    {
+        return;
+    }
+
+    if (madvise((void*)(FILE_DATA + start), (end - start), MADV_WILLNEED) != 0)
+    {
+        DEBUG(("Failed to prefetch the replay file (error %d).", errno));
+    }
+
+    return;
+}
+
+// Reads the frame dump file's frame records into FRAMES. Returns true on
+// success; false otherwise. If the file ends in a malformed record, e.g. due to
+// having been cut short, the frames before it are kept.
+static bool index_dumped_frames(void)
+{
+    frame_dump_header_s header;
+    std::size_t offset = sizeof(header);
+
+    if (FILE_SIZE < sizeof(header))
+    {
+        NBENE(("The replay file is too small to be a frame dump."));
+        return false;
+    }
+
+    memcpy(&header, FILE_DATA, sizeof(header));
+
+    if (memcmp(header.magic, FRAME_DUMP_MAGIC, sizeof(header.magic)) != 0)
+    {
+        NBENE(("The replay file isn't a frame dump."));
+        return false;
+    }
+
+    if (header.version != FRAME_DUMP_VERSION)
+    {
+        NBENE(("The replay file is of an unsupported frame dump version (%u; expected %u).",
+               header.version, FRAME_DUMP_VERSION));
+        return false;
+    }
+
+    FRAMES.clear();
+
+    while ((offset + sizeof(frame_dump_frame_header_s)) <= FILE_SIZE)
+    {
+        frame_dump_frame_header_s frameHeader;
+        memcpy(&frameHeader, (FILE_DATA + offset), sizeof(frameHeader));
+
+        dumped_frame_s frame;
+        frame.resolution = {frameHeader.width, frameHeader.height, 32};
+        frame.timestamp = std::chrono::microseconds(frameHeader.timestampUs);
+        frame.numBytes = frameHeader.numBytes;
+        frame.fileOffset = offset;
+        frame.pixels = (FILE_DATA + offset + sizeof(frameHeader));
+
+        switch (frame_dump_pixel_format_e(frameHeader.pixelFormat))
+        {
+            case frame_dump_pixel_format_e::bgra_8888:
+            {
+                frame.pixelFormat = capture_pixel_format_e::rgb_888;
+                break;
+            }
+            case frame_dump_pixel_format_e::rgb_565:
+            {
+                frame.pixelFormat = capture_pixel_format_e::rgb_565;
+                frame.resolution.bpp = 16;
+                break;
+            }
+            case frame_dump_pixel_format_e::rgb_555:
+            {
+                frame.pixelFormat = capture_pixel_format_e::rgb_555;
+                frame.resolution.bpp = 16;
+                break;
+            }
+            default:
+            {
+                NBENE(("Frame #%u in the replay file has an unknown pixel format (%u). Ignoring it and the rest of the file.",
+                       unsigned(FRAMES.size() + 1), frameHeader.pixelFormat));
+                goto done;
+            }
+        }
+
+        const std::size_t recordSize = (sizeof(frameHeader) + frame.numBytes);
+        const std::size_t frameSize = (frame.resolution.w * frame.resolution.h * (frame.resolution.bpp / 8));
+
+        if ((frame.resolution.w < MIN_RESOLUTION.w) ||
+            (frame.resolution.h < MIN_RESOLUTION.h) ||
+            (frame.resolution.w > MAX_RESOLUTION.w) ||
+            (frame.resolution.h > MAX_RESOLUTION.h) ||
+            (frame.numBytes < frameSize) ||
+            ((offset + recordSize) > FILE_SIZE))
+        {
+            NBENE(("Frame #%u in the replay file is malformed or cut short. Ignoring it and the rest of the file.",
+                   unsigned(FRAMES.size() + 1)));
+            goto done;
+        }
+
+        FRAMES.push_back(frame);
+
+        offset += (((recordSize + FRAME_DUMP_RECORD_ALIGNMENT - 1) / FRAME_DUMP_RECORD_ALIGNMENT) * FRAME_DUMP_RECORD_ALIGNMENT);
+    }
+
+    done:
+
+    if (FRAMES.empty())
+    {
+        NBENE(("The replay file contains no frames."));
+        return false;
+    }
+
+    if ((FRAMES.size() > 1) &&
+        (FRAMES.back().timestamp > FRAMES.front().timestamp))
+    {
+        MEAN_FRAME_INTERVAL = ((FRAMES.back().timestamp - FRAMES.front().timestamp) / (FRAMES.size() - 1));
+    }
+    else
+    {
+        MEAN_FRAME_INTERVAL = std::chrono::microseconds(16667);
+    }
+
+    return true;
+}
+
+// Memory-maps the given frame dump file and indexes its frames. Returns true on
+// success; false otherwise.
+static bool open_replay_file(const std::string &fileName)
+{
+    struct stat fileStat;
+    const int fd = open(fileName.c_str(), O_RDONLY);
+
+    if (fd < 0)
+    {
+        NBENE(("Failed to open the replay file \"%s\" (error %d).", fileName.c_str(), errno));
+        goto fail;
+    }
+
+    if ((fstat(fd, &fileStat) != 0) ||
+        (fileStat.st_size <= 0))
+    {
+        NBENE(("Failed to query the size of the replay file (error %d).", errno));
+        goto fail;
+    }
+
+    FILE_SIZE = std::size_t(fileStat.st_size);
+    FILE_DATA = (const u8*)mmap(nullptr, FILE_SIZE, PROT_READ, MAP_PRIVATE, fd, 0);
+
+    if (FILE_DATA == MAP_FAILED)
+    {
+        NBENE(("Failed to memory-map the replay file (error %d).", errno));
+        FILE_DATA = nullptr;
+        goto fail;
+    }
+
+    close(fd);
+
+    // While indexing, we only touch the frame headers, so we don't want the
+    // kernel to read ahead through the pixel data.
+    madvise((void*)FILE_DATA, FILE_SIZE, MADV_RANDOM);
+
+    if (!index_dumped_frames())
+    {
+        munmap((void*)FILE_DATA, FILE_SIZE);
+        FILE_DATA = nullptr;
+        return false;
+    }
+
+    madvise((void*)FILE_DATA, FILE_SIZE, MADV_SEQUENTIAL);
+
+    INFO(("Replaying %u frames (%.1f MB) from \"%s\".",
+          unsigned(FRAMES.size()), (FILE_SIZE / (1024.0 * 1024.0)), fileName.c_str()));
+
+    return true;
+
+    fail:
+    if (fd >= 0)
+    {
+        close(fd);
+    }
+    return false;
+}
+
+// Runs in its own thread, copying the dumped frames into FRAME_RING one by one.
+// Returns 1 on successful exit; 0 otherwise.
+static int replay_thread(void)
+{
+    kc_tune_capture_thread();
+
+    const bool isAsFastAsPossible = kcom_replay_as_fast_as_possible();
+    const bool isLooping = kcom_replay_loop();
+    std::size_t prefetchedUpTo = 0;
+    // The number of frames the replay has gone through, including those it
+    // skipped for having fallen behind; for the frames' sequence numbers, so
+    // that skipped frames leave a gap in the sequence, as dropped frames do
+    // with a capture device.
+    unsigned numFramesElapsed = 0;
+    unsigned frameIdx = 0;
+
+    // The time at which the first frame of the current pass through the file
+    // is due, when replaying at the original timing.
+    auto passStartTime = std::chrono::steady_clock::now();
+
+    while (RUN_REPLAY_THREAD)
+    {
+        if (frameIdx >= FRAMES.size())
+        {
+            if (!isLooping)
+            {
+                INFO(("The replay has reached the end of the file."));
+
+                IS_REPLAY_FINISHED = true;
+                kc_push_capture_event(capture_event_e::signal_lost);
+
+                break;
+            }
+
+            // Keep the frame cadence across the loop point.
+            passStartTime += ((FRAMES.back().timestamp - FRAMES.front().timestamp) + MEAN_FRAME_INTERVAL);
+            prefetchedUpTo = 0;
+            frameIdx = 0;
+        }
+
+        const dumped_frame_s &frame = FRAMES.at(frameIdx);
+
+        if ((frame.fileOffset + frame.numBytes + (PREFETCH_WINDOW_SIZE / 2)) > prefetchedUpTo)
+        {
+            prefetch_file_range(prefetchedUpTo, PREFETCH_WINDOW_SIZE);
+            prefetchedUpTo = std::max((prefetchedUpTo + PREFETCH_WINDOW_SIZE), (frame.fileOffset + frame.numBytes));
+        }
+
+        auto frameTime = std::chrono::steady_clock::now();
+
+        if (isAsFastAsPossible)
+        {
+            // Replay the next frame only once VCS has room for it, so that the
+            // replay runs at the rate VCS processes frames without dropping any.
+            if (FRAME_RING.occupancy() >= FRAME_RING.capacity())
+            {
+                std::this_thread::sleep_for(std::chrono::microseconds(100));
+                continue;
+            }
+        }
+        else
+        {
+            frameTime = (passStartTime + (frame.timestamp - FRAMES.front().timestamp));
+
+            std::this_thread::sleep_until(frameTime);
+
+            // If we've fallen behind such that the next frame is already due
+            // too, skip this one, as a capture device would have dropped it.
+            if (((frameIdx + 1) < FRAMES.size()) &&
+                (std::chrono::steady_clock::now() >= (passStartTime + (FRAMES.at(frameIdx + 1).timestamp - FRAMES.front().timestamp))))
+            {
+                numFramesElapsed++;
+                frameIdx++;
+                continue;
+            }
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(MODE_MUTEX);
+
+            if ((frame.resolution.w != RESOLUTION.w) ||
+                (frame.resolution.h != RESOLUTION.h) ||
+                (frame.pixelFormat != PIXEL_FORMAT))
+            {
+                RESOLUTION = frame.resolution;
+                PIXEL_FORMAT = frame.pixelFormat;
+
+                kc_push_capture_event(capture_event_e::new_video_mode);
+            }
+        }
+
+        const auto frameReplayedAt = std::chrono::steady_clock::now();
+
+        // In the original timing, if VCS is still busy with previous frames
+        // such that the queue is full, the queue's overflow policy decides
+        // which frame gets skipped.
+        captured_frame_s *const dstFrame = FRAME_RING.begin_write();
+
+        if (dstFrame)
+        {
+            const unsigned frameSize = (frame.resolution.w * frame.resolution.h * (frame.resolution.bpp / 8));
+
+            dstFrame->r = frame.resolution;
+            dstFrame->pixelFormat = frame.pixelFormat;
+            dstFrame->timestamp = frameTime;
+            dstFrame->sequence = (numFramesElapsed + 1);
+            dstFrame->channel = 0;
+            dstFrame->isDuplicate = false;
+            dstFrame->processed = false;
+
+            memcpy(dstFrame->pixels.data(), frame.pixels, dstFrame->pixels.size_check(frameSize));
+
+            FRAME_RING.end_write();
+
+            kc_signal_capture_event();
+            kc_report_capture_scheduling_latency(frameReplayedAt);
+        }
+
+        numFramesElapsed++;
+        frameIdx++;
+    }
+
+    return 1;
+}
+
+bool kc_initialize_device(void)
+{
+    INFO(("Initializing the replay capture device."));
+
+    FRAME_RING.allocate(kcom_frame_queue_size(), "Capture frame queue (replay)");
+    FRAME_RING.set_overflow_policy(kcom_frame_queue_overflow_policy());
+
+    if (kcom_replay_file_name().empty())
+    {
+        NBENE(("No file to replay was given (--replay-file)."));
+        goto fail;
+    }
+
+    if (!open_replay_file(kcom_replay_file_name()))
+    {
+        goto fail;
+    }
+
+    IS_VALID_DEVICE = true;
+
+    {
+        std::lock_guard<std::mutex> lock(MODE_MUTEX);
+
+        RESOLUTION = FRAMES.front().resolution;
+        PIXEL_FORMAT = FRAMES.front().pixelFormat;
+    }
+
+    // Report the initial video mode.
+    kc_push_capture_event(capture_event_e::new_video_mode);
+
+    // Start the replay thread.
+    {
+        RUN_REPLAY_THREAD = true;
+        REPLAY_THREAD_FUTURE = std::async(std::launch::async, replay_thread);
+        if (!REPLAY_THREAD_FUTURE.valid())
+        {
+            goto fail;
+        }
+    }
+
+    return true;
+
+    fail:
+    IS_VALID_DEVICE = false;
+    kc_push_capture_event(capture_event_e::invalid_device);
+    return false;
+}
+
+bool kc_release_device(void)
+{
+    RUN_REPLAY_THREAD = false;
+    if (REPLAY_THREAD_FUTURE.valid())
+    {
+        REPLAY_THREAD_FUTURE.wait();
+    }
+
+    FRAME_RING.release();
+
+    if (FILE_DATA)
+    {
+        munmap((void*)FILE_DATA, FILE_SIZE);
+        FILE_DATA = nullptr;
+    }
+
+    FRAMES.clear();
+
+    return true;
+}
+
+bool kc_set_capture_pixel_format(const capture_pixel_format_e pf)
+{
+    // Not supported; the frames are replayed in the pixel format they were
+    // dumped in.
+
+    (void)pf;
+
+    return false;
+}
+
+bool kc_set_capture_resolution(const resolution_s &r)
+{
+    // Not supported; the frames are replayed at the resolution they were
+    // dumped at.
+
+    (void)r;
+
+    return false;
+}
+
+refresh_rate_s kc_get_capture_refresh_rate(void)
+{
+    if (MEAN_FRAME_INTERVAL.count() <= 0)
+    {
+        return refresh_rate_s(0);
+    }
+
+    return refresh_rate_s(1000000.0 / MEAN_FRAME_INTERVAL.count());
+}
+
+bool kc_set_capture_input_channel(const unsigned idx)
+{
+    // Not supported, other than for the one channel.
+
+    return (idx == 0);
+}
+
+bool kc_open_concurrent_input_channel(const unsigned idx)
+{
+    // Not supported.
+
+    (void)idx;
+
+    return false;
+}
+
+bool kc_close_concurrent_input_channel(const unsigned idx)
+{
+    // Not supported.
+
+    (void)idx;
+
+    return false;
+}
+
+std::vector<unsigned> kc_get_concurrent_input_channels(void)
+{
+    return {};
+}
+
+bool kc_open_standby_input_channel(const unsigned idx)
+{
+    // Not supported.
+
+    (void)idx;
+
+    return false;
+}
+
+bool kc_close_standby_input_channel(const unsigned idx)
+{
+    // Not supported.
+
+    (void)idx;
+
+    return false;
+}
+
+std::vector<unsigned> kc_get_standby_input_channels(void)
+{
+    return {};
+}
+
+const captured_frame_s& kc_get_frame_buffer(const unsigned channelIdx)
+{
+    // Only the one input channel is captured.
+    (void)channelIdx;
+
+    const captured_frame_s *const frame = FRAME_RING.front();
+
+    k_assert(frame, "Attempting to access the frame buffer while no captured frame was available.");
+
+    return *frame;
+}
+
+unsigned kc_drain_capture_event_queue(capture_event_s *const dst, const unsigned maxCount)
+{
+    if (!maxCount)
+    {
+        return 0;
+    }
+
+    // Leave room for a new frame event.
+    unsigned numEvents = kc_capture_event_queue().drain(dst, (maxCount - 1));
+
+    // Replayed frames are queued in the frame ring rather than as events. We
+    // report the oldest of them, with the number of frames queued as the
+    // payload.
+    if (FRAME_RING.front())
+    {
+        dst[numEvents++] = {capture_event_e::new_frame, FRAME_RING.occupancy(), std::chrono::steady_clock::now(), 0};
+    }
+
+    return numEvents;
+}
+
+bool kc_device_supports_component_capture(void)
+{
+    return false;
+}
+
+bool kc_device_supports_composite_capture(void)
+{
+    return false;
+}
+
+bool kc_device_supports_deinterlacing(void)
+{
+    return false;
+}
+
+bool kc_device_supports_svideo(void)
+{
+    return false;
+}
+
+bool kc_device_supports_dma(void)
+{
+    return false;
+}
+
+bool kc_device_supports_dvi(void)
+{
+    return false;
+}
+
+bool kc_device_supports_vga(void)
+{
+    return false;
+}
+
+bool kc_device_supports_yuv(void)
+{
+    return false;
+}
+
+bool kc_has_valid_device(void)
+{
+    return IS_VALID_DEVICE;
+}
+
+capture_pixel_format_e kc_get_capture_pixel_format(void)
+{
+    std::lock_guard<std::mutex> lock(MODE_MUTEX);
+
+    return PIXEL_FORMAT;
+}
+
+uint kc_get_capture_color_depth(void)
+{
+    std::lock_guard<std::mutex> lock(MODE_MUTEX);
+
+    return (unsigned)RESOLUTION.bpp;
+}
+
+uint kc_get_missed_frames_count(void)
+{
+    return FRAME_RING.num_dropped();
+}
+
+uint kc_get_skipped_frames_count(void)
+{
+    return 0;
+}
+
+frame_queue_status_s kc_get_frame_queue_status(void)
+{
+    return {FRAME_RING.capacity(),
+            FRAME_RING.occupancy(),
+            FRAME_RING.peak_occupancy()};
+}
+
+back_buffer_status_s kc_get_back_buffer_status(void)
+{
+    // Frames are copied directly out of the memory-mapped file.
+    return {0, false, 0, 0, {}};
+}
+
+uint kc_get_device_input_channel_idx(void)
+{
+    return 0;
+}
+
+resolution_s kc_get_capture_resolution(void)
+{
+    std::lock_guard<std::mutex> lock(MODE_MUTEX);
+
+    return RESOLUTION;
+}
+
+resolution_s kc_get_source_resolution(void)
+{
+    return kc_get_capture_resolution();
+}
+
+bool kc_set_capture_region(const capture_region_s &region)
+{
+    // Not supported, other than for capturing the whole frame.
+
+    return region.is_full_frame();
+}
+
+capture_region_s kc_get_capture_region(void)
+{
+    return capture_region_s{};
+}
+
+bool kc_set_hardware_scaling_resolution(const resolution_s &r)
+{
+    // Not supported, other than for not scaling.
+
+    return (!r.w || !r.h);
+}
+
+resolution_s kc_get_device_minimum_resolution(void)
+{
+    return MIN_RESOLUTION;
+}
+
+resolution_s kc_get_device_maximum_resolution(void)
+{
+    return MAX_RESOLUTION;
+}
+
+std::string kc_get_device_name(void)
+{
+    return "Replay capture device";
+}
+
+std::string kc_get_device_api_name(void)
+{
+    return "Replay";
+}
+
+std::string kc_get_device_driver_version(void)
+{
+    return "Unknown";
+}
+
+std::string kc_get_device_firmware_version(void)
+{
+    return "Unknown";
+}
+
+int kc_get_device_maximum_input_count(void)
+{
+    return 1;
+}
+
+video_signal_parameters_s kc_get_device_video_parameters(void)
+{
+    return video_signal_parameters_s{};
+}
+
+video_signal_parameters_s kc_get_device_video_parameter_defaults(void)
+{
+    return video_signal_parameters_s{};
+}
+
+video_signal_parameters_s kc_get_device_video_parameter_minimums(void)
+{
+    return video_signal_parameters_s{};
+}
+
+video_signal_parameters_s kc_get_device_video_parameter_maximums(void)
+{
+    return video_signal_parameters_s{};
+}
+
+bool kc_set_deinterlacing_mode(const capture_deinterlacing_mode_e mode)
+{
+    (void)mode;
+
+    return false;
+}
+
+bool kc_mark_frame_buffer_as_processed(const unsigned channelIdx)
+{
+    (void)channelIdx;
+
+    FRAME_RING.pop_front();
+
+    return true;
+}
+
+bool kc_has_valid_signal(void)
+{
+    return IS_VALID_DEVICE;
+}
+
+bool kc_is_receiving_signal(void)
+{
+    return (IS_VALID_DEVICE && !IS_REPLAY_FINISHED);
+}
+
+bool kc_set_video_signal_parameters(const video_signal_parameters_s &p)
+{
+    (void)p;
+
+    return false;
+}
@@ -0,0 +1,78 @@
+/*
+ * 2021 Tarpeeksi Hyvae Soft
+ *
+ * Software: VCS
+ *
+ * The layout of the raw frame dump files replayed by the replay capture device
+ * (capture_replay.cpp).
+ *
+ * A dump file consists of a file header (frame_dump_header_s) followed by any
+ * number of frame records, back to back, until the end of the file. Each record
+ * consists of a frame header (frame_dump_frame_header_s), followed by the
+ * frame's numBytes bytes of pixel data, followed by zero padding up to the next
+ * multiple of 8 bytes.
+ *
+ * All values are little-endian. Pixel data is laid out as in captured_frame_s,
+ * i.e. row by row with no padding between rows.
+ *
+ */
+
+#ifndef VCS_CAPTURE_REPLAY_FRAME_DUMP_H
+#define VCS_CAPTURE_REPLAY_FRAME_DUMP_H
+
+#include "common/globals.h"
+
+// The pixel formats of dumped frames. The values are fixed by the file format.
+enum class frame_dump_pixel_format_e : u32
+{
+    // 32 bits per pixel: blue, green, red, and alpha bytes, as in
+    // capture_pixel_format_e::rgb_888.
+    bgra_8888 = 0,
+
+    // 16 bits per pixel, as in capture_pixel_format_e::rgb_565.
+    rgb_565 = 1,
+
+    // 16 bits per pixel, as in capture_pixel_format_e::rgb_555.
+    rgb_555 = 2,
+};
+
+struct frame_dump_header_s
+{
+    // Identifies the file as a frame dump; see FRAME_DUMP_MAGIC.
+    char magic[8];
+
+    // The version of the file format; see FRAME_DUMP_VERSION.
+    u32 version;
+
+    u32 reserved;
+};
+
+struct frame_dump_frame_header_s
+{
+    u32 width;
+    u32 height;
+
+    // One of frame_dump_pixel_format_e.
+    u32 pixelFormat;
+
+    // The number of bytes of pixel data following this header, not including
+    // the padding after it.
+    u32 numBytes;
+
+    // The time at which the frame was captured, in microseconds. The origin is
+    // arbitrary, but the timestamps of consecutive frames are expected to
+    // increase.
+    u64 timestampUs;
+};
+
+static_assert((sizeof(frame_dump_header_s) == 16), "Unexpected size for the frame dump header.");
+static_assert((sizeof(frame_dump_frame_header_s) == 24), "Unexpected size for the frame dump frame header.");
+
+static const char FRAME_DUMP_MAGIC[8] = {'V', 'C', 'S', 'D', 'U', 'M', 'P', '\0'};
+static const u32 FRAME_DUMP_VERSION = 1;
+
+// Frame records, including their pixel data, are padded to a multiple of this
+// many bytes.
+static const unsigned FRAME_DUMP_RECORD_ALIGNMENT = 8;
+
+#endif
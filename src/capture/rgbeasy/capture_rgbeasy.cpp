@@ -10,6 +10,7 @@
 #include "common/globals.h"
 #include "common/propagate/vcs_event.h"
 #include "capture/capture.h"
+#include "capture/capture_event_queue.h"
 #include "capture/alias.h"
 
 #if _WIN32
@@ -28,11 +29,6 @@ static HRGBDLL API_HANDLE = 0;
 // Set to 1 if we're currently capturing.
 static bool IS_CAPTURE_ACTIVE = false;
 
-// The corresponding flag will be set to true when the RGBEasy callback
-// thread notifies us of such an event; and reset back to false when we've
-// handled that event.
-static bool CAPTURE_EVENT_FLAGS[static_cast<int>(capture_event_e::num_enumerators)] = {false};
-
 static std::atomic<unsigned int> CNT_FRAMES_PROCESSED(0);
 static std::atomic<unsigned int> CNT_FRAMES_RECEIVED(0);
 
@@ -69,23 +65,6 @@ static bool apicall_succeeded(long callReturnValue)
     return true;
 }
 
-// Marks the given capture event as having occurred.
-static void push_capture_event(capture_event_e event)
-{
-    CAPTURE_EVENT_FLAGS[static_cast<int>(event)] = true;
-
-    return;
-}
-
-// Removes the given capture event from the 'queue', and returns its value.
-static bool pop_capture_event(capture_event_e event)
-{
-    const bool eventOccurred = CAPTURE_EVENT_FLAGS[static_cast<int>(event)];
-    CAPTURE_EVENT_FLAGS[static_cast<int>(event)] = false;
-
-    return eventOccurred;
-}
-
 // Callback functions for the RGBEasy API, through which the API communicates
 // with VCS. RGBEasy isn't supported on platforms other than Windows, hence the
 // #if - on other platforms, we load in empty placeholder functions (elsewhere
@@ -143,7 +122,7 @@ namespace rgbeasy_callbacks_n
             {
                 IS_SIGNAL_INVALID = true;
 
-                push_capture_event(capture_event_e::invalid_signal);
+                kc_push_capture_event(capture_event_e::invalid_signal);
 
                 goto done;
             }
@@ -153,12 +132,14 @@ namespace rgbeasy_callbacks_n
         FRAME_BUFFER.r.h = abs(frameInfo->biHeight);
         FRAME_BUFFER.r.bpp = frameInfo->biBitCount;
         FRAME_BUFFER.pixelFormat = CAPTURE_PIXEL_FORMAT;
+        FRAME_BUFFER.timestamp = std::chrono::steady_clock::now();
+        FRAME_BUFFER.sequence = CNT_FRAMES_RECEIVED;
 
         // Copy the frame's data into our local buffer so we can work on it.
         memcpy(FRAME_BUFFER.pixels.data(), (u8*)frameData,
                FRAME_BUFFER.pixels.size_check(FRAME_BUFFER.r.w * FRAME_BUFFER.r.h * (FRAME_BUFFER.r.bpp / 8)));
 
-        push_capture_event(capture_event_e::new_frame);
+        kc_push_capture_event(capture_event_e::new_frame);
 
         done:
         CNT_FRAMES_RECEIVED++;
@@ -179,7 +160,7 @@ namespace rgbeasy_callbacks_n
         IS_SIGNAL_INVALID = false;
         RECEIVING_A_SIGNAL = true;
 
-        push_capture_event(capture_event_e::new_video_mode);
+        kc_push_capture_event(capture_event_e::new_video_mode);
 
         done:
         return;
@@ -202,7 +183,7 @@ namespace rgbeasy_callbacks_n
         IS_SIGNAL_INVALID = true;
         RECEIVING_A_SIGNAL = false;
 
-        push_capture_event(capture_event_e::invalid_signal);
+        kc_push_capture_event(capture_event_e::invalid_signal);
 
         done:
         return;
@@ -218,7 +199,7 @@ namespace rgbeasy_callbacks_n
 
         RECEIVING_A_SIGNAL = false;
 
-        push_capture_event(capture_event_e::signal_lost);
+        kc_push_capture_event(capture_event_e::signal_lost);
 
         return;
     }
@@ -229,7 +210,7 @@ namespace rgbeasy_callbacks_n
 
         RECEIVING_A_SIGNAL = false;
 
-        push_capture_event(capture_event_e::unrecoverable_error);
+        kc_push_capture_event(capture_event_e::unrecoverable_error);
 
         return;
     }
@@ -708,6 +689,30 @@ resolution_s kc_get_capture_resolution(void)
     return CAPTURE_RESOLUTION;
 }
 
+resolution_s kc_get_source_resolution(void)
+{
+    return kc_get_capture_resolution();
+}
+
+bool kc_set_capture_region(const capture_region_s &region)
+{
+    // Not supported, other than for capturing the whole frame.
+
+    return region.is_full_frame();
+}
+
+capture_region_s kc_get_capture_region(void)
+{
+    return capture_region_s{};
+}
+
+bool kc_set_hardware_scaling_resolution(const resolution_s &r)
+{
+    // Not supported, other than for not scaling.
+
+    return (!r.w || !r.h);
+}
+
 resolution_s kc_get_device_minimum_resolution(void)
 {
     resolution_s r = {640, 480, 32};
@@ -740,13 +745,18 @@ resolution_s kc_get_device_maximum_resolution(void)
     return r;
 }
 
-const captured_frame_s& kc_get_frame_buffer(void)
+const captured_frame_s& kc_get_frame_buffer(const unsigned channelIdx)
 {
+    // Only the current input channel is captured.
+    (void)channelIdx;
+
     return FRAME_BUFFER;
 }
 
-bool kc_mark_frame_buffer_as_processed(void)
+bool kc_mark_frame_buffer_as_processed(const unsigned channelIdx)
 {
+    (void)channelIdx;
+
     CNT_FRAMES_PROCESSED = CNT_FRAMES_RECEIVED.load();
 
     FRAME_BUFFER.processed = true;
@@ -754,33 +764,29 @@ bool kc_mark_frame_buffer_as_processed(void)
     return true;
 }
 
-capture_event_e kc_pop_capture_event_queue(void)
+unsigned kc_drain_capture_event_queue(capture_event_s *const dst, const unsigned maxCount)
 {
-    if (pop_capture_event(capture_event_e::unrecoverable_error))
-    {
-        return capture_event_e::unrecoverable_error;
-    }
-    else if (pop_capture_event(capture_event_e::new_video_mode))
-    {
-        CAPTURE_RESOLUTION = kc_get_resolution_from_api();
+    const unsigned numEvents = kc_capture_event_queue().drain(dst, maxCount);
 
-        return capture_event_e::new_video_mode;
-    }
-    else if (pop_capture_event(capture_event_e::signal_lost))
+    for (unsigned i = 0; i < numEvents; i++)
     {
-        return capture_event_e::signal_lost;
-    }
-    else if (pop_capture_event(capture_event_e::invalid_signal))
-    {
-        return capture_event_e::invalid_signal;
+        if (dst[i].type == capture_event_e::new_video_mode)
+        {
+            CAPTURE_RESOLUTION = kc_get_resolution_from_api();
+        }
     }
-    else if (pop_capture_event(capture_event_e::new_frame))
+
+    // If there were no events we should notify the caller about.
+    if (!numEvents &&
+        !RECEIVING_A_SIGNAL &&
+        maxCount)
     {
-        return capture_event_e::new_frame;
+        dst[0] = {capture_event_e::sleep, 0, std::chrono::steady_clock::now(), kc_get_device_input_channel_idx()};
+
+        return 1;
     }
 
-    // If there were no events we should notify the caller about.
-    return (RECEIVING_A_SIGNAL? capture_event_e::none : capture_event_e::sleep);
+    return numEvents;
 }
 
 refresh_rate_s kc_get_capture_refresh_rate(void)
@@ -883,6 +889,7 @@ bool kc_set_capture_input_channel(const unsigned idx)
         INFO(("Setting capture input channel to %u.", (idx + 1)));
 
         INPUT_CHANNEL_IDX = idx;
+        FRAME_BUFFER.channel = idx;
     }
     else
     {
@@ -899,6 +906,52 @@ bool kc_set_capture_input_channel(const unsigned idx)
     return false;
 }
 
+bool kc_open_concurrent_input_channel(const unsigned idx)
+{
+    // Not supported.
+
+    (void)idx;
+
+    return false;
+}
+
+bool kc_close_concurrent_input_channel(const unsigned idx)
+{
+    // Not supported.
+
+    (void)idx;
+
+    return false;
+}
+
+std::vector<unsigned> kc_get_concurrent_input_channels(void)
+{
+    return {};
+}
+
+bool kc_open_standby_input_channel(const unsigned idx)
+{
+    // Not supported.
+
+    (void)idx;
+
+    return false;
+}
+
+bool kc_close_standby_input_channel(const unsigned idx)
+{
+    // Not supported.
+
+    (void)idx;
+
+    return false;
+}
+
+std::vector<unsigned> kc_get_standby_input_channels(void)
+{
+    return {};
+}
+
 bool kc_set_capture_pixel_format(const capture_pixel_format_e pf)
 {
     if (apicall_succeeded(RGBSetPixelFormat(CAPTURE_HANDLE, pixel_format_to_rgbeasy_pixel_format(pf))))
@@ -969,6 +1022,25 @@ uint kc_get_missed_frames_count(void)
     return NUM_NEW_FRAME_EVENTS_SKIPPED;
 }
 
+uint kc_get_skipped_frames_count(void)
+{
+    // Not supported.
+
+    return 0;
+}
+
+frame_queue_status_s kc_get_frame_queue_status(void)
+{
+    // The device only has the one frame buffer.
+    return {1, !FRAME_BUFFER.processed, 1};
+}
+
+back_buffer_status_s kc_get_back_buffer_status(void)
+{
+    // The back buffers are managed by the RGBEasy API.
+    return {0, false, 0, 0, {}};
+}
+
 uint kc_get_device_input_channel_idx(void)
 {
     return INPUT_CHANNEL_IDX;
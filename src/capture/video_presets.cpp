@@ -25,7 +25,9 @@ static video_preset_s* strongest_activating_preset(void)
         return nullptr;
     }
 
-    const resolution_s resolution = kc_get_capture_resolution();
+    // Presets are matched against the input signal rather than the capture,
+    // whose resolution depends on the active preset's capture region.
+    const resolution_s resolution = kc_get_source_resolution();
     const refresh_rate_s refreshRate = kc_get_capture_refresh_rate();
 
     std::vector<std::pair<unsigned/*preset id*/,
@@ -57,6 +59,24 @@ static video_preset_s* strongest_activating_preset(void)
     }
 }
 
+// Sends the given preset's settings to the capture device. If the preset is
+// null, the device's default settings are sent instead.
+static void apply_preset(const video_preset_s *const preset)
+{
+    if (preset)
+    {
+        kc_set_video_signal_parameters(preset->videoParameters);
+        kc_set_capture_region(preset->hasCaptureRegion? preset->captureRegion : capture_region_s{});
+    }
+    else
+    {
+        kc_set_video_signal_parameters(kc_get_device_video_parameter_defaults());
+        kc_set_capture_region(capture_region_s{});
+    }
+
+    return;
+}
+
 void kvideopreset_initialize(void)
 {
     // Listen for app events.
@@ -69,7 +89,7 @@ void kvideopreset_initialize(void)
 
             if (preset == strongest_activating_preset())
             {
-                kc_set_video_signal_parameters(preset->videoParameters);
+                apply_preset(preset);
             }
         });
     }
@@ -133,16 +153,7 @@ void kvideopreset_apply_current_active_preset(void)
         return;
     }
 
-    const video_preset_s *activePreset = strongest_activating_preset();
-
-    if (activePreset)
-    {
-        kc_set_video_signal_parameters(activePreset->videoParameters);
-    }
-    else
-    {
-        kc_set_video_signal_parameters(kc_get_device_video_parameter_defaults());
-    }
+    apply_preset(strongest_activating_preset());
 
     return;
 }
@@ -176,7 +187,7 @@ void kvideopreset_activate_keyboard_shortcut(const std::string &shortcutString)
     {
         if (preset->activates_with_shortcut(shortcutString))
         {
-            kc_set_video_signal_parameters(preset->videoParameters);
+            apply_preset(preset);
             return;
         }
     }
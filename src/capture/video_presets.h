@@ -45,6 +45,11 @@ struct video_preset_s
     bool activatesWithShortcut = false;
     std::string activationShortcut = "Ctrl+F1";
 
+    // If set, the capture device is asked to capture only this region of the
+    // input signal's frames while the preset is active.
+    bool hasCaptureRegion = false;
+    capture_region_s captureRegion = {0, 0, 640, 480};
+
     // Returns the strength of activation, expressed as an integer, of this preset
     // to the given capture conditions (resolution, refresh rate, etc.). The activation
     // level depends on the number of conditions that have been specified for the
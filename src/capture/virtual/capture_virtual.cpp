@@ -3,176 +3,237 @@
  * 
  * Software: VCS
  *
+ * A virtual capture device, which generates test pattern frames in a thread of
+ * its own in place of capturing them. Its video mode, pixel format, and test
+ * pattern can be set via the command line (see kcom_virtual_pattern() etc.), so
+ * that it can be used to load the capture pipeline without capture hardware.
+ *
  */
 
+#include <algorithm>
 #include <chrono>
+#include <atomic>
+#include <future>
+#include <mutex>
+#include <thread>
 #include "common/globals.h"
 #include "common/propagate/vcs_event.h"
-#include "common/timer/timer.h"
+#include "common/command_line/command_line.h"
 #include "capture/capture.h"
-
-// We'll try to redraw the on-screen test pattern this often.
-static const double TARGET_REFRESH_RATE = 60;
-
-// Keep track of the actual achieved refresh rate.
-static unsigned NUM_FRAMES_PER_SECOND = 0;
-static double CURRENT_REFRESH_RATE = 0;
-
-static bool CAPTURE_EVENT_FLAGS[(int)capture_event_e::num_enumerators];
+#include "capture/capture_event_queue.h"
+#include "capture/capture_thread.h"
+#include "capture/captured_frame_ring.h"
+#include "capture/virtual/test_pattern.h"
 
 static bool IS_VALID_SIGNAL = true;
 
 static const resolution_s MAX_RESOLUTION = resolution_s{MAX_CAPTURE_WIDTH, MAX_CAPTURE_HEIGHT, 32};
 static const resolution_s MIN_RESOLUTION = resolution_s{320, 200, 32};
 
-static const capture_pixel_format_e DEFAULT_PIXEL_FORMAT = capture_pixel_format_e::rgb_888;
+// The resolutions a mode storm cycles through (see
+// kcom_virtual_mode_storm_interval()).
+static const resolution_s MODE_STORM_RESOLUTIONS[] = {{640, 480, 0},
+                                                      {720, 400, 0},
+                                                      {800, 600, 0},
+                                                      {1024, 768, 0},
+                                                      {1280, 1024, 0},
+                                                      {MAX_CAPTURE_WIDTH, MAX_CAPTURE_HEIGHT, 0}};
+
+// The video mode and pixel format of the frames we generate. Set by VCS (e.g.
+// via kc_set_capture_resolution()) and, during mode storms, by the generator
+// thread.
+static resolution_s RESOLUTION = {640, 480, 32};
+static refresh_rate_s REFRESH_RATE = refresh_rate_s(60);
+static capture_pixel_format_e PIXEL_FORMAT = capture_pixel_format_e::rgb_888;
+static std::mutex MODE_MUTEX;
+
+// Frames we've generated but which VCS hasn't yet finished processing, oldest
+// first.
+static captured_frame_ring_c FRAME_RING;
+
+static std::atomic<unsigned> CUR_INPUT_CHANNEL_IDX = {0};
+
+static std::atomic<bool> RUN_GENERATOR_THREAD = {false};
+static std::future<int> GENERATOR_THREAD_FUTURE;
+
+// Runs in its own thread, generating frames of the test pattern into FRAME_RING
+// at the current refresh rate, as a capture device would capture them. Returns
+// 1 on successful exit; 0 otherwise.
+static int generator_thread(void)
+{
+    kc_tune_capture_thread();
+
+    const test_pattern_e patternType = kcom_virtual_pattern();
+    const auto modeStormInterval = std::chrono::milliseconds(kcom_virtual_mode_storm_interval());
+    test_pattern_c pattern;
+    unsigned numFramesGenerated = 0;
+    unsigned modeStormIdx = 0;
+    auto nextFrameTime = std::chrono::steady_clock::now();
+    auto nextModeChangeTime = (nextFrameTime + modeStormInterval);
+
+    while (RUN_GENERATOR_THREAD)
+    {
+        std::this_thread::sleep_until(nextFrameTime);
 
-static captured_frame_s FRAME_BUFFER;
+        const auto now = std::chrono::steady_clock::now();
+        resolution_s resolution;
+        refresh_rate_s refreshRate;
+        capture_pixel_format_e pixelFormat;
 
-static unsigned CUR_INPUT_CHANNEL_IDX = 0;
+        {
+            std::lock_guard<std::mutex> lock(MODE_MUTEX);
 
-static void refresh_test_pattern(void)
-{
-    static unsigned numFramesGenerated = 0;
+            if (modeStormInterval.count() &&
+                (now >= nextModeChangeTime))
+            {
+                modeStormIdx = ((modeStormIdx + 1) % NUM_ELEMENTS(MODE_STORM_RESOLUTIONS));
 
-    numFramesGenerated++;
-    NUM_FRAMES_PER_SECOND++;
+                RESOLUTION.w = MODE_STORM_RESOLUTIONS[modeStormIdx].w;
+                RESOLUTION.h = MODE_STORM_RESOLUTIONS[modeStormIdx].h;
+                nextModeChangeTime = (now + modeStormInterval);
 
-    for (unsigned y = 0; y < FRAME_BUFFER.r.h; y++)
-    {
-        for (unsigned x = 0; x < FRAME_BUFFER.r.w; x++)
+                kc_push_capture_event(capture_event_e::new_video_mode);
+            }
+
+            resolution = RESOLUTION;
+            refreshRate = REFRESH_RATE;
+            pixelFormat = PIXEL_FORMAT;
+        }
+
+        // Frames are due at fixed intervals, as with a capture device. If we
+        // weren't scheduled in time for some of them, they're dropped, as a
+        // capture device would drop them, leaving a gap in the sequence numbers.
+        const auto frameInterval = std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(1 / refreshRate.value<double>()));
+
+        if (now >= (nextFrameTime + frameInterval))
         {
-            const unsigned idx = ((x + y * FRAME_BUFFER.r.w) * (FRAME_BUFFER.r.bpp / 8));
-            const u8 red = ((numFramesGenerated + x) % 256);
-            const u8 green = ((numFramesGenerated + y) % 256);
-            const u8 blue = 150;
-            const u8 alpha = 255;
+            const auto numFramesDropped = ((now - nextFrameTime) / frameInterval);
 
-            switch (FRAME_BUFFER.pixelFormat)
-            {
-                case capture_pixel_format_e::rgb_888:
-                {
-                    FRAME_BUFFER.pixels[idx + 0] = red;
-                    FRAME_BUFFER.pixels[idx + 1] = green;
-                    FRAME_BUFFER.pixels[idx + 2] = blue;
-                    FRAME_BUFFER.pixels[idx + 3] = alpha;
-
-                    break;
-                }
-                case capture_pixel_format_e::rgb_565:
-                {
-                    const u16 pixel = (((blue  / 8) << 11) |
-                                       ((green / 4) << 5)  |
-                                       ((red   / 8) << 0));
-
-                    *((u16*)&FRAME_BUFFER.pixels[idx]) = pixel;
-
-                    break;
-                }
-                case capture_pixel_format_e::rgb_555:
-                {
-                    const u16 pixel = (((alpha / 256) << 11) |
-                                       ((blue  / 8)   << 10) |
-                                       ((green / 8)   << 5)  |
-                                       ((red   / 8)   << 0));
-
-                    *((u16*)&FRAME_BUFFER.pixels[idx]) = pixel;
-
-                    break;
-                }
-                default: break;
-            }
+            numFramesGenerated += unsigned(numFramesDropped);
+            nextFrameTime += (numFramesDropped * frameInterval);
         }
-    }
 
-    return;
-}
+        const auto frameDueTime = nextFrameTime;
+        nextFrameTime += frameInterval;
 
-static void push_capture_event(const capture_event_e event)
-{
-    CAPTURE_EVENT_FLAGS[(int)event] = true;
+        // A new video mode or pixel format takes effect at the next frame, like
+        // it would with a capture device.
+        if (!pattern.is_prepared_for(patternType, resolution, pixelFormat))
+        {
+            pattern.prepare(patternType, resolution, pixelFormat);
+        }
 
-    return;
-}
+        numFramesGenerated++;
 
-static bool pop_capture_event(const capture_event_e event)
-{
-    const bool oldFlagValue = CAPTURE_EVENT_FLAGS[(int)event];
+        // If VCS is still busy with previous frames such that the queue is
+        // full, the queue's overflow policy decides which frame gets skipped.
+        captured_frame_s *const frame = FRAME_RING.begin_write();
 
-    CAPTURE_EVENT_FLAGS[(int)event] = false;
+        if (frame)
+        {
+            frame->r = resolution;
+            frame->pixelFormat = pixelFormat;
+            frame->timestamp = frameDueTime;
+            frame->sequence = numFramesGenerated;
+            frame->channel = CUR_INPUT_CHANNEL_IDX;
+            frame->isDuplicate = false;
+            frame->processed = false;
 
-    return oldFlagValue;
+            frame->pixels.size_check(resolution.w * resolution.h * (resolution.bpp / 8));
+            pattern.draw(frame->pixels.data(), numFramesGenerated);
+
+            FRAME_RING.end_write();
+
+            kc_signal_capture_event();
+            kc_report_capture_scheduling_latency(now);
+        }
+    }
+
+    return 1;
 }
 
 bool kc_initialize_device(void)
 {
     INFO(("Initializing the virtual capture device."));
 
-    FRAME_BUFFER.r = {640, 480, 32};
-    FRAME_BUFFER.pixelFormat = capture_pixel_format_e::rgb_888;
-    FRAME_BUFFER.pixels.allocate(MAX_NUM_BYTES_IN_CAPTURED_FRAME, "Capture frame buffer (virtual)");
-
-    // Simulate the capturing of a new frame.
-    kt_timer(std::round(1000 / TARGET_REFRESH_RATE), [](const unsigned)
     {
-        if ((kc_get_capture_resolution().bpp > MAX_CAPTURE_BPP) ||
-            (kc_get_capture_resolution().w > MAX_CAPTURE_WIDTH) ||
-            (kc_get_capture_resolution().h > MAX_CAPTURE_HEIGHT))
-        {
-            IS_VALID_SIGNAL = false;
-            push_capture_event(capture_event_e::invalid_signal);
-        }
-        else
+        std::lock_guard<std::mutex> lock(MODE_MUTEX);
+
+        const resolution_s resolution = kcom_virtual_resolution();
+
+        if ((resolution.w < MIN_RESOLUTION.w) ||
+            (resolution.h < MIN_RESOLUTION.h))
         {
-            IS_VALID_SIGNAL = true;
-            refresh_test_pattern();
-            push_capture_event(capture_event_e::new_frame);
+            NBENE(("The virtual capture device's minimum resolution is %u x %u. Using that instead.",
+                   MIN_RESOLUTION.w, MIN_RESOLUTION.h));
         }
-    });
 
-    kt_timer(1000, [](const unsigned elapsedMs)
-    {
-        const double newRefreshRate = (NUM_FRAMES_PER_SECOND * (1000.0 / elapsedMs));
+        RESOLUTION.w = std::max(resolution.w, MIN_RESOLUTION.w);
+        RESOLUTION.h = std::max(resolution.h, MIN_RESOLUTION.h);
+        RESOLUTION.bpp = resolution.bpp;
+        REFRESH_RATE = refresh_rate_s(kcom_virtual_refresh_rate());
+        PIXEL_FORMAT = kcom_virtual_pixel_format();
+    }
+
+    FRAME_RING.allocate(kcom_frame_queue_size(), "Capture frame queue (virtual)");
+    FRAME_RING.set_overflow_policy(kcom_frame_queue_overflow_policy());
 
-        NUM_FRAMES_PER_SECOND = 0;
+    // Report the initial video mode.
+    kc_push_capture_event(capture_event_e::new_video_mode);
 
-        if (CURRENT_REFRESH_RATE != newRefreshRate)
+    // Start the generator thread.
+    {
+        RUN_GENERATOR_THREAD = true;
+        GENERATOR_THREAD_FUTURE = std::async(std::launch::async, generator_thread);
+        if (!GENERATOR_THREAD_FUTURE.valid())
         {
-            CURRENT_REFRESH_RATE = newRefreshRate;
-            push_capture_event(capture_event_e::new_video_mode);
+            goto fail;
         }
-    });
+    }
 
     return true;
+
+    fail:
+    return false;
 }
 
 bool kc_release_device(void)
 {
-    FRAME_BUFFER.pixels.release();
+    RUN_GENERATOR_THREAD = false;
+    if (GENERATOR_THREAD_FUTURE.valid())
+    {
+        GENERATOR_THREAD_FUTURE.wait();
+    }
+
+    FRAME_RING.release();
 
     return true;
 }
 
 bool kc_set_capture_pixel_format(const capture_pixel_format_e pf)
 {
-    switch (pf)
     {
-        case capture_pixel_format_e::rgb_888:
-        {
-            FRAME_BUFFER.r.bpp = 32;
-            break;
-        }
-        case capture_pixel_format_e::rgb_565:
-        case capture_pixel_format_e::rgb_555:
+        std::lock_guard<std::mutex> lock(MODE_MUTEX);
+
+        switch (pf)
         {
-            FRAME_BUFFER.r.bpp = 16;
-            break;
+            case capture_pixel_format_e::rgb_888:
+            {
+                RESOLUTION.bpp = 32;
+                break;
+            }
+            case capture_pixel_format_e::rgb_565:
+            case capture_pixel_format_e::rgb_555:
+            {
+                RESOLUTION.bpp = 16;
+                break;
+            }
         }
-    }
 
-    FRAME_BUFFER.pixelFormat = pf;
+        PIXEL_FORMAT = pf;
+    }
 
-    push_capture_event(capture_event_e::new_video_mode);
+    kc_push_capture_event(capture_event_e::new_video_mode);
 
     return true;
 }
@@ -187,17 +248,23 @@ bool kc_set_capture_resolution(const resolution_s &r)
         return false;
     }
 
-    FRAME_BUFFER.r.w = r.w;
-    FRAME_BUFFER.r.h = r.h;
+    {
+        std::lock_guard<std::mutex> lock(MODE_MUTEX);
 
-    push_capture_event(capture_event_e::new_video_mode);
+        RESOLUTION.w = r.w;
+        RESOLUTION.h = r.h;
+    }
+
+    kc_push_capture_event(capture_event_e::new_video_mode);
 
     return true;
 }
 
 refresh_rate_s kc_get_capture_refresh_rate(void)
 {
-    return refresh_rate_s(CURRENT_REFRESH_RATE);
+    std::lock_guard<std::mutex> lock(MODE_MUTEX);
+
+    return REFRESH_RATE;
 }
 
 bool kc_set_capture_input_channel(const unsigned idx)
@@ -209,27 +276,83 @@ bool kc_set_capture_input_channel(const unsigned idx)
     return true;
 }
 
-const captured_frame_s& kc_get_frame_buffer(void)
+bool kc_open_concurrent_input_channel(const unsigned idx)
 {
-    return FRAME_BUFFER;
+    // Not supported.
+
+    (void)idx;
+
+    return false;
 }
 
-capture_event_e kc_pop_capture_event_queue(void)
+bool kc_close_concurrent_input_channel(const unsigned idx)
 {
-    if (pop_capture_event(capture_event_e::invalid_signal))
-    {
-        return capture_event_e::invalid_signal;
-    }
-    else if (pop_capture_event(capture_event_e::new_video_mode))
+    // Not supported.
+
+    (void)idx;
+
+    return false;
+}
+
+std::vector<unsigned> kc_get_concurrent_input_channels(void)
+{
+    return {};
+}
+
+bool kc_open_standby_input_channel(const unsigned idx)
+{
+    // Not supported.
+
+    (void)idx;
+
+    return false;
+}
+
+bool kc_close_standby_input_channel(const unsigned idx)
+{
+    // Not supported.
+
+    (void)idx;
+
+    return false;
+}
+
+std::vector<unsigned> kc_get_standby_input_channels(void)
+{
+    return {};
+}
+
+const captured_frame_s& kc_get_frame_buffer(const unsigned channelIdx)
+{
+    // Only the current input channel is captured.
+    (void)channelIdx;
+
+    const captured_frame_s *const frame = FRAME_RING.front();
+
+    k_assert(frame, "Attempting to access the frame buffer while no captured frame was available.");
+
+    return *frame;
+}
+
+unsigned kc_drain_capture_event_queue(capture_event_s *const dst, const unsigned maxCount)
+{
+    if (!maxCount)
     {
-        return capture_event_e::new_video_mode;
+        return 0;
     }
-    else if (pop_capture_event(capture_event_e::new_frame))
+
+    // Leave room for a new frame event.
+    unsigned numEvents = kc_capture_event_queue().drain(dst, (maxCount - 1));
+
+    // Generated frames are queued in the frame ring rather than as events. We
+    // report the oldest of them, with the number of frames queued as the
+    // payload.
+    if (FRAME_RING.front())
     {
-        return capture_event_e::new_frame;
+        dst[numEvents++] = {capture_event_e::new_frame, FRAME_RING.occupancy(), std::chrono::steady_clock::now(), CUR_INPUT_CHANNEL_IDX};
     }
 
-    return capture_event_e::none;
+    return numEvents;
 }
 
 bool kc_device_supports_component_capture(void)
@@ -279,19 +402,41 @@ bool kc_has_valid_device(void)
 
 capture_pixel_format_e kc_get_capture_pixel_format(void)
 {
-    return FRAME_BUFFER.pixelFormat;
+    std::lock_guard<std::mutex> lock(MODE_MUTEX);
+
+    return PIXEL_FORMAT;
 }
 
 uint kc_get_capture_color_depth(void)
 {
-    return (unsigned)FRAME_BUFFER.r.bpp;
+    std::lock_guard<std::mutex> lock(MODE_MUTEX);
+
+    return (unsigned)RESOLUTION.bpp;
 }
 
 uint kc_get_missed_frames_count(void)
+{
+    return FRAME_RING.num_dropped();
+}
+
+uint kc_get_skipped_frames_count(void)
 {
     return 0;
 }
 
+frame_queue_status_s kc_get_frame_queue_status(void)
+{
+    return {FRAME_RING.capacity(),
+            FRAME_RING.occupancy(),
+            FRAME_RING.peak_occupancy()};
+}
+
+back_buffer_status_s kc_get_back_buffer_status(void)
+{
+    // Frames are generated directly into the frame queue.
+    return {0, false, 0, 0, {}};
+}
+
 uint kc_get_device_input_channel_idx(void)
 {
     return CUR_INPUT_CHANNEL_IDX;
@@ -299,7 +444,33 @@ uint kc_get_device_input_channel_idx(void)
 
 resolution_s kc_get_capture_resolution(void)
 {
-    return FRAME_BUFFER.r;
+    std::lock_guard<std::mutex> lock(MODE_MUTEX);
+
+    return RESOLUTION;
+}
+
+resolution_s kc_get_source_resolution(void)
+{
+    return kc_get_capture_resolution();
+}
+
+bool kc_set_capture_region(const capture_region_s &region)
+{
+    // Not supported, other than for capturing the whole frame.
+
+    return region.is_full_frame();
+}
+
+capture_region_s kc_get_capture_region(void)
+{
+    return capture_region_s{};
+}
+
+bool kc_set_hardware_scaling_resolution(const resolution_s &r)
+{
+    // Not supported, other than for not scaling.
+
+    return (!r.w || !r.h);
 }
 
 resolution_s kc_get_device_minimum_resolution(void)
@@ -364,9 +535,13 @@ bool kc_set_deinterlacing_mode(const capture_deinterlacing_mode_e mode)
     return false;
 }
 
-bool kc_mark_frame_buffer_as_processed(void)
+bool kc_mark_frame_buffer_as_processed(const unsigned channelIdx)
 {
-    return false;
+    (void)channelIdx;
+
+    FRAME_RING.pop_front();
+
+    return true;
 }
 
 bool kc_has_valid_signal(void)
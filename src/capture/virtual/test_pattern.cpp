@@ -0,0 +1,202 @@
+/*
+ * 2021 Tarpeeksi Hyvae Soft
+ *
+ * Software: VCS
+ *
+ */
+
+#include <algorithm>
+#include <cstring>
+#include "capture/virtual/test_pattern.h"
+
+// The number of prebuilt gradient rows. The gradient's vertical component
+// repeats with this period.
+static const unsigned NUM_GRADIENT_ROWS = 256;
+
+// Returns the position at the given step of a motion that bounces back and forth
+// between 0 and the given maximum.
+static unsigned bounce(const unsigned step, const unsigned max)
+{
+    if (!max)
+    {
+        return 0;
+    }
+
+    const unsigned pos = (step % (max * 2));
+
+    return ((pos <= max)? pos : ((max * 2) - pos));
+}
+
+void test_pattern_c::prepare(const test_pattern_e pattern,
+                             const resolution_s &resolution,
+                             const capture_pixel_format_e pixelFormat)
+{
+    k_assert(((resolution.w <= MAX_CAPTURE_WIDTH) &&
+              (resolution.h <= MAX_CAPTURE_HEIGHT)),
+             "Attempting to prepare a test pattern larger than the maximum capture resolution.");
+
+    this->pattern = pattern;
+    this->resolution = resolution;
+    this->pixelFormat = pixelFormat;
+    this->bytesPerPixel = ((pixelFormat == capture_pixel_format_e::rgb_888)? 4 : 2);
+    this->rowStride = ((resolution.w + rowPadding) * this->bytesPerPixel);
+
+    const unsigned rowWidth = (resolution.w + rowPadding);
+
+    if (pattern == test_pattern_e::full_change)
+    {
+        u32 seed = 0x2545f491;
+
+        this->rows.resize(numNoiseRows * this->rowStride);
+
+        for (unsigned y = 0; y < numNoiseRows; y++)
+        {
+            for (unsigned x = 0; x < rowWidth; x++)
+            {
+                // Xorshift.
+                seed ^= (seed << 13);
+                seed ^= (seed >> 17);
+                seed ^= (seed << 5);
+
+                const u32 pixel = this->pack_pixel(((seed >> 0) & 255), ((seed >> 8) & 255), ((seed >> 16) & 255));
+
+                memcpy(&this->rows[(y * this->rowStride) + (x * this->bytesPerPixel)], &pixel, this->bytesPerPixel);
+            }
+        }
+    }
+    else
+    {
+        this->rows.resize(NUM_GRADIENT_ROWS * this->rowStride);
+
+        for (unsigned y = 0; y < NUM_GRADIENT_ROWS; y++)
+        {
+            for (unsigned x = 0; x < rowWidth; x++)
+            {
+                const u32 pixel = this->pack_pixel(150, y, (x % 256));
+
+                memcpy(&this->rows[(y * this->rowStride) + (x * this->bytesPerPixel)], &pixel, this->bytesPerPixel);
+            }
+        }
+    }
+
+    if (pattern == test_pattern_e::sprite)
+    {
+        const unsigned size = std::min<unsigned>({spriteSize, unsigned(resolution.w), unsigned(resolution.h)});
+        const u32 pixel = this->pack_pixel(255, 255, 255);
+
+        this->spriteRow.resize(size * this->bytesPerPixel);
+
+        for (unsigned x = 0; x < size; x++)
+        {
+            memcpy(&this->spriteRow[x * this->bytesPerPixel], &pixel, this->bytesPerPixel);
+        }
+    }
+
+    return;
+}
+
+bool test_pattern_c::is_prepared_for(const test_pattern_e pattern,
+                                     const resolution_s &resolution,
+                                     const capture_pixel_format_e pixelFormat) const
+{
+    return (!this->rows.empty() &&
+            (this->pattern == pattern) &&
+            (this->resolution.w == resolution.w) &&
+            (this->resolution.h == resolution.h) &&
+            (this->pixelFormat == pixelFormat));
+}
+
+void test_pattern_c::draw(u8 *const dst, const unsigned frameNumber) const
+{
+    k_assert(!this->rows.empty(), "Attempting to draw a test pattern that hasn't been prepared.");
+
+    const unsigned rowSize = (this->resolution.w * this->bytesPerPixel);
+
+    switch (this->pattern)
+    {
+        case test_pattern_e::scroll:
+        {
+            for (unsigned y = 0; y < this->resolution.h; y++)
+            {
+                memcpy((dst + (y * rowSize)),
+                       this->row(((frameNumber + y) % NUM_GRADIENT_ROWS), (frameNumber % rowPadding)),
+                       rowSize);
+            }
+
+            break;
+        }
+        case test_pattern_e::full_change:
+        {
+            // Successive frames take each row from a different noise row, at a
+            // different offset.
+            for (unsigned y = 0; y < this->resolution.h; y++)
+            {
+                memcpy((dst + (y * rowSize)),
+                       this->row(((y + (frameNumber * 17)) % numNoiseRows), (((frameNumber * 29) + (y * 7)) % rowPadding)),
+                       rowSize);
+            }
+
+            break;
+        }
+        case test_pattern_e::still:
+        case test_pattern_e::sprite:
+        {
+            for (unsigned y = 0; y < this->resolution.h; y++)
+            {
+                memcpy((dst + (y * rowSize)),
+                       this->row((y % NUM_GRADIENT_ROWS), 0),
+                       rowSize);
+            }
+
+            if (this->pattern == test_pattern_e::sprite)
+            {
+                const unsigned size = (this->spriteRow.size() / this->bytesPerPixel);
+                const unsigned spriteX = bounce((frameNumber * 4), (this->resolution.w - size));
+                const unsigned spriteY = bounce((frameNumber * 3), (this->resolution.h - size));
+
+                for (unsigned y = 0; y < size; y++)
+                {
+                    memcpy((dst + ((spriteY + y) * rowSize) + (spriteX * this->bytesPerPixel)),
+                           this->spriteRow.data(),
+                           this->spriteRow.size());
+                }
+            }
+
+            break;
+        }
+    }
+
+    return;
+}
+
+const u8* test_pattern_c::row(const unsigned rowIdx, const unsigned pixelOffset) const
+{
+    return &this->rows[(rowIdx * this->rowStride) + (pixelOffset * this->bytesPerPixel)];
+}
+
+u32 test_pattern_c::pack_pixel(const unsigned red, const unsigned green, const unsigned blue) const
+{
+    switch (this->pixelFormat)
+    {
+        case capture_pixel_format_e::rgb_565:
+        {
+            return (((red >> 3) << 11) |
+                    ((green >> 2) << 5) |
+                    ((blue >> 3) << 0));
+        }
+        case capture_pixel_format_e::rgb_555:
+        {
+            return ((1 << 15) |
+                    ((red >> 3) << 10) |
+                    ((green >> 3) << 5) |
+                    ((blue >> 3) << 0));
+        }
+        default:
+        {
+            return ((255u << 24) |
+                    (red << 16) |
+                    (green << 8) |
+                    (blue << 0));
+        }
+    }
+}
@@ -0,0 +1,105 @@
+/*
+ * 2021 Tarpeeksi Hyvae Soft
+ *
+ * Software: VCS
+ *
+ */
+
+#ifndef VCS_CAPTURE_VIRTUAL_TEST_PATTERN_H
+#define VCS_CAPTURE_VIRTUAL_TEST_PATTERN_H
+
+#include <vector>
+#include "common/globals.h"
+#include "capture/capture.h"
+
+// The kinds of motion in the virtual capture device's test patterns.
+enum class test_pattern_e
+{
+    // A gradient that stays put, so that every frame is identical.
+    still,
+
+    // A gradient that scrolls diagonally by one pixel per frame.
+    scroll,
+
+    // Noise that changes entirely from one frame to the next.
+    full_change,
+
+    // A still gradient with a small block bouncing around on it.
+    sprite,
+};
+
+// Draws the frames of a test pattern for the virtual capture device.
+//
+// The pattern's pixel rows are prebuilt for a given resolution and pixel format,
+// so that drawing a frame is a matter of copying whole rows rather than of
+// computing individual pixels; which keeps the drawing from limiting the frame
+// rate even at the maximum capture resolution and rates of several hundred Hz.
+//
+// Usage:
+//
+//   1. Build the pattern's rows for the frames to be drawn:
+//
+//      test_pattern_c pattern;
+//      pattern.prepare(test_pattern_e::scroll, {640, 480, 32}, capture_pixel_format_e::rgb_888);
+//
+//   2. Draw each frame:
+//
+//      pattern.draw(frame.pixels.data(), frameNumber);
+//
+//   3. Call prepare() again whenever the pattern, resolution, or pixel format
+//      changes.
+//
+class test_pattern_c
+{
+public:
+    // Builds the rows of the given pattern for frames of the given resolution
+    // and pixel format.
+    void prepare(const test_pattern_e pattern,
+                 const resolution_s &resolution,
+                 const capture_pixel_format_e pixelFormat);
+
+    // Draws the pattern's frame of the given number into dst, which must have
+    // room for the full frame at the prepared resolution and pixel format.
+    void draw(u8 *const dst, const unsigned frameNumber) const;
+
+    // Returns true if the pattern's rows have been built for the given pattern,
+    // resolution, and pixel format; false otherwise.
+    bool is_prepared_for(const test_pattern_e pattern,
+                         const resolution_s &resolution,
+                         const capture_pixel_format_e pixelFormat) const;
+
+private:
+    // Returns a pointer to the start of the given prebuilt row, offset by the
+    // given number of pixels (less than rowPadding).
+    const u8* row(const unsigned rowIdx, const unsigned pixelOffset) const;
+
+    // Returns the given color, with components in the range 0-255, packed into
+    // the current pixel format.
+    u32 pack_pixel(const unsigned red, const unsigned green, const unsigned blue) const;
+
+    test_pattern_e pattern = test_pattern_e::scroll;
+    resolution_s resolution = {0, 0, 0};
+    capture_pixel_format_e pixelFormat = capture_pixel_format_e::rgb_888;
+    unsigned bytesPerPixel = 0;
+
+    // Each prebuilt row is wider than a frame by this many pixels, so that
+    // horizontal motion can be had by starting the copy at an offset.
+    static const unsigned rowPadding = 256;
+
+    // The number of prebuilt noise rows for the full-change pattern. Being
+    // prime, it doesn't line up with the frame's dimensions.
+    static const unsigned numNoiseRows = 61;
+
+    // The side length, in pixels, of the sprite pattern's block.
+    static const unsigned spriteSize = 64;
+
+    // The prebuilt rows, each (resolution.w + rowPadding) pixels wide: 256 rows
+    // of gradient, or numNoiseRows rows of noise for the full-change pattern.
+    std::vector<u8> rows;
+    unsigned rowStride = 0;
+
+    // One row of the sprite pattern's block.
+    std::vector<u8> spriteRow;
+};
+
+#endif
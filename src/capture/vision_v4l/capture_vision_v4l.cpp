@@ -12,6 +12,8 @@
  */
 
 #include <unordered_map>
+#include <algorithm>
+#include <map>
 #include <cmath>
 #include <atomic>
 #include <vector>
@@ -25,8 +27,12 @@
 #include <chrono>
 #include <poll.h>
 #include "capture/vision_v4l/input_channel_v4l.h"
+#include "capture/vision_v4l/v4l_device_registry.h"
+#include "capture/captured_frame_ring.h"
+#include "capture/capture_event_queue.h"
 #include "capture/video_presets.h"
 #include "capture/vision_v4l/ic_v4l_video_parameters.h"
+#include "common/command_line/command_line.h"
 #include "common/propagate/vcs_event.h"
 
 #define INCLUDE_VISION
@@ -36,12 +42,40 @@
 // The input channel (/dev/videoX device) we're currently capturing from.
 static input_channel_v4l_c *CUR_INPUT_CHANNEL = nullptr;
 
-// The latest frame we've received from the capture device.
-static captured_frame_s FRAME_BUFFER;
+// Frames we've received from the current input channel but which VCS hasn't
+// yet finished processing, oldest first. Changes hands along with the channel
+// when a standby channel is made the current one (see
+// kc_open_standby_input_channel()).
+static captured_frame_ring_c *FRAME_RING = nullptr;
+
+// The Vision capture inputs present on the system.
+static v4l_device_registry_c DEVICE_REGISTRY;
 
 // The numeric index of the currently-active input channel. This would be 0 for
-// /dev/video0, 4 for /dev/video4, etc.
-static unsigned CUR_INPUT_CHANNEL_IDX = 0;
+// /dev/video0, 4 for /dev/video4, etc. Set by the main thread, but also read by
+// the capture threads (e.g. via kc_push_capture_event()).
+static std::atomic<unsigned> CUR_INPUT_CHANNEL_IDX = {0};
+
+// Input channels capturing alongside the current one, each with its own frame
+// queue: either concurrently (see kc_open_concurrent_input_channel()) or on
+// standby (see kc_open_standby_input_channel()), in which case their frames are
+// discarded. Keyed by channel index.
+struct concurrent_input_channel_s
+{
+    input_channel_v4l_c *inputChannel = nullptr;
+    captured_frame_ring_c *frameRing = nullptr;
+    bool isStandby = false;
+};
+static std::map<unsigned, concurrent_input_channel_s*> CONCURRENT_INPUT_CHANNELS;
+
+// The region of the input signal's frames we've been asked to capture. Carried
+// over to new input channels as they're created.
+static capture_region_s CAPTURE_REGION = {};
+
+// The resolution we've been asked to have the current channel's frames scaled
+// to in hardware, or 0 x 0 for no scaling. Carried over to new input channels
+// as they're created.
+static resolution_s HARDWARE_SCALING_RESOLUTION = {0, 0, 0};
 
 // Cumulative count of frames that were sent to us by the capture device but which
 // VCS was too busy to process. Note that this count doesn't account for the missed
@@ -50,51 +84,311 @@ static unsigned CUR_INPUT_CHANNEL_IDX = 0;
 // channel's value.
 static unsigned NUM_MISSED_FRAMES = 0;
 
-capture_event_e kc_pop_capture_event_queue(void)
+// Likewise, the cumulative count of frames skipped in favor of newer ones on
+// previous input channels (see kc_get_skipped_frames_count()).
+static unsigned NUM_SKIPPED_FRAMES = 0;
+
+static input_channel_v4l_c* create_concurrent_input_channel(const unsigned idx, captured_frame_ring_c *const frameRing)
 {
-    if (!CUR_INPUT_CHANNEL)
+    // Capture regions and video presets apply only to the current channel.
+    return new input_channel_v4l_c(idx,
+                                   input_channel_v4l_c::minNumBackBuffers,
+                                   frameRing,
+                                   kcom_zero_copy_capture(),
+                                   kcom_convert_on_capture(),
+                                   kcom_drain_to_newest(),
+                                   kcom_capture_memory(),
+                                   capture_region_s{},
+                                   resolution_s{0, 0, 0});
+}
+
+// Returns the input channel of the given index, which is either the current
+// channel or a concurrent one; and its frame queue.
+static std::pair<input_channel_v4l_c*, captured_frame_ring_c*> input_channel_of(const unsigned channelIdx)
+{
+    if (channelIdx == CUR_INPUT_CHANNEL_IDX)
     {
-        return capture_event_e::unrecoverable_error;
+        return {CUR_INPUT_CHANNEL, FRAME_RING};
     }
-    else if (CUR_INPUT_CHANNEL->pop_capture_event(capture_event_e::unrecoverable_error))
+
+    const auto concurrent = CONCURRENT_INPUT_CHANNELS.find(channelIdx);
+
+    k_assert((concurrent != CONCURRENT_INPUT_CHANNELS.end()),
+             "Attempting to access an input channel that isn't capturing.");
+
+    return {concurrent->second->inputChannel, concurrent->second->frameRing};
+}
+
+// Acts on an event reported by a concurrently-capturing input channel. Such
+// events aren't passed on to VCS, which only follows the current channel.
+static void handle_concurrent_input_channel_event(concurrent_input_channel_s *const channel,
+                                                  const capture_event_s &event)
+{
+    switch (event.type)
     {
-        CUR_INPUT_CHANNEL->captureStatus.invalidDevice = true;
+        case capture_event_e::unrecoverable_error:
+        {
+            NBENE(("The concurrent input channel /dev/video%u has reported an unrecoverable error.", event.channel));
+
+            channel->inputChannel->captureStatus.invalidDevice = true;
+
+            break;
+        }
+        case capture_event_e::new_video_mode:
+        {
+            if (channel->inputChannel->needs_restart())
+            {
+                delete channel->inputChannel;
+                channel->frameRing->reset();
+                channel->inputChannel = create_concurrent_input_channel(event.channel, channel->frameRing);
+            }
+
+            channel->inputChannel->captureStatus.videoParameters.invalidate();
 
-        return capture_event_e::unrecoverable_error;
+            break;
+        }
+        default: break;
     }
-    else if (CUR_INPUT_CHANNEL->pop_capture_event(capture_event_e::new_video_mode))
+
+    return;
+}
+
+// Starts capturing on the given input channel alongside the current one, either
+// concurrently or on standby. Returns true on success; false otherwise.
+static bool open_input_channel(const unsigned idx, const bool isStandby)
+{
+    auto *const channel = new concurrent_input_channel_s;
+
+    // The frame queue will become the current channel's if the channel is made
+    // the current one, so it's sized to match.
+    channel->isStandby = isStandby;
+    channel->frameRing = new captured_frame_ring_c;
+    channel->frameRing->allocate(FRAME_RING->capacity(), "Concurrent capture frame queue (V4L)");
+    channel->frameRing->set_overflow_policy(kcom_frame_queue_overflow_policy());
+    channel->inputChannel = create_concurrent_input_channel(idx, channel->frameRing);
+
+    if (!channel->inputChannel->is_capturing())
     {
-        // Re-create the input channel for the new video mode.
-        kc_set_capture_input_channel(CUR_INPUT_CHANNEL_IDX);
+        delete channel->inputChannel;
+        channel->frameRing->release();
+        delete channel->frameRing;
+        delete channel;
 
-        return capture_event_e::none;
+        return false;
     }
-    else if (CUR_INPUT_CHANNEL->pop_capture_event(capture_event_e::signal_lost))
+
+    CONCURRENT_INPUT_CHANNELS[idx] = channel;
+
+    return true;
+}
+
+// Stops capturing on the given concurrent or standby input channel.
+static void close_input_channel(std::map<unsigned, concurrent_input_channel_s*>::iterator channel)
+{
+    // Stops the channel's capture thread, so nothing will be writing into the
+    // frame queue after this.
+    delete channel->second->inputChannel;
+
+    channel->second->frameRing->release();
+    delete channel->second->frameRing;
+    delete channel->second;
+
+    CONCURRENT_INPUT_CHANNELS.erase(channel);
+
+    return;
+}
+
+// Makes the given concurrent or standby input channel the current one. As the
+// channel is already capturing, this takes effect without the delay of opening
+// the device and negotiating its format. If the channel was on standby, the
+// current channel goes on standby in its place; otherwise, the current channel
+// is closed.
+static void swap_in_input_channel(std::map<unsigned, concurrent_input_channel_s*>::iterator channel)
+{
+    const unsigned idx = channel->first;
+    concurrent_input_channel_s *const incoming = channel->second;
+
+    CONCURRENT_INPUT_CHANNELS.erase(channel);
+
+    NUM_MISSED_FRAMES += CUR_INPUT_CHANNEL->captureStatus.numNewFrameEventsSkipped;
+    NUM_SKIPPED_FRAMES += CUR_INPUT_CHANNEL->captureStatus.numFramesDrained;
+
+    if (incoming->isStandby)
     {
-        return capture_event_e::signal_lost;
+        auto *const outgoing = new concurrent_input_channel_s;
+
+        outgoing->isStandby = true;
+        outgoing->frameRing = FRAME_RING;
+        outgoing->inputChannel = CUR_INPUT_CHANNEL;
+        outgoing->inputChannel->set_capture_region(capture_region_s{});
+        outgoing->inputChannel->set_hardware_scaling_resolution({0, 0, 0});
+
+        // Any frames still in the queue will be discarded along with the
+        // channel's other standby frames.
+        CONCURRENT_INPUT_CHANNELS[CUR_INPUT_CHANNEL_IDX] = outgoing;
+
+        INFO(("Input channel /dev/video%u is now on standby.", CUR_INPUT_CHANNEL_IDX.load()));
     }
-    else if (CUR_INPUT_CHANNEL->pop_capture_event(capture_event_e::signal_gained))
+    else
     {
-        return capture_event_e::signal_gained;
+        delete CUR_INPUT_CHANNEL;
+        FRAME_RING->release();
+        delete FRAME_RING;
     }
-    else if (CUR_INPUT_CHANNEL->pop_capture_event(capture_event_e::invalid_signal))
+
+    CUR_INPUT_CHANNEL = incoming->inputChannel;
+    CUR_INPUT_CHANNEL_IDX = idx;
+    FRAME_RING = incoming->frameRing;
+
+    delete incoming;
+
+    // Frames the channel missed before it was the current one weren't VCS's to
+    // miss.
+    CUR_INPUT_CHANNEL->captureStatus.numNewFrameEventsSkipped = 0;
+    CUR_INPUT_CHANNEL->captureStatus.numFramesDrained = 0;
+    CUR_INPUT_CHANNEL->captureStatus.videoParameters.invalidate();
+    CUR_INPUT_CHANNEL->set_capture_region(CAPTURE_REGION);
+    CUR_INPUT_CHANNEL->set_hardware_scaling_resolution(HARDWARE_SCALING_RESOLUTION);
+
+    // VCS hasn't been following the channel's signal, so we bring it up to date.
+    if (CUR_INPUT_CHANNEL->captureStatus.invalidDevice)
     {
-        return capture_event_e::invalid_signal;
+        kc_push_capture_event(capture_event_e::invalid_device, 0, int(idx));
     }
-    else if (CUR_INPUT_CHANNEL->pop_capture_event(capture_event_e::invalid_device))
+    else if (CUR_INPUT_CHANNEL->captureStatus.invalidSignal)
     {
-        return capture_event_e::invalid_device;
+        kc_push_capture_event(capture_event_e::invalid_signal, 0, int(idx));
     }
-    else if (CUR_INPUT_CHANNEL->pop_capture_event(capture_event_e::new_frame))
+    else if (CUR_INPUT_CHANNEL->captureStatus.noSignal)
     {
-        return capture_event_e::new_frame;
+        kc_push_capture_event(capture_event_e::signal_lost, 0, int(idx));
     }
-    else if (CUR_INPUT_CHANNEL->pop_capture_event(capture_event_e::sleep))
+    else
     {
-        return capture_event_e::sleep;
+        kc_push_capture_event(capture_event_e::signal_gained, 0, int(idx));
     }
 
-    return capture_event_e::none;
+    return;
+}
+
+unsigned kc_drain_capture_event_queue(capture_event_s *const dst, const unsigned maxCount)
+{
+    if (!maxCount)
+    {
+        return 0;
+    }
+
+    if (!CUR_INPUT_CHANNEL)
+    {
+        dst[0] = {capture_event_e::unrecoverable_error, 0, std::chrono::steady_clock::now(), CUR_INPUT_CHANNEL_IDX};
+
+        return 1;
+    }
+
+    unsigned numEvents = 0;
+    capture_event_s event;
+
+    // Leave room for a new frame event for each input channel.
+    const unsigned numFrameEvents = std::min(maxCount, unsigned(1 + CONCURRENT_INPUT_CHANNELS.size()));
+
+    while ((numEvents < (maxCount - numFrameEvents)) &&
+           kc_capture_event_queue().pop(&event))
+    {
+        // Events from input channels other than the current one. Note that the
+        // channel may since have been closed.
+        if (event.channel != CUR_INPUT_CHANNEL_IDX)
+        {
+            const auto concurrent = CONCURRENT_INPUT_CHANNELS.find(event.channel);
+
+            if (concurrent != CONCURRENT_INPUT_CHANNELS.end())
+            {
+                handle_concurrent_input_channel_event(concurrent->second, event);
+            }
+
+            continue;
+        }
+
+        switch (event.type)
+        {
+            case capture_event_e::unrecoverable_error:
+            {
+                CUR_INPUT_CHANNEL->captureStatus.invalidDevice = true;
+                break;
+            }
+            case capture_event_e::new_video_mode:
+            {
+                // The input channel normally adapts to a new video mode by
+                // itself, but if it couldn't, we re-create it for the mode.
+                if (CUR_INPUT_CHANNEL->needs_restart())
+                {
+                    kc_set_capture_input_channel(CUR_INPUT_CHANNEL_IDX);
+                }
+
+                // The device's video parameters and their ranges may differ
+                // between video modes.
+                CUR_INPUT_CHANNEL->captureStatus.videoParameters.invalidate();
+
+                break;
+            }
+            default: break;
+        }
+
+        dst[numEvents++] = event;
+    }
+
+    // Captured frames are queued in the frame ring rather than as events. We
+    // report the oldest of them, with the number of frames queued as the
+    // payload.
+    if (FRAME_RING->front())
+    {
+        dst[numEvents++] = {capture_event_e::new_frame, FRAME_RING->occupancy(), std::chrono::steady_clock::now(), CUR_INPUT_CHANNEL_IDX};
+    }
+
+    // Report the frames of the concurrent input channels likewise, but only
+    // while they have a valid signal, as VCS doesn't track their signal status.
+    // The frames of standby channels are discarded as they come in.
+    for (auto &concurrent: CONCURRENT_INPUT_CHANNELS)
+    {
+        input_channel_v4l_c *const inputChannel = concurrent.second->inputChannel;
+        captured_frame_ring_c &frameRing = *concurrent.second->frameRing;
+
+        if (concurrent.second->isStandby)
+        {
+            while (frameRing.front())
+            {
+                inputChannel->release_frame(frameRing.front());
+                frameRing.pop_front();
+            }
+
+            continue;
+        }
+
+        if (!frameRing.front() ||
+            (numEvents >= maxCount))
+        {
+            continue;
+        }
+
+        if (inputChannel->captureStatus.noSignal ||
+            inputChannel->captureStatus.invalidSignal ||
+            inputChannel->captureStatus.invalidDevice)
+        {
+            inputChannel->release_frame(frameRing.front());
+            frameRing.pop_front();
+
+            continue;
+        }
+
+        dst[numEvents++] = {capture_event_e::new_frame, frameRing.occupancy(), std::chrono::steady_clock::now(), concurrent.first};
+    }
+
+    if (!numEvents &&
+        !CUR_INPUT_CHANNEL->is_capturing())
+    {
+        dst[numEvents++] = {capture_event_e::sleep, 0, std::chrono::steady_clock::now(), CUR_INPUT_CHANNEL_IDX};
+    }
+
+    return numEvents;
 }
 
 resolution_s kc_get_capture_resolution(void)
@@ -105,6 +399,68 @@ resolution_s kc_get_capture_resolution(void)
     return CUR_INPUT_CHANNEL->captureStatus.resolution;
 }
 
+resolution_s kc_get_source_resolution(void)
+{
+    k_assert(CUR_INPUT_CHANNEL,
+             "Attempting to query input channel parameters on a null channel.");
+
+    return CUR_INPUT_CHANNEL->captureStatus.sourceResolution;
+}
+
+bool kc_set_capture_region(const capture_region_s &region)
+{
+    k_assert(CUR_INPUT_CHANNEL,
+             "Attempting to set input channel parameters on a null channel.");
+
+    if (region == CAPTURE_REGION)
+    {
+        return true;
+    }
+
+    if (!region.is_full_frame())
+    {
+        const resolution_s minres = kc_get_device_minimum_resolution();
+
+        if ((region.w < minres.w) ||
+            (region.h < minres.h))
+        {
+            NBENE(("Was asked to set a capture region (%lu x %lu) smaller than the minimum capture resolution (%lu x %lu). Ignoring it.",
+                   region.w, region.h, minres.w, minres.h));
+
+            return false;
+        }
+    }
+
+    CAPTURE_REGION = region;
+    CUR_INPUT_CHANNEL->set_capture_region(region);
+
+    return true;
+}
+
+capture_region_s kc_get_capture_region(void)
+{
+    return CAPTURE_REGION;
+}
+
+bool kc_set_hardware_scaling_resolution(const resolution_s &r)
+{
+    k_assert(CUR_INPUT_CHANNEL,
+             "Attempting to set input channel parameters on a null channel.");
+
+    const resolution_s scaledResolution = ((!r.w || !r.h)? resolution_s{0, 0, 0} : resolution_s{r.w, r.h, 32});
+
+    if ((scaledResolution.w == HARDWARE_SCALING_RESOLUTION.w) &&
+        (scaledResolution.h == HARDWARE_SCALING_RESOLUTION.h))
+    {
+        return true;
+    }
+
+    HARDWARE_SCALING_RESOLUTION = scaledResolution;
+    CUR_INPUT_CHANNEL->set_hardware_scaling_resolution(scaledResolution);
+
+    return true;
+}
+
 resolution_s kc_get_device_minimum_resolution(void)
 {
     /// TODO: Query actual hardware parameters for this.
@@ -136,6 +492,14 @@ uint kc_get_missed_frames_count(void)
     return (NUM_MISSED_FRAMES + CUR_INPUT_CHANNEL->captureStatus.numNewFrameEventsSkipped);
 }
 
+uint kc_get_skipped_frames_count(void)
+{
+    k_assert(CUR_INPUT_CHANNEL,
+             "Attempting to query input channel parameters on a null channel.");
+
+    return (NUM_SKIPPED_FRAMES + CUR_INPUT_CHANNEL->captureStatus.numFramesDrained);
+}
+
 bool kc_has_valid_signal(void)
 {
     k_assert(CUR_INPUT_CHANNEL,
@@ -174,16 +538,33 @@ bool kc_initialize_device(void)
 
     kc_evSignalGained.listen([]
     {
+        CUR_INPUT_CHANNEL->captureStatus.videoParameters.invalidate();
         CUR_INPUT_CHANNEL->captureStatus.videoParameters.update();
         kc_evNewProposedVideoMode.fire(kc_get_capture_video_mode());
     });
 
-    FRAME_BUFFER.r = {640, 480, 32};
-    FRAME_BUFFER.pixelFormat = capture_pixel_format_e::rgb_888;
-    FRAME_BUFFER.pixels.allocate(MAX_NUM_BYTES_IN_CAPTURED_FRAME, "Capture frame buffer (V4L)");
+    FRAME_RING = new captured_frame_ring_c;
+    FRAME_RING->allocate(kcom_frame_queue_size(), "Capture frame queue (V4L)");
+    FRAME_RING->set_overflow_policy(kcom_frame_queue_overflow_policy());
+
+    INFO(("Queueing up to %u captured frames, keeping the %s on overflow.",
+          FRAME_RING->capacity(),
+          ((kcom_frame_queue_overflow_policy() == captured_frame_ring_c::overflow_policy_e::keep_newest)? "newest" : "oldest")));
+
+    DEVICE_REGISTRY.initialize();
 
     kc_set_capture_input_channel(INPUT_CHANNEL_IDX);
 
+    for (const unsigned idx: kcom_concurrent_input_channels())
+    {
+        kc_open_concurrent_input_channel(idx);
+    }
+
+    for (const unsigned idx: kcom_standby_input_channels())
+    {
+        kc_open_standby_input_channel(idx);
+    }
+
     return true;
 
     fail:
@@ -193,9 +574,16 @@ bool kc_initialize_device(void)
 
 bool kc_release_device(void)
 {
+    while (!CONCURRENT_INPUT_CHANNELS.empty())
+    {
+        close_input_channel(CONCURRENT_INPUT_CHANNELS.begin());
+    }
+
     delete CUR_INPUT_CHANNEL;
 
-    FRAME_BUFFER.pixels.release();
+    FRAME_RING->release();
+    delete FRAME_RING;
+    DEVICE_REGISTRY.release();
 
     return true;
 }
@@ -245,43 +633,9 @@ std::string kc_get_device_firmware_version(void)
 
 int kc_get_device_maximum_input_count(void)
 {
-    const char baseDevicePath[] = "/dev/video";
-    int numInputs = 0;
+    DEVICE_REGISTRY.update();
 
-    // Returns true if the given V4L capabilities appear to indicate a Vision
-    // capture device.
-    const auto is_vision_capture_device = [](const v4l2_capability *const caps) 
-    {
-        const bool usesVisionDriver = (strcmp((const char*)caps->driver, "Vision") == 0);
-        const bool isVisionControlDevice = (strcmp((const char*)caps->card, "Vision Control") == 0);
-
-        return (usesVisionDriver && !isVisionControlDevice);
-    };
-
-    /// TODO: Make sure we only count inputs on the capture card that we're
-    /// currently capturing on, rather than tallying up the number of inputs on
-    /// all the Vision capture cards on the system.
-    for (int i = 0; i < 64; i++) 
-    {
-        v4l2_capability deviceCaps; 
-
-        const int deviceFile = open((baseDevicePath + std::to_string(i)).c_str(), O_RDONLY);
-        
-        if (deviceFile < 0)
-        {
-            continue;
-        }
-
-        if ((ioctl(deviceFile, VIDIOC_QUERYCAP, &deviceCaps) >= 0) &&
-            is_vision_capture_device(&deviceCaps))
-        {
-            numInputs++;
-        }
-
-        close(deviceFile);
-    }
-    
-    return numInputs;
+    return int(DEVICE_REGISTRY.num_inputs_on_card_of(CUR_INPUT_CHANNEL_IDX));
 }
 
 uint kc_get_device_input_channel_idx(void)
@@ -299,7 +653,7 @@ video_signal_parameters_s kc_get_device_video_parameters(void)
         return kc_get_device_video_parameter_defaults();
     }
 
-    auto videoParams = CUR_INPUT_CHANNEL->captureStatus.videoParameters;
+    auto &videoParams = CUR_INPUT_CHANNEL->captureStatus.videoParameters;
 
     videoParams.update();
 
@@ -327,7 +681,7 @@ video_signal_parameters_s kc_get_device_video_parameter_defaults(void)
     k_assert(CUR_INPUT_CHANNEL,
              "Attempting to query input channel parameters on a null channel.");
 
-    const auto videoParams = CUR_INPUT_CHANNEL->captureStatus.videoParameters;
+    const auto &videoParams = CUR_INPUT_CHANNEL->captureStatus.videoParameters;
 
     video_signal_parameters_s p;
 
@@ -374,7 +728,7 @@ video_signal_parameters_s kc_get_device_video_parameter_minimums(void)
     k_assert(CUR_INPUT_CHANNEL,
              "Attempting to query input channel parameters on a null channel.");
 
-    const auto videoParams = CUR_INPUT_CHANNEL->captureStatus.videoParameters;
+    const auto &videoParams = CUR_INPUT_CHANNEL->captureStatus.videoParameters;
 
     video_signal_parameters_s p;
 
@@ -427,7 +781,7 @@ video_signal_parameters_s kc_get_device_video_parameter_maximums(void)
     k_assert(CUR_INPUT_CHANNEL,
              "Attempting to query input channel parameters on a null channel.");
 
-    const auto videoParams = CUR_INPUT_CHANNEL->captureStatus.videoParameters;
+    const auto &videoParams = CUR_INPUT_CHANNEL->captureStatus.videoParameters;
 
     video_signal_parameters_s p;
 
@@ -475,21 +829,50 @@ video_signal_parameters_s kc_get_device_video_parameter_maximums(void)
     return p;
 }
 
-const captured_frame_s& kc_get_frame_buffer(void)
+const captured_frame_s& kc_get_frame_buffer(const unsigned channelIdx)
 {
-    return FRAME_BUFFER;
+    const captured_frame_s *const frame = input_channel_of(channelIdx).second->front();
+
+    k_assert(frame, "Attempting to access the frame buffer while no captured frame was available.");
+
+    return *frame;
 }
 
-bool kc_mark_frame_buffer_as_processed(void)
+bool kc_mark_frame_buffer_as_processed(const unsigned channelIdx)
 {
-    k_assert(CUR_INPUT_CHANNEL,
+    input_channel_v4l_c *const inputChannel = input_channel_of(channelIdx).first;
+    captured_frame_ring_c *const frameRing = input_channel_of(channelIdx).second;
+
+    k_assert(inputChannel,
              "Attempting to set input channel parameters on a null channel.");
 
-    CUR_INPUT_CHANNEL->captureStatus.numFramesProcessed++;
+    inputChannel->captureStatus.numFramesProcessed++;
 
-    FRAME_BUFFER.processed = true;
+    // If the frame is a view onto one of the input channel's back buffers, the
+    // buffer needs to be handed back to the capture device.
+    const bool wasReleased = (!frameRing->front() ||
+                              inputChannel->release_frame(frameRing->front()));
 
-    return true;
+    frameRing->pop_front();
+
+    return wasReleased;
+}
+
+frame_queue_status_s kc_get_frame_queue_status(void)
+{
+    return {FRAME_RING->capacity(),
+            FRAME_RING->occupancy(),
+            FRAME_RING->peak_occupancy()};
+}
+
+back_buffer_status_s kc_get_back_buffer_status(void)
+{
+    if (!CUR_INPUT_CHANNEL)
+    {
+        return {0, false, 0, 0, {}};
+    }
+
+    return CUR_INPUT_CHANNEL->back_buffer_status();
 }
 
 std::string kc_get_device_api_name(void)
@@ -521,16 +904,59 @@ uint kc_get_capture_color_depth(void)
 
 bool kc_set_capture_input_channel(const unsigned idx)
 {
+    // A channel that's already capturing alongside the current one can take
+    // over without being re-opened.
+    if (CUR_INPUT_CHANNEL &&
+        (idx != CUR_INPUT_CHANNEL_IDX))
+    {
+        const auto concurrent = CONCURRENT_INPUT_CHANNELS.find(idx);
+
+        if (concurrent != CONCURRENT_INPUT_CHANNELS.end())
+        {
+            swap_in_input_channel(concurrent);
+            ks_evInputChannelChanged.fire();
+
+            return true;
+        }
+    }
+
+    // When re-creating the current channel, carry over the number of back
+    // buffers it had adapted to. Other channels start from the minimum.
+    unsigned numBackBuffers = input_channel_v4l_c::minNumBackBuffers;
+
     if (CUR_INPUT_CHANNEL)
     {
+        if (idx == CUR_INPUT_CHANNEL_IDX)
+        {
+            numBackBuffers = std::max(numBackBuffers, CUR_INPUT_CHANNEL->back_buffer_status().count);
+        }
+
         NUM_MISSED_FRAMES += CUR_INPUT_CHANNEL->captureStatus.numNewFrameEventsSkipped;
+        NUM_SKIPPED_FRAMES += CUR_INPUT_CHANNEL->captureStatus.numFramesDrained;
 
         delete CUR_INPUT_CHANNEL;
     }
 
-    CUR_INPUT_CHANNEL = new input_channel_v4l_c((std::string("/dev/video") + std::to_string(idx)),
-                                                3,
-                                                &FRAME_BUFFER);
+    // Any frames still in the queue are from the previous channel.
+    FRAME_RING->reset();
+
+    // A device can stream to only one input channel at a time.
+    if (CONCURRENT_INPUT_CHANNELS.count(idx))
+    {
+        INFO(("Input channel /dev/video%u will no longer be captured concurrently.", idx));
+
+        close_input_channel(CONCURRENT_INPUT_CHANNELS.find(idx));
+    }
+
+    CUR_INPUT_CHANNEL = new input_channel_v4l_c(idx,
+                                                numBackBuffers,
+                                                FRAME_RING,
+                                                kcom_zero_copy_capture(),
+                                                kcom_convert_on_capture(),
+                                                kcom_drain_to_newest(),
+                                                kcom_capture_memory(),
+                                                CAPTURE_REGION,
+                                                HARDWARE_SCALING_RESOLUTION);
 
     CUR_INPUT_CHANNEL_IDX = idx;
 
@@ -539,6 +965,126 @@ bool kc_set_capture_input_channel(const unsigned idx)
     return true;
 }
 
+bool kc_open_concurrent_input_channel(const unsigned idx)
+{
+    if (idx == CUR_INPUT_CHANNEL_IDX)
+    {
+        INFO(("Input channel /dev/video%u is already the current channel.", idx));
+
+        return false;
+    }
+
+    const auto existing = CONCURRENT_INPUT_CHANNELS.find(idx);
+
+    if (existing != CONCURRENT_INPUT_CHANNELS.end())
+    {
+        existing->second->isStandby = false;
+
+        return true;
+    }
+
+    if (!open_input_channel(idx, false))
+    {
+        NBENE(("Failed to start concurrent capture on input channel /dev/video%u.", idx));
+
+        return false;
+    }
+
+    INFO(("Capturing concurrently on input channel /dev/video%u.", idx));
+
+    return true;
+}
+
+bool kc_close_concurrent_input_channel(const unsigned idx)
+{
+    const auto concurrent = CONCURRENT_INPUT_CHANNELS.find(idx);
+
+    if ((concurrent == CONCURRENT_INPUT_CHANNELS.end()) ||
+        concurrent->second->isStandby)
+    {
+        return false;
+    }
+
+    close_input_channel(concurrent);
+
+    return true;
+}
+
+std::vector<unsigned> kc_get_concurrent_input_channels(void)
+{
+    std::vector<unsigned> indices;
+
+    for (const auto &concurrent: CONCURRENT_INPUT_CHANNELS)
+    {
+        if (!concurrent.second->isStandby)
+        {
+            indices.push_back(concurrent.first);
+        }
+    }
+
+    return indices;
+}
+
+bool kc_open_standby_input_channel(const unsigned idx)
+{
+    if (idx == CUR_INPUT_CHANNEL_IDX)
+    {
+        INFO(("Input channel /dev/video%u is already the current channel.", idx));
+
+        return false;
+    }
+
+    const auto existing = CONCURRENT_INPUT_CHANNELS.find(idx);
+
+    if (existing != CONCURRENT_INPUT_CHANNELS.end())
+    {
+        existing->second->isStandby = true;
+
+        return true;
+    }
+
+    if (!open_input_channel(idx, true))
+    {
+        NBENE(("Failed to put input channel /dev/video%u on standby.", idx));
+
+        return false;
+    }
+
+    INFO(("Input channel /dev/video%u is on standby.", idx));
+
+    return true;
+}
+
+bool kc_close_standby_input_channel(const unsigned idx)
+{
+    const auto standby = CONCURRENT_INPUT_CHANNELS.find(idx);
+
+    if ((standby == CONCURRENT_INPUT_CHANNELS.end()) ||
+        !standby->second->isStandby)
+    {
+        return false;
+    }
+
+    close_input_channel(standby);
+
+    return true;
+}
+
+std::vector<unsigned> kc_get_standby_input_channels(void)
+{
+    std::vector<unsigned> indices;
+
+    for (const auto &standby: CONCURRENT_INPUT_CHANNELS)
+    {
+        if (standby.second->isStandby)
+        {
+            indices.push_back(standby.first);
+        }
+    }
+
+    return indices;
+}
+
 bool kc_set_video_signal_parameters(const video_signal_parameters_s &p)
 {
     k_assert(CUR_INPUT_CHANNEL,
@@ -552,7 +1098,7 @@ bool kc_set_video_signal_parameters(const video_signal_parameters_s &p)
         return true;
     }
 
-    auto videoParams = CUR_INPUT_CHANNEL->captureStatus.videoParameters;
+    auto &videoParams = CUR_INPUT_CHANNEL->captureStatus.videoParameters;
 
     const auto kc_set_parameter = [&videoParams](const int value, const ic_v4l_device_controls_c::control_type_e parameterType)
     {
@@ -16,6 +16,7 @@
 #include "common/globals.h"
 #include "capture/capture.h"
 #include "capture/vision_v4l/ic_v4l_video_parameters.h"
+#include "capture/vision_v4l/v4l_device_io.h"
 
 #define INCLUDE_VISION
 #include <visionrgb/include/rgb133control.h>
@@ -29,17 +30,27 @@ ic_v4l_device_controls_c::ic_v4l_device_controls_c(const int v4lDeviceFileHandle
 
 bool ic_v4l_device_controls_c::set_value(const int newValue, const ic_v4l_device_controls_c::control_type_e control)
 {
+    if (this->isMetadataStale)
+    {
+        this->update();
+    }
+
     if (this->v4l_id(control) < 0)
     {
         DEBUG(("Asked to modify an unrecognized V4L control; ignoring this."));
         return false;
     }
 
+    if (this->value(control) == newValue)
+    {
+        return true;
+    }
+
     v4l2_control v4lc = {};
     v4lc.id = this->v4l_id(control);
     v4lc.value = newValue;
 
-    if (ioctl(this->v4lDeviceFileHandle, VIDIOC_S_CTRL, &v4lc) != 0)
+    if (v4l_ioctl(this->v4lDeviceFileHandle, VIDIOC_S_CTRL, &v4lc) != 0)
     {
         if (kc_is_receiving_signal())
         {
@@ -49,6 +60,8 @@ bool ic_v4l_device_controls_c::set_value(const int newValue, const ic_v4l_device
         return false;
     }
 
+    this->controls.at(control).currentValue = newValue;
+
     return true;
 }
 
@@ -124,7 +137,27 @@ std::string ic_v4l_device_controls_c::name(const ic_v4l_device_controls_c::contr
     }
 }
 
-void ic_v4l_device_controls_c::update()
+void ic_v4l_device_controls_c::update(void)
+{
+    if (this->isMetadataStale)
+    {
+        this->enumerate_controls();
+        this->isMetadataStale = false;
+    }
+
+    this->refresh_values();
+
+    return;
+}
+
+void ic_v4l_device_controls_c::invalidate(void)
+{
+    this->isMetadataStale = true;
+
+    return;
+}
+
+void ic_v4l_device_controls_c::enumerate_controls(void)
 {
     this->controls.clear();
 
@@ -135,7 +168,7 @@ void ic_v4l_device_controls_c::update()
             v4l2_queryctrl query = {};
             query.id = i;
 
-            if (ioctl(this->v4lDeviceFileHandle, VIDIOC_QUERYCTRL, &query) == 0)
+            if (v4l_ioctl(this->v4lDeviceFileHandle, VIDIOC_QUERYCTRL, &query) == 0)
             {
                 if (!(query.flags & V4L2_CTRL_FLAG_DISABLED) &&
                     !(query.flags & V4L2_CTRL_FLAG_READ_ONLY) &&
@@ -152,20 +185,7 @@ void ic_v4l_device_controls_c::update()
                     parameter.defaultValue = query.default_value;
                     parameter.stepSize = query.step;
 
-                    // Attempt to get the control's current value.
-                    {
-                        v4l2_control v4lc = {};
-                        v4lc.id = i;
-
-                        if (ioctl(this->v4lDeviceFileHandle, VIDIOC_G_CTRL, &v4lc) == 0)
-                        {
-                            parameter.currentValue = v4lc.value;
-                        }
-                        else
-                        {
-                            parameter.currentValue = 0;
-                        }
-                    }
+                    parameter.currentValue = 0;
 
                     // Standardize the control names.
                     for (auto &chr: parameter.name)
@@ -185,6 +205,58 @@ void ic_v4l_device_controls_c::update()
     return;
 }
 
+void ic_v4l_device_controls_c::refresh_values(void)
+{
+    if (this->controls.empty())
+    {
+        return;
+    }
+
+    if (this->isExtCtrlsSupported)
+    {
+        std::vector<v4l2_ext_control> values;
+
+        for (const auto &control: this->controls)
+        {
+            v4l2_ext_control value = {};
+            value.id = unsigned(control.second.v4lId);
+            values.push_back(value);
+        }
+
+        v4l2_ext_controls query = {};
+        query.which = V4L2_CTRL_WHICH_CUR_VAL;
+        query.count = unsigned(values.size());
+        query.controls = values.data();
+
+        if (v4l_ioctl(this->v4lDeviceFileHandle, VIDIOC_G_EXT_CTRLS, &query) == 0)
+        {
+            unsigned i = 0;
+
+            for (auto &control: this->controls)
+            {
+                control.second.currentValue = values.at(i++).value;
+            }
+
+            return;
+        }
+
+        // E.g. older drivers' private controls can't be accessed in batches.
+        DEBUG(("The capture device doesn't support VIDIOC_G_EXT_CTRLS (error %d). Querying controls one by one instead.", errno));
+
+        this->isExtCtrlsSupported = false;
+    }
+
+    for (auto &control: this->controls)
+    {
+        v4l2_control v4lc = {};
+        v4lc.id = unsigned(control.second.v4lId);
+
+        control.second.currentValue = ((v4l_ioctl(this->v4lDeviceFileHandle, VIDIOC_G_CTRL, &v4lc) == 0)? v4lc.value : 0);
+    }
+
+    return;
+}
+
 ic_v4l_device_controls_c::control_type_e ic_v4l_device_controls_c::type_for_name(const std::string &name)
 {
     if (name == "horizontal_size")     return control_type_e::horizontal_size;
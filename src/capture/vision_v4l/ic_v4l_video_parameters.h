@@ -13,6 +13,7 @@
 #define VCS_CAPTURE_IC_V4L_VIDEO_PARAMETERS_H
 
 #include <string>
+#include <vector>
 #include <unordered_map>
 
 class ic_v4l_device_controls_c
@@ -43,7 +44,8 @@ public:
     };
 
     // Ask the capture device to change the given parameters's value. Returns true
-    // on success; false otherwise.
+    // on success; false otherwise. Doesn't involve the capture device if the
+    // parameter already has the given value.
     bool set_value(const int newValue, const control_type_e controlType);
 
     int value(const control_type_e control) const;
@@ -58,12 +60,25 @@ public:
 
     std::string name(const control_type_e control) const;
 
-    // Polls the capture device for the current video parameters' values.
+    // Polls the capture device for the current video parameters' values, in a
+    // single batch. If the parameters' metadata (which parameters there are,
+    // their ranges and defaults) has been invalidated, re-enumerates it first.
     void update(void);
 
+    // Marks the parameters' metadata as stale, e.g. because the video mode has
+    // changed; it'll be re-enumerated on the next call to update().
+    void invalidate(void);
+
 private:
     control_type_e type_for_name(const std::string &name);
 
+    // Queries the capture device for its controls and their metadata, replacing
+    // the existing ones.
+    void enumerate_controls(void);
+
+    // Polls the capture device for the current values of the known controls.
+    void refresh_values(void);
+
     // Data mined from the v4l2_queryctrl struct.
     struct control_data_s
     {
@@ -80,6 +95,13 @@ private:
 
     std::unordered_map<control_type_e, control_data_s> controls;
 
+    // Whether the controls' metadata needs to be re-enumerated.
+    bool isMetadataStale = true;
+
+    // Whether the capture device can report the controls' values in a batch
+    // via VIDIOC_G_EXT_CTRLS, rather than one by one via VIDIOC_G_CTRL.
+    bool isExtCtrlsSupported = true;
+
     int v4lDeviceFileHandle = -1;
 };
 
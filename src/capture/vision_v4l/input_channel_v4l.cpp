@@ -13,31 +13,73 @@
 #include <unistd.h>
 #include <fcntl.h>
 #include <cstring>
+#include <algorithm>
+#include <string>
+#include <unordered_map>
 #include <linux/videodev2.h>
+#include <linux/dma-heap.h>
+#include <linux/dma-buf.h>
 #include "capture/vision_v4l/input_channel_v4l.h"
 #include "capture/vision_v4l/ic_v4l_video_parameters.h"
+#include "capture/vision_v4l/v4l_device_io.h"
+#include "capture/pixel_conversion.h"
+#include "capture/frame_hash.h"
+#include "capture/capture_thread.h"
 
 #define INCLUDE_VISION
 #include <visionrgb/include/rgb133control.h>
 #include <visionrgb/include/rgb133v4l2.h>
 
-// We'll persist the resolution and refresh rate, so that when a new video mode
-// is encountered, the code will first save the new mode values and then close
-// the old input channel, with the new input channel adopting the persisted values.
-static resolution_s LATEST_RESOLUTION = {1024, 768, 32};
-static refresh_rate_s LATEST_REFRESH_RATE = 0;
+// We'll persist each channel's resolution and refresh rate, so that when a new
+// video mode is encountered, the code will first save the new mode values and
+// then close the old input channel, with the new input channel adopting the
+// persisted values. Keyed by channel index. Channels capturing concurrently
+// access this from their respective capture threads.
+static std::unordered_map<unsigned, video_mode_s> LATEST_VIDEO_MODES;
+static std::mutex LATEST_VIDEO_MODES_MUTEX;
 
-input_channel_v4l_c::input_channel_v4l_c(const std::string v4lDeviceFileName,
+/// FIXME: We're only assuming this is the correct ID for the "signal_type" control.
+static const unsigned V4L_SIGNAL_TYPE_CONTROL_ID = 0x8000013;
+
+/// FIXME: We're only assuming this value of the "signal_type" control means "no signal".
+static const int V4L_NO_SIGNAL_CONTROL_VALUE = 0;
+
+input_channel_v4l_c::input_channel_v4l_c(const unsigned channelIdx,
                                          const unsigned numBackBuffers,
-                                         captured_frame_s *const dstFrameBuffer) :
-    v4lDeviceFileName(v4lDeviceFileName),
-    dstFrameBuffer(dstFrameBuffer),
+                                         captured_frame_ring_c *const dstFrameRing,
+                                         const bool zeroCopy,
+                                         const bool convertOnCapture,
+                                         const bool drainToNewest,
+                                         const capture_memory_e preferredMemoryType,
+                                         const capture_region_s &captureRegion,
+                                         const resolution_s &scaledResolution) :
+    preferredMemoryType(preferredMemoryType),
+    isZeroCopy(zeroCopy),
+    isConvertOnCapture(convertOnCapture),
+    isDrainToNewest(drainToNewest),
+    channelIdx(channelIdx),
+    v4lDeviceFileName(std::string("/dev/video") + std::to_string(channelIdx)),
+    dstFrameRing(dstFrameRing),
     requestedNumBackBuffers(numBackBuffers)
 {
     DEBUG(("Opening %s.", this->v4lDeviceFileName.c_str()));
 
-    this->captureStatus.refreshRate = LATEST_REFRESH_RATE;
-    this->captureStatus.resolution = LATEST_RESOLUTION;
+    this->captureRegion = this->requestedCaptureRegion = captureRegion;
+    this->scaledResolution = this->requestedScaledResolution = scaledResolution;
+
+    {
+        std::lock_guard<std::mutex> lock(LATEST_VIDEO_MODES_MUTEX);
+
+        const auto latestMode = LATEST_VIDEO_MODES.find(this->channelIdx);
+
+        this->latestVideoMode = ((latestMode == LATEST_VIDEO_MODES.end())? video_mode_s{{1024, 768, 32}, refresh_rate_s(0)}
+                                                                          : latestMode->second);
+    }
+
+    this->captureStatus.refreshRate = this->latestVideoMode.refreshRate;
+    this->captureStatus.sourceResolution = this->latestVideoMode.resolution;
+    this->captureStatus.resolution = this->latestVideoMode.resolution;
+    this->captureStatus.frameResolution = this->latestVideoMode.resolution;
 
     this->start_capturing();
 
@@ -56,35 +98,16 @@ input_channel_v4l_c::~input_channel_v4l_c()
     return;
 }
 
-void input_channel_v4l_c::push_capture_event(capture_event_e flag)
+void input_channel_v4l_c::push_capture_event(capture_event_e event)
 {
-    const unsigned flagIdx = static_cast<unsigned>(flag);
-
-    k_assert((flagIdx < this->captureEventFlags.size()), "Overflowing the capture event flag buffer.");
-
-    this->captureEventFlags[flagIdx] = 1;
+    kc_push_capture_event(event, 0, int(this->channelIdx));
 
     return;
 }
 
-bool input_channel_v4l_c::pop_capture_event(const capture_event_e flag)
+bool input_channel_v4l_c::is_capturing(void) const
 {
-    const unsigned flagIdx = static_cast<unsigned>(flag);
-
-    k_assert((flagIdx < this->captureEventFlags.size()), "Overflowing the capture event flag buffer.");
-
-    const bool value = this->captureEventFlags[flagIdx];
-    this->captureEventFlags[flagIdx] = 0;
-
-    if ((flag == capture_event_e::sleep) &&
-        !this->run)
-    {
-        return true;
-    }
-    else
-    {
-        return value;
-    }
+    return this->run;
 }
 
 resolution_s input_channel_v4l_c::maximum_resolution(void) const
@@ -114,30 +137,97 @@ resolution_s input_channel_v4l_c::source_resolution(void)
 
 bool input_channel_v4l_c::capture_thread__has_signal(void)
 {
-    /// FIXME: We're only assuming this is the correct ID for the "signal_type" control.
-    static const unsigned v4lSignalTypeControlId = 0x8000013;
+    v4l2_control v4lc = {};
+    v4lc.id = V4L_SIGNAL_TYPE_CONTROL_ID;
 
-    /// FIXME: We're only assuming this value of the "signal_type" control means "no signal".
-    static const unsigned noSignalControlValue = 0;
+    if (v4l_ioctl(this->v4lDeviceFileHandle, VIDIOC_G_CTRL, &v4lc) == 0)
+    {
+        this->capture_thread__update_signal_status(v4lc.value);
+    }
 
-    v4l2_control v4lc = {};
-    v4lc.id = v4lSignalTypeControlId;
+    return !this->captureStatus.noSignal;
+}
+
+void input_channel_v4l_c::capture_thread__update_signal_status(const int signalTypeControlValue)
+{
+    const bool hasNoSignal = (signalTypeControlValue == V4L_NO_SIGNAL_CONTROL_VALUE);
+    const bool hasStatusChanged = (hasNoSignal != this->captureStatus.noSignal);
+
+    this->captureStatus.noSignal = hasNoSignal;
 
-    if (ioctl(this->v4lDeviceFileHandle, VIDIOC_G_CTRL, &v4lc) == 0)
+    if (hasStatusChanged)
     {
-        const bool hasNoSignal = (v4lc.value == noSignalControlValue);
-        const bool hasStatusChanged = (hasNoSignal != this->captureStatus.noSignal);
+        std::lock_guard<std::mutex> lock(kc_capture_mutex());
+        this->push_capture_event(hasNoSignal? capture_event_e::signal_lost : capture_event_e::signal_gained);
+    }
+
+    return;
+}
 
-        this->captureStatus.noSignal = (v4lc.value == noSignalControlValue);
+void input_channel_v4l_c::capture_thread__handle_device_events(void)
+{
+    v4l2_event event = {};
 
-        if (hasStatusChanged)
+    // Note: DQEVENT fails with ENOENT once there are no more events pending.
+    while (v4l_ioctl(this->v4lDeviceFileHandle, VIDIOC_DQEVENT, &event) == 0)
+    {
+        switch (event.type)
         {
-            std::lock_guard<std::mutex> lock(kc_capture_mutex());
-            this->push_capture_event(hasNoSignal? capture_event_e::signal_lost : capture_event_e::signal_gained);
+            case V4L2_EVENT_SOURCE_CHANGE:
+            {
+                if (event.u.src_change.changes & V4L2_EVENT_SRC_CH_RESOLUTION)
+                {
+                    this->isSourceCheckPending = true;
+                }
+
+                break;
+            }
+            case V4L2_EVENT_CTRL:
+            {
+                if ((event.id == V4L_SIGNAL_TYPE_CONTROL_ID) &&
+                    (event.u.ctrl.changes & V4L2_EVENT_CTRL_CH_VALUE))
+                {
+                    this->capture_thread__update_signal_status(event.u.ctrl.value);
+
+                    // A newly-acquired signal may be in a different video mode
+                    // than the one we lost.
+                    this->isSourceCheckPending = true;
+                }
+
+                break;
+            }
+            default: break;
         }
     }
 
-    return !this->captureStatus.noSignal;
+    return;
+}
+
+void input_channel_v4l_c::subscribe_to_device_events(void)
+{
+    v4l2_event_subscription subscription = {};
+
+    subscription.type = V4L2_EVENT_SOURCE_CHANGE;
+    this->isSourceChangeEventSubscribed = (v4l_ioctl(this->v4lDeviceFileHandle, VIDIOC_SUBSCRIBE_EVENT, &subscription) == 0);
+
+    subscription = {};
+    subscription.type = V4L2_EVENT_CTRL;
+    subscription.id = V4L_SIGNAL_TYPE_CONTROL_ID;
+    this->isSignalEventSubscribed = (v4l_ioctl(this->v4lDeviceFileHandle, VIDIOC_SUBSCRIBE_EVENT, &subscription) == 0);
+
+    if (!this->isSourceChangeEventSubscribed)
+    {
+        DEBUG(("%s doesn't report source changes as events. Polling for them instead.",
+               this->v4lDeviceFileName.c_str()));
+    }
+
+    if (!this->isSignalEventSubscribed)
+    {
+        DEBUG(("%s doesn't report signal changes as events. Polling for them instead.",
+               this->v4lDeviceFileName.c_str()));
+    }
+
+    return;
 }
 
 bool input_channel_v4l_c::capture_thread__has_source_mode_changed(void)
@@ -145,7 +235,7 @@ bool input_channel_v4l_c::capture_thread__has_source_mode_changed(void)
     v4l2_format format = {0};
     format.type = V4L2_BUF_TYPE_CAPTURE_SOURCE;
 
-    if (ioctl(this->v4lDeviceFileHandle, RGB133_VIDIOC_G_SRC_FMT, &format) >= 0)
+    if (v4l_ioctl(this->v4lDeviceFileHandle, RGB133_VIDIOC_G_SRC_FMT, &format) >= 0)
     {
         if (!input_channel_v4l_c::is_format_of_valid_signal(&format))
         {
@@ -165,13 +255,21 @@ bool input_channel_v4l_c::capture_thread__has_source_mode_changed(void)
         {
             const refresh_rate_s currentRefreshRate = refresh_rate_s(format.fmt.pix.priv / 1000.0);
 
-            if ((currentRefreshRate != LATEST_REFRESH_RATE) ||
-                (format.fmt.pix.width != LATEST_RESOLUTION.w) ||
-                (format.fmt.pix.height != LATEST_RESOLUTION.h))
+            if ((currentRefreshRate != this->latestVideoMode.refreshRate) ||
+                (format.fmt.pix.width != this->latestVideoMode.resolution.w) ||
+                (format.fmt.pix.height != this->latestVideoMode.resolution.h))
             {
-                this->captureStatus.refreshRate = LATEST_REFRESH_RATE = currentRefreshRate;
-                this->captureStatus.resolution = LATEST_RESOLUTION = {format.fmt.pix.width, format.fmt.pix.height, 32};
-                return false;
+                this->latestVideoMode = {{format.fmt.pix.width, format.fmt.pix.height, 32}, currentRefreshRate};
+
+                this->captureStatus.refreshRate = this->latestVideoMode.refreshRate;
+                this->captureStatus.sourceResolution = this->latestVideoMode.resolution;
+
+                {
+                    std::lock_guard<std::mutex> lock(LATEST_VIDEO_MODES_MUTEX);
+                    LATEST_VIDEO_MODES[this->channelIdx] = this->latestVideoMode;
+                }
+
+                return true;
             }
         }
     }
@@ -193,26 +291,45 @@ bool input_channel_v4l_c::capture_thread__has_source_mode_changed(void)
 // was no new frame to get).
 bool input_channel_v4l_c::capture_thread__get_next_frame(void)
 {
+    // Without a usable signal, we only wait for device events (e.g. that the
+    // signal has been regained), or for the next fallback status poll.
+    const bool isWaitingForSignal = (this->captureStatus.noSignal || this->captureStatus.invalidSignal);
+
     pollfd fd;
     memset(&fd, 0, sizeof(fd));
     fd.fd = this->v4lDeviceFileHandle;
-    fd.events = (POLLIN | POLLPRI);
+    fd.events = (isWaitingForSignal? POLLPRI : (POLLIN | POLLPRI));
+
+    const int pollResult = v4l_poll(&fd, 1, (isWaitingForSignal? int(statusPollIntervalMs) : 1000));
+    const auto pollReturnTime = std::chrono::steady_clock::now();
 
-    const int pollResult = poll(&fd, 1, 1000);
+    // The buffer sequence may jump across a loss of signal without the device
+    // having dropped any frames.
+    if (isWaitingForSignal)
+    {
+        this->isLatestSequenceValid = false;
+        this->isPrevFrameHashValid = false;
+        this->isNextFrameDueTimeValid = false;
+    }
 
-    // Received a new frame.
     if (pollResult > 0)
     {
-        if (!(fd.revents & (POLLIN | POLLPRI)))
+        if (fd.revents & POLLPRI)
+        {
+            this->capture_thread__handle_device_events();
+        }
+
+        // Received a new frame.
+        if (!(fd.revents & POLLIN) ||
+            isWaitingForSignal)
         {
             return true;
         }
 
         v4l2_buffer buf = {0};
         buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
-        buf.memory = V4L2_MEMORY_MMAP;
+        buf.memory = input_channel_v4l_c::vcs_memory_type_to_v4l_memory_type(this->memoryType);
 
-        // Tell the capture device we want to access the frame buffer's data.
         if (!this->device_ioctl(VIDIOC_DQBUF, &buf))
         {
             switch (errno)
@@ -232,41 +349,267 @@ bool input_channel_v4l_c::capture_thread__get_next_frame(void)
             }
         }
 
-        // If the hardware is sending us a new frame while we're still unfinished
-        // processing the previous frame, we'll skip this new frame.
-        if (this->captureStatus.numFramesCaptured != this->captureStatus.numFramesProcessed)
+        // Tell the capture device we want to access the frame buffer's data. If
+        // we can't, we drop the frame rather than risk handing VCS pixels that
+        // the CPU doesn't yet see coherently.
+        if (!this->sync_back_buffer_for_cpu(buf.index, true))
         {
-            this->captureStatus.numNewFrameEventsSkipped++;
+            NBENE(("Failed to synchronize back buffer #%u for CPU access (error %d). Dropping the frame.",
+                   buf.index, errno));
+
+            this->capture_thread__track_buffer_sequence(buf.sequence);
+
+            if (!this->requeue_unsynced_back_buffer(buf.index))
+            {
+                std::lock_guard<std::mutex> lock(kc_capture_mutex());
+
+                this->push_capture_event(capture_event_e::unrecoverable_error);
+
+                return false;
+            }
+
+            return true;
         }
-        else
+
+        // If the device has completed more frames since this one, skip ahead to
+        // the newest of them, handing the older ones straight back to the device.
+        // Otherwise, having fallen behind, we'd keep passing VCS frames that have
+        // already been superseded.
+        if (this->isDrainToNewest)
         {
-            std::lock_guard<std::mutex> lock(kc_capture_mutex());
+            v4l2_buffer newerBuf = {0};
+            newerBuf.type = buf.type;
+            newerBuf.memory = buf.memory;
+
+            while (true)
+            {
+                // Note: We call v4l_ioctl() directly, as running out of completed
+                // buffers (EAGAIN) is the expected outcome and not worth logging.
+                if (v4l_ioctl(this->v4lDeviceFileHandle, VIDIOC_DQBUF, &newerBuf) != 0)
+                {
+                    if (errno == EAGAIN)
+                    {
+                        break;
+                    }
+
+                    NBENE(("Failed to dequeue a newer frame buffer (error %d).", errno));
+
+                    std::lock_guard<std::mutex> lock(kc_capture_mutex());
 
-            const input_channel_v4l_c::mmap_metadata &srcBuffer = this->mmapBackBuffers.at(buf.index);
+                    this->push_capture_event(capture_event_e::unrecoverable_error);
+
+                    return false;
+                }
+
+                // If we can't access the newer frame, we drop it and keep the
+                // one we have. Its sequence number is left untracked, so it
+                // counts as a missed frame.
+                if (!this->sync_back_buffer_for_cpu(newerBuf.index, true))
+                {
+                    NBENE(("Failed to synchronize back buffer #%u for CPU access (error %d). Dropping the frame.",
+                           newerBuf.index, errno));
+
+                    if (!this->requeue_unsynced_back_buffer(newerBuf.index))
+                    {
+                        std::lock_guard<std::mutex> lock(kc_capture_mutex());
+
+                        this->push_capture_event(capture_event_e::unrecoverable_error);
+
+                        return false;
+                    }
+                }
+                else
+                {
+                    this->capture_thread__track_buffer_sequence(buf.sequence);
+
+                    if (!this->requeue_back_buffer(buf.index))
+                    {
+                        std::lock_guard<std::mutex> lock(kc_capture_mutex());
+
+                        this->push_capture_event(capture_event_e::unrecoverable_error);
+
+                        return false;
+                    }
+
+                    this->captureStatus.numFramesDrained++;
+
+                    buf = newerBuf;
+                }
+
+                newerBuf = {0};
+                newerBuf.type = buf.type;
+                newerBuf.memory = buf.memory;
+            }
+        }
+
+        this->capture_thread__track_buffer_sequence(buf.sequence);
+
+        // If we're capping the frame rate and this frame isn't due yet, hand it
+        // straight back to the device without touching its pixels.
+        if (!this->capture_thread__is_frame_due(input_channel_v4l_c::buffer_timestamp(buf)))
+        {
+            if (!this->requeue_back_buffer(buf.index))
+            {
+                std::lock_guard<std::mutex> lock(kc_capture_mutex());
 
-            this->dstFrameBuffer->r = LATEST_RESOLUTION;
-            this->dstFrameBuffer->r.bpp = ((this->captureStatus.pixelFormat == capture_pixel_format_e::rgb_888)? 32 : 16);
-            this->dstFrameBuffer->pixelFormat = this->captureStatus.pixelFormat;
+                this->push_capture_event(capture_event_e::unrecoverable_error);
 
-            // Copy the frame's data into our local buffer so we can work on it.
-            memcpy(this->dstFrameBuffer->pixels.data(),
-                   srcBuffer.ptr,
-                   this->dstFrameBuffer->pixels.size_check(srcBuffer.length));
+                return false;
+            }
 
-            this->captureStatus.numFramesCaptured++;
-            this->push_capture_event(capture_event_e::new_frame);
+            return true;
         }
 
-        // Tell the capture device that we've finished accessing the buffer.
-        if (!this->device_ioctl(VIDIOC_QBUF, &buf))
+        // Compare the frame's pixels against those of the previous frame, so
+        // that VCS needn't process the frame again if it hasn't changed.
+        bool isDuplicate = false;
+        const duplicate_frame_handling_e duplicateHandling = kc_get_duplicate_frame_handling();
+
+        if (duplicateHandling != duplicate_frame_handling_e::none)
         {
-            std::lock_guard<std::mutex> lock(kc_capture_mutex());
+            const input_channel_v4l_c::back_buffer_metadata &srcBuffer = this->backBuffers.at(buf.index);
+            const unsigned bytesPerPixel = ((this->captureStatus.pixelFormat == capture_pixel_format_e::rgb_888)? 4 : 2);
+            const unsigned frameSize = (this->captureStatus.frameResolution.w * this->captureStatus.frameResolution.h * bytesPerPixel);
+            const u64 hash = kc_hash_frame_pixels(srcBuffer.ptr, std::min(frameSize, srcBuffer.length));
+
+            isDuplicate = (this->isPrevFrameHashValid && (hash == this->prevFrameHash));
+            this->prevFrameHash = hash;
+            this->isPrevFrameHashValid = true;
+
+            if (isDuplicate &&
+                (duplicateHandling == duplicate_frame_handling_e::drop))
+            {
+                if (!this->requeue_back_buffer(buf.index))
+                {
+                    std::lock_guard<std::mutex> lock(kc_capture_mutex());
+
+                    this->push_capture_event(capture_event_e::unrecoverable_error);
+
+                    return false;
+                }
+
+                return true;
+            }
+        }
+
+        // Hand the frame over to VCS via the frame queue. If VCS is still busy
+        // with previous frames such that the queue is full, the queue's overflow
+        // policy decides which frame gets skipped.
+        if (this->isZeroCopy)
+        {
+            captured_frame_s &frame = this->backBufferFrames.at(buf.index);
+            const captured_frame_s *replacedFrame = nullptr;
+
+            frame.r = this->captureStatus.frameResolution;
+            frame.r.bpp = ((this->captureStatus.pixelFormat == capture_pixel_format_e::rgb_888)? 32 : 16);
+            frame.pixelFormat = this->captureStatus.pixelFormat;
+            frame.timestamp = input_channel_v4l_c::buffer_timestamp(buf);
+            frame.sequence = buf.sequence;
+            frame.channel = this->channelIdx;
+            frame.isDuplicate = isDuplicate;
+            frame.processed = false;
+
+            // The back buffer stays with VCS until it releases the frame, unless
+            // the frame gets dropped, in which case we re-queue it right away.
+            if (!this->dstFrameRing->push_view(&frame, &replacedFrame))
+            {
+                this->captureStatus.numNewFrameEventsSkipped++;
+                replacedFrame = &frame;
+            }
+            else
+            {
+                this->captureStatus.numFramesCaptured++;
+                kc_signal_capture_event();
+                kc_report_capture_scheduling_latency(pollReturnTime);
+
+                if (replacedFrame)
+                {
+                    this->captureStatus.numNewFrameEventsSkipped++;
+                }
+            }
+
+            if (replacedFrame &&
+                !this->release_frame(replacedFrame))
+            {
+                std::lock_guard<std::mutex> lock(kc_capture_mutex());
+
+                this->push_capture_event(capture_event_e::unrecoverable_error);
+
+                return false;
+            }
+        }
+        else
+        {
+            const unsigned numDroppedPreviously = this->dstFrameRing->num_dropped();
+            captured_frame_s *const dstFrame = this->dstFrameRing->begin_write();
+
+            // The queue counts both the frames it refuses and those it overwrites.
+            this->captureStatus.numNewFrameEventsSkipped += (this->dstFrameRing->num_dropped() - numDroppedPreviously);
 
-            this->push_capture_event(capture_event_e::unrecoverable_error);
+            if (dstFrame)
+            {
+                const input_channel_v4l_c::back_buffer_metadata &srcBuffer = this->backBuffers.at(buf.index);
+
+                dstFrame->r = this->captureStatus.frameResolution;
+                dstFrame->r.bpp = ((this->captureStatus.pixelFormat == capture_pixel_format_e::rgb_888)? 32 : 16);
+                dstFrame->pixelFormat = this->captureStatus.pixelFormat;
+                dstFrame->timestamp = input_channel_v4l_c::buffer_timestamp(buf);
+                dstFrame->sequence = buf.sequence;
+                dstFrame->channel = this->channelIdx;
+                dstFrame->isDuplicate = isDuplicate;
+                dstFrame->processed = false;
+
+                // Convert the frame into BGRA as we copy it, so VCS won't need
+                // to make another pass over it.
+                if (this->isConvertOnCapture &&
+                    kc_is_pixel_conversion_supported(dstFrame->pixelFormat))
+                {
+                    const unsigned numPixels = (dstFrame->r.w * dstFrame->r.h);
+
+                    k_assert(((numPixels * (dstFrame->r.bpp / 8)) <= srcBuffer.length),
+                             "The capture back buffer is smaller than the captured frame.");
+
+                    kc_convert_pixels_to_bgra(dstFrame->pixels.data(),
+                                              srcBuffer.ptr,
+                                              dstFrame->pixels.size_check(numPixels * 4) / 4,
+                                              dstFrame->pixelFormat);
+
+                    dstFrame->r.bpp = 32;
+                    dstFrame->pixelFormat = capture_pixel_format_e::rgb_888;
+                }
+                else
+                {
+                    // Note: USERPTR and DMA-BUF buffers are padded to a whole number
+                    // of pages, so we copy only the bytes actually captured.
+                    memcpy(dstFrame->pixels.data(),
+                           srcBuffer.ptr,
+                           dstFrame->pixels.size_check(buf.bytesused? buf.bytesused : srcBuffer.length));
+                }
 
-            return false;
+                this->dstFrameRing->end_write();
+
+                this->captureStatus.numFramesCaptured++;
+                kc_signal_capture_event();
+                kc_report_capture_scheduling_latency(pollReturnTime);
+            }
+
+            // Tell the capture device that we've finished accessing the buffer.
+            if (!this->requeue_back_buffer(buf.index))
+            {
+                std::lock_guard<std::mutex> lock(kc_capture_mutex());
+
+                this->push_capture_event(capture_event_e::unrecoverable_error);
+
+                return false;
+            }
         }
     }
+    // Timed out waiting for the signal, which is expected.
+    else if ((pollResult == 0) &&
+             isWaitingForSignal)
+    {
+        return true;
+    }
     // A capture error.
     else
     {
@@ -280,6 +623,118 @@ bool input_channel_v4l_c::capture_thread__get_next_frame(void)
     return true;
 }
 
+bool input_channel_v4l_c::release_frame(const captured_frame_s *const frame)
+{
+    if (!this->isZeroCopy ||
+        this->backBufferFrames.empty() ||
+        (frame < &this->backBufferFrames.front()) ||
+        (frame > &this->backBufferFrames.back()))
+    {
+        return true;
+    }
+
+    const unsigned bufferIdx = unsigned(frame - &this->backBufferFrames.front());
+
+    if (!this->requeue_back_buffer(bufferIdx))
+    {
+        NBENE(("Failed to re-queue back buffer #%u.", (bufferIdx + 1)));
+        return false;
+    }
+
+    return true;
+}
+
+void input_channel_v4l_c::capture_thread__track_buffer_sequence(const u32 sequence)
+{
+    // Frames missing from the buffer sequence were dropped by the capture
+    // device, presumably for lack of a free back buffer to capture into.
+    if (this->isLatestSequenceValid &&
+        (sequence > (this->latestSequence + 1)))
+    {
+        this->numFramesStarved += (sequence - this->latestSequence - 1);
+    }
+
+    this->latestSequence = sequence;
+    this->isLatestSequenceValid = true;
+
+    return;
+}
+
+bool input_channel_v4l_c::capture_thread__is_frame_due(const std::chrono::steady_clock::time_point &timestamp)
+{
+    const double limitHz = kc_get_frame_rate_limit().value<double>();
+    const double sourceHz = this->captureStatus.refreshRate.value<double>();
+
+    if ((limitHz <= 0) ||
+        ((sourceHz > 0) && (limitHz >= sourceHz)))
+    {
+        this->isNextFrameDueTimeValid = false;
+        return true;
+    }
+
+    const auto interval = std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(1 / limitHz));
+
+    // Frames arrive at the source's frame interval, so the one closest to the
+    // due time may arrive up to half an interval early. Without this allowance,
+    // timestamp jitter would at times push the pick to the frame after.
+    const auto earliness = ((sourceHz > 0)? std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(0.5 / sourceHz))
+                                          : std::chrono::steady_clock::duration::zero());
+
+    // Start the schedule over, rather than trying to catch up, if we've gone
+    // a full interval past the due time (e.g. across a gap in the signal).
+    if (!this->isNextFrameDueTimeValid ||
+        (timestamp >= (this->nextFrameDueTime + interval)))
+    {
+        this->nextFrameDueTime = timestamp;
+        this->isNextFrameDueTimeValid = true;
+    }
+
+    if ((timestamp + earliness) < this->nextFrameDueTime)
+    {
+        return false;
+    }
+
+    // Scheduling from the due time rather than from the frame's timestamp keeps
+    // the average rate at the limit when it doesn't divide the source's rate.
+    this->nextFrameDueTime += interval;
+
+    return true;
+}
+
+bool input_channel_v4l_c::requeue_back_buffer(const unsigned bufferIdx)
+{
+    return (this->sync_back_buffer_for_cpu(bufferIdx, false) &&
+            this->requeue_unsynced_back_buffer(bufferIdx));
+}
+
+bool input_channel_v4l_c::requeue_unsynced_back_buffer(const unsigned bufferIdx)
+{
+    v4l2_buffer buf = {0};
+
+    buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    buf.memory = input_channel_v4l_c::vcs_memory_type_to_v4l_memory_type(this->memoryType);
+    buf.index = bufferIdx;
+
+    switch (this->memoryType)
+    {
+        case capture_memory_e::userptr:
+        {
+            buf.m.userptr = (unsigned long)this->backBuffers.at(bufferIdx).ptr;
+            buf.length = this->backBuffers.at(bufferIdx).length;
+            break;
+        }
+        case capture_memory_e::dmabuf:
+        {
+            buf.m.fd = this->backBuffers.at(bufferIdx).dmabufFd;
+            buf.length = this->backBuffers.at(bufferIdx).length;
+            break;
+        }
+        default: break;
+    }
+
+    return this->device_ioctl(VIDIOC_QBUF, &buf);
+}
+
 bool input_channel_v4l_c::device_ioctl(const unsigned long request, void *data)
 {
     if (this->v4lDeviceFileHandle < 0)
@@ -288,7 +743,7 @@ bool input_channel_v4l_c::device_ioctl(const unsigned long request, void *data)
         return false;
     }
 
-    const int retVal = ioctl(this->v4lDeviceFileHandle, request, data);
+    const int retVal = v4l_ioctl(this->v4lDeviceFileHandle, request, data);
 
     if (retVal < 0)
     {
@@ -304,7 +759,7 @@ bool input_channel_v4l_c::open_device(const std::string &deviceFileName)
     k_assert((this->v4lDeviceFileHandle < 0),
              "Attempting to re-open a capture device before having closed it.");
 
-    this->v4lDeviceFileHandle = open(deviceFileName.c_str(), (O_RDWR | O_NONBLOCK));
+    this->v4lDeviceFileHandle = v4l_open(deviceFileName.c_str(), (O_RDWR | O_NONBLOCK));
 
     if (this->v4lDeviceFileHandle < 0)
     {
@@ -324,7 +779,7 @@ bool input_channel_v4l_c::close_device(void)
         return true;
     }
 
-    if (close(this->v4lDeviceFileHandle) < 0)
+    if (v4l_close(this->v4lDeviceFileHandle) < 0)
     {
         return false;
     }
@@ -339,40 +794,242 @@ int input_channel_v4l_c::capture_thread(void)
     k_assert((this->v4lDeviceFileHandle >= 0),
              "Attempting to start the capture thread before the device has been opened.");
 
+    kc_tune_capture_thread();
+
+    // We learn of changes to the signal's status via device events, where the
+    // driver supports them, and otherwise by polling the device for its status
+    // every so often. Either way, we start by querying the initial status.
+    auto timeOfLastStatusPoll = std::chrono::steady_clock::now();
+    this->isSourceCheckPending = true;
+    this->isSignalCheckPending = true;
+
+    this->backBufferEvaluationStart = std::chrono::steady_clock::now();
+    this->timeOfLastStarvation = std::chrono::steady_clock::now();
+
     while (this->run)
     {
-        if (capture_thread__has_source_mode_changed())
+        if ((std::chrono::steady_clock::now() - timeOfLastStatusPoll) >= std::chrono::milliseconds(statusPollIntervalMs))
         {
-            if (!this->captureStatus.invalidSignal)
-            {
-                std::lock_guard<std::mutex> lock(kc_capture_mutex());
-
-                this->push_capture_event(capture_event_e::new_video_mode);
-
-                // The parent is expected to re-spawn this input channel, so we can exit the
-                // capture thread.
-                return 1;
-            }
-            else
-            {
-                continue;
-            }
+            timeOfLastStatusPoll = std::chrono::steady_clock::now();
+            this->isSourceCheckPending |= !this->isSourceChangeEventSubscribed;
+            this->isSignalCheckPending |= !this->isSignalEventSubscribed;
         }
 
-        if (!capture_thread__has_signal())
+        if (this->isSignalCheckPending)
         {
-            std::this_thread::sleep_for(std::chrono::milliseconds(100));
-            continue;
+            this->isSignalCheckPending = false;
+            this->capture_thread__has_signal();
         }
 
-        if (!capture_thread__get_next_frame())
+        // A change in the source's video mode, in the capture region or in the
+        // scaled resolution all result in a new capture video mode.
+        bool isNewVideoMode = false;
+
+        if (this->isSourceCheckPending &&
+            !this->captureStatus.noSignal)
         {
-            return 0;
+            this->isSourceCheckPending = false;
+
+            isNewVideoMode = (capture_thread__has_source_mode_changed() &&
+                              !this->captureStatus.invalidSignal);
         }
-    }
 
-    return 1;
-}
+        if (this->isCaptureRegionChangePending &&
+            !this->captureStatus.noSignal &&
+            !this->captureStatus.invalidSignal)
+        {
+            this->isCaptureRegionChangePending = false;
+
+            std::lock_guard<std::mutex> lock(this->requestedCaptureRegionMutex);
+
+            if (this->requestedCaptureRegion != this->captureRegion)
+            {
+                this->captureRegion = this->requestedCaptureRegion;
+                isNewVideoMode = true;
+            }
+        }
+
+        if (this->isScaledResolutionChangePending &&
+            !this->captureStatus.noSignal &&
+            !this->captureStatus.invalidSignal)
+        {
+            this->isScaledResolutionChangePending = false;
+
+            std::lock_guard<std::mutex> lock(this->requestedScaledResolutionMutex);
+
+            if ((this->requestedScaledResolution.w != this->scaledResolution.w) ||
+                (this->requestedScaledResolution.h != this->scaledResolution.h))
+            {
+                this->scaledResolution = this->requestedScaledResolution;
+                isNewVideoMode = this->isScalingSupported;
+            }
+        }
+
+        if (isNewVideoMode)
+        {
+            // Adapt to the new video mode in place, if we can. Otherwise, the
+            // parent is expected to re-spawn this input channel, so we can exit
+            // the capture thread.
+            if (this->isZeroCopy)
+            {
+                this->isRestartRequired = true;
+            }
+            else if (!this->capture_thread__reconfigure(this->latestVideoMode.resolution))
+            {
+                NBENE(("Failed to reconfigure %s for the new video mode. Re-opening the device instead.",
+                       this->v4lDeviceFileName.c_str()));
+
+                this->isRestartRequired = true;
+            }
+
+            // Report the new mode only once it's in effect, so that VCS sees the
+            // capture resolution the device settled on; or, if we're to be
+            // re-spawned, the one the re-spawned channel settles on.
+            {
+                std::lock_guard<std::mutex> lock(kc_capture_mutex());
+                this->push_capture_event(capture_event_e::new_video_mode);
+            }
+
+            if (this->isRestartRequired)
+            {
+                return 1;
+            }
+        }
+
+        if (!capture_thread__get_next_frame())
+        {
+            return 0;
+        }
+
+        if (!this->capture_thread__adapt_back_buffer_count())
+        {
+            NBENE(("Failed to adjust the number of back buffers on %s. Re-opening the device instead.",
+                   this->v4lDeviceFileName.c_str()));
+
+            this->isRestartRequired = true;
+
+            std::lock_guard<std::mutex> lock(kc_capture_mutex());
+            this->push_capture_event(capture_event_e::new_video_mode);
+
+            return 1;
+        }
+    }
+
+    return 1;
+}
+
+bool input_channel_v4l_c::capture_thread__adapt_back_buffer_count(void)
+{
+    // In zero-copy mode, VCS may be holding on to some of the back buffers, so
+    // we can't re-create them.
+    if (this->isZeroCopy ||
+        this->backBuffers.empty())
+    {
+        return true;
+    }
+
+    const auto timeNow = std::chrono::steady_clock::now();
+
+    if ((timeNow - this->backBufferEvaluationStart) < std::chrono::milliseconds(backBufferEvaluationIntervalMs))
+    {
+        return true;
+    }
+
+    const unsigned numStarved = this->numFramesStarved;
+    const unsigned curCount = unsigned(this->backBuffers.size());
+
+    this->numFramesStarved = 0;
+    this->backBufferEvaluationStart = timeNow;
+
+    if (this->captureStatus.noSignal ||
+        this->captureStatus.invalidSignal)
+    {
+        return true;
+    }
+
+    if (numStarved)
+    {
+        // We'd shrunk the buffers too far. Note that timeOfLastStarvation gets
+        // reset on shrinking.
+        if (this->wasLastAdjustmentShrink &&
+            ((timeNow - this->timeOfLastStarvation) < std::chrono::milliseconds(backBufferStableIntervalMs)))
+        {
+            this->backBufferFloor = std::min(maxNumBackBuffers, (curCount + 1));
+        }
+
+        this->timeOfLastStarvation = timeNow;
+
+        if ((curCount < maxNumBackBuffers) &&
+            !this->isBackBufferCountAtDeviceLimit)
+        {
+            return this->capture_thread__set_back_buffer_count((curCount + 1),
+                                                               ("The capture device dropped " + std::to_string(numStarved) +
+                                                                " frame(s) for lack of a free back buffer"));
+        }
+    }
+    else if (((timeNow - this->timeOfLastStarvation) >= std::chrono::milliseconds(backBufferStableIntervalMs)) &&
+             (curCount > this->backBufferFloor))
+    {
+        // Wait for another stable period before shrinking further.
+        this->timeOfLastStarvation = timeNow;
+
+        return this->capture_thread__set_back_buffer_count((curCount - 1),
+                                                           ("No frames dropped in " + std::to_string(backBufferStableIntervalMs / 1000) +
+                                                            " seconds"));
+    }
+
+    return true;
+}
+
+bool input_channel_v4l_c::capture_thread__set_back_buffer_count(const unsigned count, const std::string &reason)
+{
+    k_assert(!this->isZeroCopy, "Can't re-create the back buffers while in zero-copy mode.");
+
+    const unsigned oldCount = unsigned(this->backBuffers.size());
+
+    this->requestedNumBackBuffers = count;
+
+    if (!this->streamoff())
+    {
+        return false;
+    }
+
+    this->free_back_buffers();
+
+    if (!this->enqueue_back_buffers(this->captureStatus.sourceResolution) ||
+        !this->streamon())
+    {
+        return false;
+    }
+
+    const unsigned newCount = unsigned(this->backBuffers.size());
+
+    this->wasLastAdjustmentShrink = (newCount < oldCount);
+
+    INFO(("Adjusted the number of back buffers from %u to %u. %s.", oldCount, newCount, reason.c_str()));
+
+    {
+        std::lock_guard<std::mutex> lock(this->backBufferStatusMutex);
+
+        auto &history = this->backBufferStatus.history;
+
+        history.push_back({std::chrono::steady_clock::now(), oldCount, newCount, reason});
+
+        if (history.size() > maxBackBufferHistoryLength)
+        {
+            history.erase(history.begin());
+        }
+    }
+
+    return true;
+}
+
+back_buffer_status_s input_channel_v4l_c::back_buffer_status(void)
+{
+    std::lock_guard<std::mutex> lock(this->backBufferStatusMutex);
+
+    return this->backBufferStatus;
+}
 
 u32 input_channel_v4l_c::vcs_pixel_format_to_v4l_pixel_format(capture_pixel_format_e fmt) const
 {
@@ -385,9 +1042,95 @@ u32 input_channel_v4l_c::vcs_pixel_format_to_v4l_pixel_format(capture_pixel_form
     }
 }
 
-bool input_channel_v4l_c::set_v4l_buffer_resolution(const resolution_s &resolution)
+capture_region_s input_channel_v4l_c::effective_capture_region(const resolution_s &sourceResolution) const
+{
+    const capture_region_s fullFrame = {0, 0, sourceResolution.w, sourceResolution.h};
+
+    if (!this->isCropSupported ||
+        this->captureRegion.is_full_frame() ||
+        (this->captureRegion.x >= sourceResolution.w) ||
+        (this->captureRegion.y >= sourceResolution.h))
+    {
+        return fullFrame;
+    }
+
+    capture_region_s region = this->captureRegion;
+
+    region.w = std::min(region.w, (sourceResolution.w - region.x));
+    region.h = std::min(region.h, (sourceResolution.h - region.y));
+
+    // The region may have been meant for a larger signal than the current one.
+    if ((region.w < MIN_CAPTURE_WIDTH) ||
+        (region.h < MIN_CAPTURE_HEIGHT))
+    {
+        return fullFrame;
+    }
+
+    return region;
+}
+
+bool input_channel_v4l_c::set_v4l_buffer_resolution(const resolution_s &sourceResolution)
 {
     v4l2_format format = {0};
+    resolution_s frameResolution;
+    capture_region_s region = this->effective_capture_region(sourceResolution);
+    const bool isFullFrame = ((region.w == sourceResolution.w) &&
+                              (region.h == sourceResolution.h));
+
+    // Crop the capture to the capture region, so that the device transfers only
+    // the region's pixels. We also reset the crop when going back to capturing
+    // the full frame.
+    if (!isFullFrame ||
+        this->isCropApplied)
+    {
+        v4l2_selection selection = {};
+
+        selection.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        selection.target = V4L2_SEL_TGT_CROP;
+        selection.r.left = int(region.x);
+        selection.r.top = int(region.y);
+        selection.r.width = region.w;
+        selection.r.height = region.h;
+
+        // Note: We call v4l_ioctl() directly, as a device not supporting
+        // cropping is an expected outcome rather than an error.
+        if (v4l_ioctl(this->v4lDeviceFileHandle, VIDIOC_S_SELECTION, &selection) == 0)
+        {
+            this->isCropApplied = !isFullFrame;
+        }
+        else if ((errno == ENOTTY) ||
+                 (errno == EINVAL))
+        {
+            NBENE(("The capture device \"%s\" doesn't support capture regions (error %d). Capturing the full frame instead.",
+                   this->v4lDeviceFileName.c_str(), errno));
+
+            region = {0, 0, sourceResolution.w, sourceResolution.h};
+
+            this->isCropSupported = false;
+            this->isCropApplied = false;
+        }
+        else
+        {
+            NBENE(("Failed to set the capture region (error %d).", errno));
+            goto fail;
+        }
+    }
+
+    // A buffer size smaller than the crop rectangle has the device scale the
+    // captured frames down to it. We only downscale, and only if the device
+    // hasn't already turned out not to support it.
+    frameResolution = {region.w, region.h, 32};
+
+    if (this->isScalingSupported &&
+        this->scaledResolution.w &&
+        this->scaledResolution.h &&
+        (this->scaledResolution.w <= region.w) &&
+        (this->scaledResolution.h <= region.h) &&
+        (this->scaledResolution.w >= MIN_CAPTURE_WIDTH) &&
+        (this->scaledResolution.h >= MIN_CAPTURE_HEIGHT))
+    {
+        frameResolution = {this->scaledResolution.w, this->scaledResolution.h, 32};
+    }
 
     format.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
 
@@ -397,8 +1140,8 @@ bool input_channel_v4l_c::set_v4l_buffer_resolution(const resolution_s &resoluti
         goto fail;
     }
 
-    format.fmt.pix.width = resolution.w;
-    format.fmt.pix.height = resolution.h;
+    format.fmt.pix.width = frameResolution.w;
+    format.fmt.pix.height = frameResolution.h;
     format.fmt.pix.pixelformat = this->vcs_pixel_format_to_v4l_pixel_format(this->captureStatus.pixelFormat);
     format.fmt.pix.field = V4L2_FIELD_NONE;
 
@@ -409,72 +1152,309 @@ bool input_channel_v4l_c::set_v4l_buffer_resolution(const resolution_s &resoluti
         goto fail;
     }
 
-    if ((format.fmt.pix.width != resolution.w) ||
-        (format.fmt.pix.height != resolution.h) ||
+    // A device that can't scale will have adjusted the buffer size back to
+    // that of the crop rectangle (or to something else it can do). VCS will
+    // then scale the frames itself.
+    if (((frameResolution.w != region.w) || (frameResolution.h != region.h)) &&
+        ((format.fmt.pix.width != frameResolution.w) || (format.fmt.pix.height != frameResolution.h)))
+    {
+        NBENE(("The capture device \"%s\" doesn't support scaling its capture to %u x %u. Capturing at %lu x %lu instead.",
+               this->v4lDeviceFileName.c_str(), frameResolution.w, frameResolution.h, region.w, region.h));
+
+        this->isScalingSupported = false;
+
+        frameResolution = {region.w, region.h, 32};
+        format.fmt.pix.width = frameResolution.w;
+        format.fmt.pix.height = frameResolution.h;
+
+        if (!this->device_ioctl(VIDIOC_S_FMT, &format) ||
+            !this->device_ioctl(VIDIOC_G_FMT, &format))
+        {
+            NBENE(("Failed to set the capture resolution (error %d).", errno));
+            goto fail;
+        }
+    }
+
+    if ((format.fmt.pix.width != frameResolution.w) ||
+        (format.fmt.pix.height != frameResolution.h) ||
         (format.fmt.pix.pixelformat != this->vcs_pixel_format_to_v4l_pixel_format(this->captureStatus.pixelFormat)))
     {
         NBENE(("Failed to set the capture resolution (error %d).", errno));
         goto fail;
     }
 
+    // The device may have adjusted the crop rectangle to suit its hardware,
+    // either when it was set or when the buffer size was, so we report the
+    // rectangle it settled on.
+    if (this->isCropApplied)
+    {
+        v4l2_selection selection = {};
+
+        selection.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        selection.target = V4L2_SEL_TGT_CROP;
+
+        if (!this->device_ioctl(VIDIOC_G_SELECTION, &selection))
+        {
+            NBENE(("Failed to query the capture region (error %d).", errno));
+            goto fail;
+        }
+
+        region = {(unsigned long)selection.r.left, (unsigned long)selection.r.top, selection.r.width, selection.r.height};
+    }
+
+    this->captureStatus.sourceResolution = sourceResolution;
+    this->captureStatus.resolution = {region.w, region.h, 32};
+    this->captureStatus.frameResolution = frameResolution;
+
     return true;
 
     fail:
     return false;
 }
 
-bool input_channel_v4l_c::enqueue_mmap_back_buffers(const resolution_s &resolution)
+bool input_channel_v4l_c::enqueue_back_buffers(const resolution_s &resolution)
 {
-    v4l2_requestbuffers reqBuf = {0};
+    // In zero-copy mode, every slot in the frame queue may be holding on to a
+    // back buffer; and the capture device needs at least two more to keep
+    // capturing into while VCS processes the queued frames.
+    const unsigned numZeroCopyBackBuffers = (this->dstFrameRing->capacity() + 2);
+    const unsigned numBackBuffers = (this->isZeroCopy? std::max(this->requestedNumBackBuffers, numZeroCopyBackBuffers)
+                                                      : this->requestedNumBackBuffers);
+    unsigned frameSize = 0;
 
     if (!this->set_v4l_buffer_resolution(resolution))
     {
         goto fail;
     }
 
-    // Tell the capture device we want it to allocate the back buffers in its
-    // own memory and that we'll access them via mmap.
+    // Find out how large the back buffers need to be.
     {
-        reqBuf.count = this->requestedNumBackBuffers;
-        reqBuf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
-        reqBuf.memory = V4L2_MEMORY_MMAP;
+        v4l2_format format = {0};
+
+        format.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
 
-        if (!this->device_ioctl(VIDIOC_REQBUFS, &reqBuf))
+        if (!this->device_ioctl(VIDIOC_G_FMT, &format))
+        {
+            NBENE(("Failed to query the current capture format (error %d).", errno));
+            goto fail;
+        }
+
+        frameSize = format.fmt.pix.sizeimage;
+    }
+
+    // Try the memory types in order of preference. The capture device is
+    // expected to support at least MMAP, which is last in the list.
+    for (unsigned t = unsigned(this->preferredMemoryType); t <= unsigned(capture_memory_e::mmap); t++)
+    {
+        const capture_memory_e memoryType = capture_memory_e(t);
+
+        if (this->allocate_back_buffers(memoryType, numBackBuffers, frameSize))
+        {
+            break;
+        }
+
+        if (memoryType == capture_memory_e::mmap)
         {
             NBENE(("MMAP streaming couldn't be initialized (error %d).", errno));
             goto fail;
         }
     }
 
-    // Have the capture device allocate the back buffers in its own memory.
+    INFO(("Capturing into %u %s back buffers.",
+          unsigned(this->backBuffers.size()),
+          ((this->memoryType == capture_memory_e::dmabuf)? "DMA-BUF" :
+           (this->memoryType == capture_memory_e::userptr)? "USERPTR" : "MMAP")));
+
+    if (this->isZeroCopy &&
+        (this->backBuffers.size() < numZeroCopyBackBuffers))
+    {
+        INFO(("The capture device provided only %u of the %u back buffers needed for zero-copy "
+              "capture. Copying frames out of the back buffers instead.",
+              unsigned(this->backBuffers.size()), numZeroCopyBackBuffers));
+
+        this->isZeroCopy = false;
+    }
+
+    // If the device gave us fewer buffers than we asked for, there's no point
+    // in asking for more later.
+    this->isBackBufferCountAtDeviceLimit = (this->backBuffers.size() < numBackBuffers);
+
+    {
+        std::lock_guard<std::mutex> lock(this->backBufferStatusMutex);
+
+        this->backBufferStatus.count = unsigned(this->backBuffers.size());
+        this->backBufferStatus.isAdaptive = !this->isZeroCopy;
+    }
+
+    if (this->isZeroCopy)
+    {
+        this->backBufferFrames.resize(this->backBuffers.size());
+
+        for (unsigned i = 0; i < this->backBuffers.size(); i++)
+        {
+            this->backBufferFrames[i].pixels.point_to(this->backBuffers[i].ptr,
+                                                      this->backBuffers[i].length);
+        }
+
+        DEBUG(("Zero-copy capture enabled with %u back buffers.", unsigned(this->backBuffers.size())));
+    }
+
+    return true;
+
+    fail:
+    return false;
+}
+
+bool input_channel_v4l_c::allocate_back_buffers(const capture_memory_e memoryType,
+                                                const unsigned count,
+                                                const unsigned minLength)
+{
+    k_assert(this->backBuffers.empty(), "Attempting to doubly allocate the back buffers.");
+
+    // MMAP buffers are allocated by the capture device, which tells us their
+    // size; for the others, we'll round the size up to a whole number of pages.
+    const unsigned pageSize = unsigned(sysconf(_SC_PAGESIZE));
+    const unsigned length = (((minLength + pageSize - 1) / pageSize) * pageSize);
+
+    v4l2_requestbuffers reqBuf = {0};
+
+    reqBuf.count = count;
+    reqBuf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    reqBuf.memory = input_channel_v4l_c::vcs_memory_type_to_v4l_memory_type(memoryType);
+
+    // The capture device may refuse the memory type, or may accept it but
+    // provide no buffers.
+    if ((v4l_ioctl(this->v4lDeviceFileHandle, VIDIOC_REQBUFS, &reqBuf) < 0) ||
+        !reqBuf.count)
+    {
+        DEBUG(("The capture device doesn't support memory type #%u (error %d).", reqBuf.memory, errno));
+        return false;
+    }
+
+    this->memoryType = memoryType;
+
     for (uint32_t i = 0; i < reqBuf.count; i++)
     {
         v4l2_buffer buffer = {0};
-        input_channel_v4l_c::mmap_metadata bufferMetadata = {0};
+        input_channel_v4l_c::back_buffer_metadata bufferMetadata = {nullptr, 0, -1};
 
         buffer.type = reqBuf.type;
-        buffer.memory = V4L2_MEMORY_MMAP;
+        buffer.memory = reqBuf.memory;
         buffer.index = i;
 
-        if (!this->device_ioctl(VIDIOC_QUERYBUF, &buffer))
+        switch (memoryType)
         {
-            NBENE(("Failed to allocate back buffers on the capture device (error %d).", errno));
-            goto fail;
-        }
+            // Have the capture device allocate the back buffer in its own memory,
+            // and map it into ours.
+            case capture_memory_e::mmap:
+            {
+                if (!this->device_ioctl(VIDIOC_QUERYBUF, &buffer))
+                {
+                    NBENE(("Failed to allocate back buffers on the capture device (error %d).", errno));
+                    goto fail;
+                }
 
-        const void *mmapPtr = mmap(NULL,
-                                   buffer.length,
-                                   (PROT_READ | PROT_WRITE),
-                                   MAP_SHARED,
-                                   this->v4lDeviceFileHandle,
-                                   buffer.m.offset);
+                void *const mmapPtr = v4l_mmap(NULL,
+                                               buffer.length,
+                                               (PROT_READ | PROT_WRITE),
+                                               MAP_SHARED,
+                                               this->v4lDeviceFileHandle,
+                                               buffer.m.offset);
 
-        if (mmapPtr == MAP_FAILED)
-        {
-            NBENE(("Failed to allocate back buffers on the capture device (mmap() returned MAP_FAILED)."));
-            goto fail;
+                if (mmapPtr == MAP_FAILED)
+                {
+                    NBENE(("Failed to allocate back buffers on the capture device (mmap() returned MAP_FAILED)."));
+                    goto fail;
+                }
+
+                bufferMetadata.ptr = (uint8_t*)mmapPtr;
+                bufferMetadata.length = buffer.length;
+
+                break;
+            }
+            // Allocate the back buffer in our own memory, page-aligned so the
+            // capture device can DMA into it.
+            case capture_memory_e::userptr:
+            {
+                void *const mmapPtr = mmap(NULL,
+                                           length,
+                                           (PROT_READ | PROT_WRITE),
+                                           (MAP_PRIVATE | MAP_ANONYMOUS),
+                                           -1,
+                                           0);
+
+                if (mmapPtr == MAP_FAILED)
+                {
+                    NBENE(("Failed to allocate USERPTR back buffers (mmap() returned MAP_FAILED)."));
+                    goto fail;
+                }
+
+                bufferMetadata.ptr = (uint8_t*)mmapPtr;
+                bufferMetadata.length = length;
+
+                buffer.m.userptr = (unsigned long)mmapPtr;
+                buffer.length = length;
+
+                break;
+            }
+            // Allocate the back buffer from the system's DMA-BUF heap, and map
+            // it into our memory.
+            case capture_memory_e::dmabuf:
+            {
+                const int heapFd = open("/dev/dma_heap/system", (O_RDONLY | O_CLOEXEC));
+
+                if (heapFd < 0)
+                {
+                    DEBUG(("No DMA-BUF heap available for the back buffers."));
+                    goto fail;
+                }
+
+                dma_heap_allocation_data allocation = {0};
+                allocation.len = length;
+                allocation.fd_flags = (O_RDWR | O_CLOEXEC);
+
+                const int allocResult = ioctl(heapFd, DMA_HEAP_IOCTL_ALLOC, &allocation);
+
+                close(heapFd);
+
+                if (allocResult < 0)
+                {
+                    DEBUG(("Failed to allocate DMA-BUF back buffers (error %d).", errno));
+                    goto fail;
+                }
+
+                bufferMetadata.dmabufFd = int(allocation.fd);
+                bufferMetadata.length = length;
+
+                void *const mmapPtr = mmap(NULL,
+                                           length,
+                                           (PROT_READ | PROT_WRITE),
+                                           MAP_SHARED,
+                                           bufferMetadata.dmabufFd,
+                                           0);
+
+                if (mmapPtr == MAP_FAILED)
+                {
+                    close(bufferMetadata.dmabufFd);
+                    DEBUG(("Failed to map DMA-BUF back buffers (mmap() returned MAP_FAILED)."));
+                    goto fail;
+                }
+
+                bufferMetadata.ptr = (uint8_t*)mmapPtr;
+
+                buffer.m.fd = bufferMetadata.dmabufFd;
+                buffer.length = length;
+
+                break;
+            }
         }
 
+        this->backBuffers.push_back(bufferMetadata);
+
+        // Locked memory gets unlocked when it's unmapped, so we needn't unlock
+        // the buffers when freeing them.
+        kc_lock_capture_memory(bufferMetadata.ptr, bufferMetadata.length);
+
         buffer.flags = 0;
         buffer.reserved = 0;
         buffer.reserved2 = 0;
@@ -484,19 +1464,142 @@ bool input_channel_v4l_c::enqueue_mmap_back_buffers(const resolution_s &resoluti
             NBENE(("Failed to enqueue back buffers (failed on buffer #%d).", (i + 1)));
             goto fail;
         }
-
-        bufferMetadata.ptr = (uint8_t*)mmapPtr;
-        bufferMetadata.length = buffer.length;
-
-        this->mmapBackBuffers.push_back(bufferMetadata);
     }
 
     return true;
 
     fail:
+    this->free_back_buffers();
     return false;
 }
 
+void input_channel_v4l_c::free_back_buffers(void)
+{
+    v4l2_requestbuffers reqBuf = {0};
+
+    reqBuf.count = 0; // 0 releases all buffers.
+    reqBuf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    reqBuf.memory = input_channel_v4l_c::vcs_memory_type_to_v4l_memory_type(this->memoryType);
+
+    if (!this->device_ioctl(VIDIOC_REQBUFS, &reqBuf))
+    {
+        NBENE(("Stream buffers could not be deallocated (error %d).", errno));
+    }
+
+    for (const auto &buffer: this->backBuffers)
+    {
+        v4l_munmap(buffer.ptr, buffer.length);
+
+        if (buffer.dmabufFd >= 0)
+        {
+            close(buffer.dmabufFd);
+        }
+    }
+
+    this->backBufferFrames.clear();
+    this->backBuffers.clear();
+
+    return;
+}
+
+u32 input_channel_v4l_c::vcs_memory_type_to_v4l_memory_type(const capture_memory_e memoryType)
+{
+    switch (memoryType)
+    {
+        case capture_memory_e::dmabuf: return V4L2_MEMORY_DMABUF;
+        case capture_memory_e::userptr: return V4L2_MEMORY_USERPTR;
+        case capture_memory_e::mmap: return V4L2_MEMORY_MMAP;
+        default: k_assert(0, "Unknown memory type."); return V4L2_MEMORY_MMAP;
+    }
+}
+
+std::chrono::steady_clock::time_point input_channel_v4l_c::buffer_timestamp(const v4l2_buffer &buf)
+{
+    // On Linux, steady_clock is CLOCK_MONOTONIC, which V4L also uses for
+    // monotonic buffer timestamps.
+    if ((buf.flags & V4L2_BUF_FLAG_TIMESTAMP_MASK) == V4L2_BUF_FLAG_TIMESTAMP_MONOTONIC)
+    {
+        const auto sinceEpoch = (std::chrono::seconds(buf.timestamp.tv_sec) +
+                                 std::chrono::microseconds(buf.timestamp.tv_usec));
+
+        return std::chrono::steady_clock::time_point(std::chrono::duration_cast<std::chrono::steady_clock::duration>(sinceEpoch));
+    }
+
+    return std::chrono::steady_clock::now();
+}
+
+bool input_channel_v4l_c::sync_back_buffer_for_cpu(const unsigned bufferIdx, const bool isAccessStarting)
+{
+    const int dmabufFd = this->backBuffers.at(bufferIdx).dmabufFd;
+
+    if (dmabufFd < 0)
+    {
+        return true;
+    }
+
+    dma_buf_sync sync = {0};
+    sync.flags = (DMA_BUF_SYNC_READ | (isAccessStarting? DMA_BUF_SYNC_START : DMA_BUF_SYNC_END));
+
+    // The kernel asks for the sync to be restarted if it's interrupted.
+    int retVal = 0;
+    do
+    {
+        retVal = ioctl(dmabufFd, DMA_BUF_IOCTL_SYNC, &sync);
+    } while ((retVal < 0) && ((errno == EINTR) || (errno == EAGAIN)));
+
+    return (retVal == 0);
+}
+
+bool input_channel_v4l_c::capture_thread__reconfigure(const resolution_s &resolution)
+{
+    k_assert(!this->isZeroCopy, "Can't reconfigure the capture in place while in zero-copy mode.");
+
+    // Drivers refuse to change the crop rectangle or the capture format while
+    // back buffers are allocated (EBUSY), so we release the buffers before
+    // applying the new mode, and then allocate new ones sized for it.
+    if (!this->streamoff())
+    {
+        return false;
+    }
+
+    this->free_back_buffers();
+
+    if (!this->enqueue_back_buffers(resolution) ||
+        !this->streamon())
+    {
+        return false;
+    }
+
+    DEBUG(("Reconfigured %s for %u x %u.", this->v4lDeviceFileName.c_str(), resolution.w, resolution.h));
+
+    return true;
+}
+
+bool input_channel_v4l_c::needs_restart(void) const
+{
+    return this->isRestartRequired;
+}
+
+void input_channel_v4l_c::set_capture_region(const capture_region_s &region)
+{
+    std::lock_guard<std::mutex> lock(this->requestedCaptureRegionMutex);
+
+    this->requestedCaptureRegion = region;
+    this->isCaptureRegionChangePending = true;
+
+    return;
+}
+
+void input_channel_v4l_c::set_hardware_scaling_resolution(const resolution_s &resolution)
+{
+    std::lock_guard<std::mutex> lock(this->requestedScaledResolutionMutex);
+
+    this->requestedScaledResolution = resolution;
+    this->isScaledResolutionChangePending = true;
+
+    return;
+}
+
 bool input_channel_v4l_c::streamon(void)
 {
     v4l2_buf_type bufType = V4L2_BUF_TYPE_VIDEO_CAPTURE;
@@ -509,6 +1612,10 @@ bool input_channel_v4l_c::streamon(void)
         return false;
     }
 
+    // The device restarts its buffer sequence along with the stream.
+    this->isLatestSequenceValid = false;
+    this->isPrevFrameHashValid = false;
+
     return true;
 }
 
@@ -527,29 +1634,11 @@ bool input_channel_v4l_c::streamoff(void)
     return true;
 }
 
-bool input_channel_v4l_c::dequeue_mmap_back_buffers(void)
+bool input_channel_v4l_c::dequeue_back_buffers(void)
 {
-    v4l2_requestbuffers buf = {0};
-
-    buf.count = 0; // 0 releases all buffers.
-    buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
-    buf.memory = V4L2_MEMORY_MMAP;
-
-    if (!this->device_ioctl(VIDIOC_REQBUFS, &buf))
-    {
-        NBENE(("Stream buffers could not be deallocated (error %d).", errno));
-        goto fail;
-    }
-
-    for (const auto &buffer: this->mmapBackBuffers)
-    {
-        munmap(buffer.ptr, buffer.length);
-    }
+    this->free_back_buffers();
 
     return true;
-
-    fail:
-    return false;
 }
 
 bool input_channel_v4l_c::is_format_of_valid_signal(const v4l2_format *const format)
@@ -592,7 +1681,9 @@ bool input_channel_v4l_c::start_capturing()
         }
     }
 
-    if (!this->enqueue_mmap_back_buffers(this->source_resolution()))
+    this->subscribe_to_device_events();
+
+    if (!this->enqueue_back_buffers(this->source_resolution()))
     {
         goto fail;
     }
@@ -629,22 +1720,11 @@ bool input_channel_v4l_c::start_capturing()
             this->captureThreadFuture.wait();
         }
 
-        this->reset_capture_event_flags();
         this->push_capture_event(capture_event_e::signal_lost);
     }
     return false;
 }
 
-void input_channel_v4l_c::reset_capture_event_flags(void)
-{
-    for (auto &flag: this->captureEventFlags)
-    {
-        flag = 0;
-    }
-
-    return;
-}
-
 int input_channel_v4l_c::stop_capturing(void)
 {
     int retVal = 1;
@@ -661,11 +1741,8 @@ int input_channel_v4l_c::stop_capturing(void)
         // continue to force the capturing to stop.
         this->streamoff();
 
-        this->dequeue_mmap_back_buffers();
+        this->dequeue_back_buffers();
     }
-      
-    this->reset_capture_event_flags();
-    this->push_capture_event(capture_event_e::signal_lost);
 
     // Note: we don't return on error, we just continue to force the capturing
     // to stop.
@@ -17,9 +17,11 @@
 #include <chrono>
 #include <atomic>
 #include <vector>
+#include <mutex>
 #include "common/globals.h"
 #include "common/refresh_rate.h"
 #include "capture/capture.h"
+#include "capture/captured_frame_ring.h"
 #include "capture/vision_v4l/ic_v4l_video_parameters.h"
 
 struct v4l2_format;
@@ -27,17 +29,63 @@ struct v4l2_format;
 class input_channel_v4l_c
 {
 public:
-    // Open the input channel (/dev/videoX device) and start capturing from
-    // it.
-    input_channel_v4l_c(const std::string v4lDeviceFileName,
+    // The range within which the number of back buffers is adapted while
+    // capturing (see capture_thread__adapt_back_buffer_count()).
+    static const unsigned minNumBackBuffers = 2;
+    static const unsigned maxNumBackBuffers = 8;
+
+    // Open the input channel (/dev/videoX device, where X is channelIdx) and
+    // start capturing from it into dstFrameRing, via the given number of back
+    // buffers, which the channel will adapt to the device's needs as it goes
+    // along. If zeroCopy is true, captured frames will be queued as views onto
+    // the capture device's back buffers rather than as copies of them, if the
+    // device can provide enough back buffers for this. If convertOnCapture is
+    // true, 16-bit frames will be converted into BGRA as they're copied out of
+    // the back buffers. The back buffers will be of the given memory type, or
+    // of the next one down the list (see capture_memory_e) that the device
+    // supports. Only the given region of the signal's frames will be captured,
+    // if the device supports this, and scaled down to the given resolution
+    // (0 x 0 for none), if the device supports that. If drainToNewest is true,
+    // frames superseded by newer ones by the time we get to them are skipped.
+    input_channel_v4l_c(const unsigned channelIdx,
                         const unsigned numBackBuffers,
-                        captured_frame_s *const dstFrameBuffer);
+                        captured_frame_ring_c *const dstFrameRing,
+                        const bool zeroCopy,
+                        const bool convertOnCapture,
+                        const bool drainToNewest,
+                        const capture_memory_e preferredMemoryType,
+                        const capture_region_s &captureRegion,
+                        const resolution_s &scaledResolution);
 
     ~input_channel_v4l_c();
 
-    // Returns a copy of the current state of the given capture flag, then unsets
-    // the flag.
-    bool pop_capture_event(const capture_event_e flag);
+    // Returns true if the channel's capture thread is running; false otherwise
+    // (e.g. if we were unable to start capturing on the channel).
+    bool is_capturing(void) const;
+
+    // Returns true if the channel was unable to adapt to a new video mode by
+    // itself, in which case its capture thread will have exited and the channel
+    // should be re-created.
+    bool needs_restart(void) const;
+
+    // Asks the capture thread to capture only the given region of the signal's
+    // frames from now on (see kc_set_capture_region()).
+    void set_capture_region(const capture_region_s &region);
+
+    // Asks the capture thread to have the device scale the captured frames
+    // down to the given resolution from now on, or to stop scaling them if
+    // the resolution is 0 x 0 (see kc_set_hardware_scaling_resolution()).
+    void set_hardware_scaling_resolution(const resolution_s &resolution);
+
+    // To be called once VCS has finished processing the given frame from
+    // dstFrameRing, before it's popped from the queue. If the frame is a view
+    // onto one of our back buffers, hands the buffer back to the capture
+    // device. Returns true on success; false otherwise.
+    bool release_frame(const captured_frame_s *const frame);
+
+    // Returns the current number of back buffers, and the adjustments the
+    // capture thread has made to it. Thread-safe.
+    back_buffer_status_s back_buffer_status(void);
 
     // Execute an ioctl() on this input channel's underlying /dev/videoX device.
     // Returns true on success; false otherwise (see errno for ioctl() errors).
@@ -61,9 +109,18 @@ public:
         // device.
         bool invalidDevice = false;
 
-        // The current capture resolution.
+        // The current capture resolution, i.e. the size of the frames we
+        // capture.
         resolution_s resolution = {1024, 768, 32};
 
+        // The resolution of the current signal. Differs from the capture
+        // resolution if we're capturing only a region of the signal's frames.
+        resolution_s sourceResolution = {1024, 768, 32};
+
+        // The resolution of the frames we capture. Differs from the capture
+        // resolution if the device is scaling them for us.
+        resolution_s frameResolution = {1024, 768, 32};
+
         refresh_rate_s refreshRate = refresh_rate_s(0);
 
         ic_v4l_device_controls_c videoParameters;
@@ -74,9 +131,14 @@ public:
         std::atomic<unsigned int> numFramesCaptured = {0};
         
         // Count of frames we've captured which VCS wasn't able to process,
-        // e.g. due to being busy processing a previous frame.
+        // e.g. due to being busy processing previous frames such that the frame
+        // queue was full.
         std::atomic<unsigned int> numNewFrameEventsSkipped = {0};
 
+        // Count of frames we've deliberately skipped in favor of newer ones
+        // (see isDrainToNewest).
+        std::atomic<unsigned int> numFramesDrained = {0};
+
         capture_pixel_format_e pixelFormat = capture_pixel_format_e::rgb_888;
     } captureStatus;
 
@@ -86,12 +148,48 @@ private:
     // (see captureThreadFuture).
     int capture_thread(void);
 
-    // Poll the capture devicve for a new frame. Sets capture events flags
-    // accordingly. On success, returns true and either copies the new frame's
-    // data to dstFrameBuffer or does nothing if no new frame was available. On
-    // error, returns false.
+    // Poll the capture devicve for a new frame and for device events. On
+    // success, returns true and either copies the new frame's data into a slot
+    // in dstFrameRing or does nothing if no new frame was available. On error,
+    // returns false. If there's currently no usable signal, only waits for
+    // device events, for up to statusPollIntervalMs.
     bool capture_thread__get_next_frame(void);
 
+    // Adapts the capture to a new video mode with the given resolution by
+    // stopping the capture stream, re-creating the back buffers for the new
+    // format, and restarting the stream. Not available in zero-copy mode, as
+    // VCS may be holding on to some of the back buffers. Returns true on
+    // success; false otherwise.
+    bool capture_thread__reconfigure(const resolution_s &resolution);
+
+    // Grows the number of back buffers if the capture device has recently been
+    // dropping frames for lack of a free buffer to capture into, or shrinks it
+    // if the device has gone without dropping frames for a while. Returns true
+    // on success; false otherwise, in which case the channel needs restarting.
+    bool capture_thread__adapt_back_buffer_count(void);
+
+    // Re-creates the back buffers with the given count of them, recording the
+    // given reason in the adjustment history. Returns true on success; false
+    // otherwise.
+    bool capture_thread__set_back_buffer_count(const unsigned count, const std::string &reason);
+
+    // Accounts for the given sequence number of a dequeued back buffer, noting
+    // any frames the device dropped since the previous one.
+    void capture_thread__track_buffer_sequence(const u32 sequence);
+
+    // Returns true if the frame captured at the given time should be passed on
+    // to VCS under the current frame rate limit (see
+    // kc_set_frame_rate_limit()); false if it should be skipped.
+    bool capture_thread__is_frame_due(const std::chrono::steady_clock::time_point &timestamp);
+
+    // Dequeues the device's pending events (see subscribe_to_device_events())
+    // and acts on them.
+    void capture_thread__handle_device_events(void);
+
+    // Asks the device to notify us of changes to the input signal via events
+    // rather than us having to poll for them.
+    void subscribe_to_device_events(void);
+
     // Launch the capture thread. Returns true on success; false otherwise.
     bool start_capturing(void);
 
@@ -106,36 +204,110 @@ private:
     bool close_device(void);
 
     // Returns true if the current video mode (resolution, refresh rate, etc.) has
-    // changed; false otherwise.
+    // changed or if the new mode is invalid; false otherwise.
     bool capture_thread__has_source_mode_changed(void);
 
     // Returns true if the input channel is currently receiving a signal; false
     // otherwise.
     bool capture_thread__has_signal(void);
 
-    // Mark the given capture event as having occurred.
+    // Updates the channel's signal status from the given value of the device's
+    // "signal_type" control, reporting any change to VCS.
+    void capture_thread__update_signal_status(const int signalTypeControlValue);
+
+    // Report the given capture event to VCS via the capture subsystem's event
+    // queue.
     void push_capture_event(capture_event_e event);
 
-    // Sets the resolution of the Video4Linux capture buffers.
-    bool set_v4l_buffer_resolution(const resolution_s &resolution);
+    // For a signal of the given resolution, sets the capture device's crop
+    // rectangle to the capture region and the resolution of the Video4Linux
+    // capture buffers to match, or to the scaled resolution if one applies;
+    // updating the channel's capture and frame resolutions.
+    bool set_v4l_buffer_resolution(const resolution_s &sourceResolution);
 
-    void reset_capture_event_flags(void);
+    // Returns the capture region clipped to a signal of the given resolution,
+    // or the signal's full frame if no region is to be applied.
+    capture_region_s effective_capture_region(const resolution_s &sourceResolution) const;
 
     // Prepare the input channel's back buffers for capture.  Returns true on
     // success; false otherwise.
-    bool enqueue_mmap_back_buffers(const resolution_s &resolution);
-    bool dequeue_mmap_back_buffers(void);
+    bool enqueue_back_buffers(const resolution_s &resolution);
+    bool dequeue_back_buffers(void);
+
+    // Creates the given number of back buffers of the given memory type, each
+    // at least the given number of bytes in size, and queues them for capture.
+    // Returns true on success; false otherwise, in which case any buffers
+    // created will have been freed.
+    bool allocate_back_buffers(const capture_memory_e memoryType,
+                               const unsigned count,
+                               const unsigned minLength);
+    void free_back_buffers(void);
+
+    // Hands the given back buffer back to the capture device for it to capture
+    // into, ending the CPU's access to it. Returns true on success; false
+    // otherwise.
+    bool requeue_back_buffer(const unsigned bufferIdx);
+
+    // As requeue_back_buffer(), but for a dequeued buffer whose CPU access was
+    // never started, e.g. because synchronizing it failed.
+    bool requeue_unsynced_back_buffer(const unsigned bufferIdx);
+
+    // DMA-BUF back buffers need to be synchronized with the capture device
+    // around CPU access. For other memory types, this does nothing. Returns
+    // true on success; false otherwise, with errno set.
+    bool sync_back_buffer_for_cpu(const unsigned bufferIdx, const bool isAccessStarting);
+
+    // Converts VCS's memory type enumerator into Video4Linux's memory type
+    // identifier.
+    static u32 vcs_memory_type_to_v4l_memory_type(const capture_memory_e memoryType);
+
+    // Returns the time at which the given dequeued buffer was captured. Falls
+    // back to the current time if the device's timestamps aren't taken from the
+    // monotonic clock.
+    static std::chrono::steady_clock::time_point buffer_timestamp(const v4l2_buffer &buf);
 
     bool streamon(void);
     bool streamoff(void);
 
-    // Metadata about each mmap() back buffer we've created.
-    struct mmap_metadata
+    // Metadata about each back buffer we've created. Regardless of the buffer's
+    // memory type, its data is accessible to us via 'ptr'.
+    struct back_buffer_metadata
     {
         uint8_t *ptr;
         unsigned length;
+
+        // The buffer's DMA-BUF file descriptor, or -1 if it's not a DMA-BUF.
+        int dmabufFd;
     };
-    std::vector<mmap_metadata> mmapBackBuffers;
+    std::vector<back_buffer_metadata> backBuffers;
+
+    // The memory type of the back buffers.
+    capture_memory_e memoryType = capture_memory_e::mmap;
+
+    // The memory type we'll first try to allocate the back buffers in.
+    const capture_memory_e preferredMemoryType;
+
+    // In zero-copy mode, a frame for each back buffer, its pixel data pointing
+    // to the buffer's memory. These frames are what we push into dstFrameRing,
+    // and each one's back buffer stays dequeued from the capture device until
+    // VCS has released the frame (see release_frame()).
+    std::vector<captured_frame_s> backBufferFrames;
+
+    // Whether we're queuing captured frames as views onto the back buffers
+    // (true) or as copies of them (false).
+    bool isZeroCopy;
+
+    // Whether, when copying captured frames out of the back buffers, we convert
+    // them into BGRA (true) or leave that for VCS to do (false). Has no effect
+    // in zero-copy mode.
+    const bool isConvertOnCapture;
+
+    // Whether, on finding that the capture device has completed more than one
+    // frame since we last checked, we dequeue them all and hand VCS only the
+    // newest (true), or hand them over one at a time, oldest first (false).
+    // Keeps the latency from capture to display within about a frame when
+    // VCS can't keep up.
+    const bool isDrainToNewest;
 
     // Returns the maximum supported capture resolution for this input channel.
     resolution_s maximum_resolution(void) const;
@@ -147,22 +319,62 @@ private:
     // identifier.
     u32 vcs_pixel_format_to_v4l_pixel_format(capture_pixel_format_e fmt) const;
 
-    // Flags that the capture channel will set to convey to the VCS thread the
-    // various capture events it detects during capture.
-    std::vector<unsigned> captureEventFlags = std::vector<unsigned>(static_cast<unsigned>(capture_event_e::num_enumerators));
+    // The channel's index, as reported to VCS with its frames and events.
+    const unsigned channelIdx;
 
     std::string v4lDeviceFileName = "";
 
+    // The most recent video mode we've seen on this channel. Persisted across
+    // instances of the channel (see the constructor), so that a re-created
+    // channel doesn't report the same mode as new.
+    video_mode_s latestVideoMode;
+
     // The value returned by open(deviceFileName).
     int v4lDeviceFileHandle = -1;
 
-    // The frame buffer we'll output captured frames into. Expected to be hosted
-    // by the parent capture API
-    captured_frame_s *const dstFrameBuffer;
-
-    // The number of back buffers our parent capture API asked us to use. Note that
-    // the capture device may not be able to supply this many.
-    const unsigned requestedNumBackBuffers;
+    // The frame queue we'll output captured frames into. Expected to be hosted
+    // by the parent capture API.
+    captured_frame_ring_c *const dstFrameRing;
+
+    // The number of back buffers we ask the capture device for. Starts out as
+    // the number our parent capture API asked us to use, and is then adapted by
+    // the capture thread. Note that the device may not be able to supply this
+    // many.
+    unsigned requestedNumBackBuffers;
+
+    // For adapting the number of back buffers. Gaps in the sequence numbers of
+    // the buffers we dequeue indicate frames the capture device dropped for
+    // lack of a free buffer; we total these over evaluation periods of
+    // backBufferEvaluationIntervalMs, and shrink the number of buffers after
+    // backBufferStableIntervalMs without drops. If shrinking to a given count
+    // leads to drops, we won't shrink to that count again (backBufferFloor).
+    static const unsigned backBufferEvaluationIntervalMs = 1000;
+    static const unsigned backBufferStableIntervalMs = 30000;
+    u32 latestSequence = 0;
+    bool isLatestSequenceValid = false;
+    unsigned numFramesStarved = 0;
+    unsigned backBufferFloor = minNumBackBuffers;
+    bool isBackBufferCountAtDeviceLimit = false;
+    bool wasLastAdjustmentShrink = false;
+    std::chrono::steady_clock::time_point backBufferEvaluationStart;
+    std::chrono::steady_clock::time_point timeOfLastStarvation;
+
+    // For detecting duplicate frames (see kc_set_duplicate_frame_handling()).
+    // The hash of the previous frame's pixels; valid only if
+    // isPrevFrameHashValid.
+    u64 prevFrameHash = 0;
+    bool isPrevFrameHashValid = false;
+
+    // For capping the rate at which we pass frames on to VCS (see
+    // kc_set_frame_rate_limit()). The capture time at which the next frame is
+    // due to be passed on; valid only if isNextFrameDueTimeValid.
+    std::chrono::steady_clock::time_point nextFrameDueTime;
+    bool isNextFrameDueTimeValid = false;
+
+    // What back_buffer_status() reports. Written by the capture thread.
+    static const unsigned maxBackBufferHistoryLength = 16;
+    back_buffer_status_s backBufferStatus = {0, false, minNumBackBuffers, maxNumBackBuffers, {}};
+    std::mutex backBufferStatusMutex;
 
     // A future holding the return value of capture_thread().
     std::future<int> captureThreadFuture;
@@ -170,6 +382,48 @@ private:
     // Will be set to true before launching capture_thread(). The thread will
     // run until this is set to false.
     std::atomic<bool> run = {false};
+
+    // Set by the capture thread if it exits for the channel to be re-created
+    // (see needs_restart()).
+    std::atomic<bool> isRestartRequired = {false};
+
+    // Whether the device reports changes to the source's video mode and to the
+    // signal's presence via events (see subscribe_to_device_events()). For
+    // those it doesn't, the capture thread polls the device's status every
+    // statusPollIntervalMs milliseconds.
+    bool isSourceChangeEventSubscribed = false;
+    bool isSignalEventSubscribed = false;
+    static const unsigned statusPollIntervalMs = 250;
+
+    // Set by the capture thread when it should next re-query the source's video
+    // mode or the signal's presence, e.g. in response to a device event.
+    bool isSourceCheckPending = false;
+    bool isSignalCheckPending = false;
+
+    // The region of the signal's frames we capture. Owned by the capture
+    // thread, which adopts requestedCaptureRegion into it when
+    // isCaptureRegionChangePending gets set.
+    capture_region_s captureRegion;
+    capture_region_s requestedCaptureRegion;
+    std::mutex requestedCaptureRegionMutex;
+    std::atomic<bool> isCaptureRegionChangePending = {false};
+
+    // Whether the device supports cropping its capture via VIDIOC_S_SELECTION;
+    // and whether it's currently cropping.
+    bool isCropSupported = true;
+    bool isCropApplied = false;
+
+    // The resolution the device scales the captured frames down to, or 0 x 0
+    // if they aren't to be scaled. Owned by the capture thread, like the
+    // capture region.
+    resolution_s scaledResolution;
+    resolution_s requestedScaledResolution;
+    std::mutex requestedScaledResolutionMutex;
+    std::atomic<bool> isScaledResolutionChangePending = {false};
+
+    // Set to false if the device turns out not to be able to scale its capture
+    // (by accepting a buffer size smaller than the crop rectangle).
+    bool isScalingSupported = true;
 };
 
 #endif
@@ -0,0 +1,1115 @@
+/*
+ * 2021 Tarpeeksi Hyvae Soft
+ *
+ * Software: VCS
+ *
+ */
+
+#ifdef CAPTURE_DEVICE_VISION_V4L
+#ifdef MOCK_V4L_DEVICE
+
+#include <sys/eventfd.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <linux/videodev2.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <chrono>
+#include <thread>
+#include <mutex>
+#include <deque>
+#include <map>
+#include <string>
+#include <vector>
+#include "capture/vision_v4l/mock/v4l_mock_device.h"
+#include "common/globals.h"
+
+#include <visionrgb/include/rgb133v4l2.h>
+
+// The control via which the capture code reads the status of the input signal,
+// and the control's values for no signal and for a (digital) signal. These match
+// what input_channel_v4l.cpp expects.
+static const unsigned SIGNAL_TYPE_CONTROL_ID = 0x8000013;
+static const int NO_SIGNAL_CONTROL_VALUE = 0;
+static const int DIGITAL_SIGNAL_CONTROL_VALUE = 1;
+
+struct mock_video_mode_s
+{
+    unsigned width;
+    unsigned height;
+    double refreshRate;
+};
+
+struct mock_control_s
+{
+    const char *name;
+    unsigned id;
+    int minimum;
+    int maximum;
+    int defaultValue;
+    bool isReadOnly;
+    int value;
+};
+
+struct mock_buffer_s
+{
+    u8 *ptr;
+    size_t length;
+
+    // For MMAP buffers, the offset at which the buffer can be mmap()'d.
+    unsigned offset;
+
+    bool isMapped;
+    bool isQueued;
+
+    // The buffer's details as of its most recent capture.
+    v4l2_buffer info;
+};
+
+struct mock_input_s
+{
+    // The file descriptor via which the input's buffers were requested, or -1
+    // if none has been.
+    int streamingFd = -1;
+
+    v4l2_pix_format format = {};
+    v4l2_rect crop = {};
+
+    unsigned memory = V4L2_MEMORY_MMAP;
+    std::vector<mock_buffer_s> buffers;
+
+    // Buffers queued by the application and waiting to be captured into; and
+    // buffers captured into and waiting to be dequeued.
+    std::deque<unsigned> incoming;
+    std::deque<unsigned> done;
+
+    bool isStreaming = false;
+    unsigned sequence = 0;
+    std::chrono::steady_clock::time_point nextFrameTime;
+
+    // The source's state as last seen by the input.
+    unsigned modeIdx = 0;
+    bool hasSignal = true;
+
+    std::vector<mock_control_s> controls;
+};
+
+// A file opened on one of the inputs.
+struct mock_file_s
+{
+    unsigned inputIdx;
+
+    bool isSourceChangeSubscribed;
+    bool isSignalSubscribed;
+    std::deque<v4l2_event> events;
+};
+
+static struct
+{
+    unsigned numInputs = 2;
+    std::vector<mock_video_mode_s> modes;
+    unsigned modeIntervalMs = 0;
+    unsigned signalLossIntervalMs = 0;
+    unsigned signalLossDurationMs = 1000;
+    unsigned maxNumBuffers = 32;
+    bool areEventsSupported = true;
+} CONFIG;
+
+static std::mutex MUTEX;
+static bool IS_INITIALIZED = false;
+static std::chrono::steady_clock::time_point START_TIME;
+static std::vector<mock_input_s> INPUTS;
+
+// Keyed by file descriptor.
+static std::map<int, mock_file_s> OPEN_FILES;
+
+static unsigned env_value(const char *const name, const unsigned defaultValue)
+{
+    const char *const value = getenv(name);
+
+    return (value? unsigned(strtoul(value, nullptr, 10)) : defaultValue);
+}
+
+// Must be called with MUTEX locked.
+static void initialize(void)
+{
+    if (IS_INITIALIZED)
+    {
+        return;
+    }
+
+    CONFIG.numInputs = env_value("VCS_MOCK_V4L_INPUTS", CONFIG.numInputs);
+    CONFIG.modeIntervalMs = env_value("VCS_MOCK_V4L_MODE_INTERVAL_MS", CONFIG.modeIntervalMs);
+    CONFIG.signalLossIntervalMs = env_value("VCS_MOCK_V4L_SIGNAL_LOSS_INTERVAL_MS", CONFIG.signalLossIntervalMs);
+    CONFIG.signalLossDurationMs = env_value("VCS_MOCK_V4L_SIGNAL_LOSS_DURATION_MS", CONFIG.signalLossDurationMs);
+    CONFIG.maxNumBuffers = std::max(1u, env_value("VCS_MOCK_V4L_MAX_BUFFERS", CONFIG.maxNumBuffers));
+    CONFIG.areEventsSupported = env_value("VCS_MOCK_V4L_EVENTS", CONFIG.areEventsSupported);
+
+    // Parse the video modes, e.g. "640x480@60,720x400@70.086".
+    {
+        const char *const modesString = getenv("VCS_MOCK_V4L_MODES");
+        std::string modes = (modesString? modesString : "640x480@60");
+
+        for (size_t start = 0; start < modes.size();)
+        {
+            const size_t end = std::min(modes.find(',', start), modes.size());
+            const std::string modeString = modes.substr(start, (end - start));
+            mock_video_mode_s mode = {};
+
+            if ((sscanf(modeString.c_str(), "%ux%u@%lf", &mode.width, &mode.height, &mode.refreshRate) == 3) &&
+                mode.width &&
+                mode.height &&
+                (mode.refreshRate > 0))
+            {
+                CONFIG.modes.push_back(mode);
+            }
+            else
+            {
+                NBENE(("Mock V4L device: ignoring the malformed video mode \"%s\".", modeString.c_str()));
+            }
+
+            start = (end + 1);
+        }
+
+        if (CONFIG.modes.empty())
+        {
+            CONFIG.modes.push_back({640, 480, 60});
+        }
+    }
+
+    INPUTS.resize(CONFIG.numInputs);
+
+    for (auto &input: INPUTS)
+    {
+        const mock_video_mode_s &mode = CONFIG.modes.front();
+
+        input.format.width = mode.width;
+        input.format.height = mode.height;
+        input.format.pixelformat = V4L2_PIX_FMT_RGB32;
+        input.format.field = V4L2_FIELD_NONE;
+        input.format.bytesperline = (mode.width * 4);
+        input.format.sizeimage = (input.format.bytesperline * mode.height);
+        input.format.colorspace = V4L2_COLORSPACE_SRGB;
+        input.crop = {0, 0, mode.width, mode.height};
+
+        input.controls = {
+            {"Brightness",          V4L2_CID_BRIGHTNESS,               0,    255,  128, false, 0},
+            {"Contrast",            V4L2_CID_CONTRAST,                 0,    255,  128, false, 0},
+            {"Horizontal Size",     (V4L2_CID_PRIVATE_BASE + 0),       100,  4096, 800, false, 0},
+            {"Horizontal Position", (V4L2_CID_PRIVATE_BASE + 1),       -100, 100,  0,   false, 0},
+            {"Vertical Position",   (V4L2_CID_PRIVATE_BASE + 2),       -100, 100,  0,   false, 0},
+            {"Phase",               (V4L2_CID_PRIVATE_BASE + 3),       0,    31,   0,   false, 0},
+            {"Black Level",         (V4L2_CID_PRIVATE_BASE + 4),       0,    255,  8,   false, 0},
+            {"Signal Type",         SIGNAL_TYPE_CONTROL_ID,            0,    10,   0,   true,  0},
+        };
+
+        for (auto &control: input.controls)
+        {
+            control.value = control.defaultValue;
+        }
+    }
+
+    START_TIME = std::chrono::steady_clock::now();
+    IS_INITIALIZED = true;
+
+    INFO(("Mock V4L device: emulating a Vision capture card with %u input(s).", CONFIG.numInputs));
+
+    return;
+}
+
+static unsigned ms_since_start(const std::chrono::steady_clock::time_point time)
+{
+    return unsigned(std::chrono::duration_cast<std::chrono::milliseconds>(time - START_TIME).count());
+}
+
+static unsigned source_mode_idx_at(const std::chrono::steady_clock::time_point time)
+{
+    if (!CONFIG.modeIntervalMs)
+    {
+        return 0;
+    }
+
+    return ((ms_since_start(time) / CONFIG.modeIntervalMs) % CONFIG.modes.size());
+}
+
+// The signal is lost for the last CONFIG.signalLossDurationMs of each interval.
+static bool source_has_signal_at(const std::chrono::steady_clock::time_point time)
+{
+    if (!CONFIG.signalLossIntervalMs)
+    {
+        return true;
+    }
+
+    const unsigned lossDuration = std::min(CONFIG.signalLossDurationMs, CONFIG.signalLossIntervalMs);
+
+    return ((ms_since_start(time) % CONFIG.signalLossIntervalMs) < (CONFIG.signalLossIntervalMs - lossDuration));
+}
+
+// Returns the time of the source's next change of video mode or signal status
+// after the given time.
+static std::chrono::steady_clock::time_point next_source_change_after(const std::chrono::steady_clock::time_point time)
+{
+    const unsigned ms = ms_since_start(time);
+    unsigned nextMs = ~0u;
+
+    if (CONFIG.modeIntervalMs)
+    {
+        nextMs = std::min(nextMs, (((ms / CONFIG.modeIntervalMs) + 1) * CONFIG.modeIntervalMs));
+    }
+
+    if (CONFIG.signalLossIntervalMs)
+    {
+        const unsigned intervalStart = ((ms / CONFIG.signalLossIntervalMs) * CONFIG.signalLossIntervalMs);
+        const unsigned lossStart = (intervalStart + CONFIG.signalLossIntervalMs - std::min(CONFIG.signalLossDurationMs, CONFIG.signalLossIntervalMs));
+
+        nextMs = std::min(nextMs, ((ms < lossStart)? lossStart : (intervalStart + CONFIG.signalLossIntervalMs)));
+    }
+
+    if (nextMs == ~0u)
+    {
+        return std::chrono::steady_clock::time_point::max();
+    }
+
+    return (START_TIME + std::chrono::milliseconds(nextMs));
+}
+
+static std::chrono::steady_clock::duration frame_period(const mock_input_s &input)
+{
+    const std::chrono::duration<double> period(1.0 / CONFIG.modes.at(input.modeIdx).refreshRate);
+
+    return std::chrono::duration_cast<std::chrono::steady_clock::duration>(period);
+}
+
+static void push_event(const unsigned inputIdx, const v4l2_event &event)
+{
+    for (auto &file: OPEN_FILES)
+    {
+        if ((file.second.inputIdx == inputIdx) &&
+            (((event.type == V4L2_EVENT_SOURCE_CHANGE) && file.second.isSourceChangeSubscribed) ||
+             ((event.type == V4L2_EVENT_CTRL) && file.second.isSignalSubscribed)))
+        {
+            file.second.events.push_back(event);
+        }
+    }
+
+    return;
+}
+
+// Brings the input's view of the source up to date, reporting any changes as
+// events.
+static void update_source_state(const unsigned inputIdx, const std::chrono::steady_clock::time_point now)
+{
+    mock_input_s &input = INPUTS.at(inputIdx);
+
+    const bool hasSignal = source_has_signal_at(now);
+    const unsigned modeIdx = source_mode_idx_at(now);
+
+    if (hasSignal != input.hasSignal)
+    {
+        input.hasSignal = hasSignal;
+
+        v4l2_event event = {};
+        event.type = V4L2_EVENT_CTRL;
+        event.id = SIGNAL_TYPE_CONTROL_ID;
+        event.u.ctrl.changes = V4L2_EVENT_CTRL_CH_VALUE;
+        event.u.ctrl.value = (hasSignal? DIGITAL_SIGNAL_CONTROL_VALUE : NO_SIGNAL_CONTROL_VALUE);
+
+        push_event(inputIdx, event);
+    }
+
+    if (modeIdx != input.modeIdx)
+    {
+        input.modeIdx = modeIdx;
+        input.nextFrameTime = (now + frame_period(input));
+
+        v4l2_event event = {};
+        event.type = V4L2_EVENT_SOURCE_CHANGE;
+        event.u.src_change.changes = V4L2_EVENT_SRC_CH_RESOLUTION;
+
+        push_event(inputIdx, event);
+    }
+
+    return;
+}
+
+// Captures the current frame into the given queued buffer, filling it with a
+// pattern of horizontal bars that scroll with each frame.
+static void capture_into_buffer(mock_input_s &input,
+                                const unsigned bufferIdx,
+                                const std::chrono::steady_clock::time_point time)
+{
+    mock_buffer_s &buffer = input.buffers.at(bufferIdx);
+    const size_t frameSize = std::min(size_t(input.format.sizeimage), buffer.length);
+
+    if (buffer.ptr &&
+        input.format.bytesperline)
+    {
+        for (size_t y = 0; ((y * input.format.bytesperline) < frameSize); y++)
+        {
+            memset((buffer.ptr + (y * input.format.bytesperline)),
+                   u8(y + input.sequence),
+                   std::min(size_t(input.format.bytesperline), (frameSize - (y * input.format.bytesperline))));
+        }
+    }
+
+    const auto sinceEpoch = std::chrono::duration_cast<std::chrono::microseconds>(time.time_since_epoch()).count();
+
+    buffer.info = {};
+    buffer.info.index = bufferIdx;
+    buffer.info.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    buffer.info.memory = input.memory;
+    buffer.info.bytesused = unsigned(frameSize);
+    buffer.info.field = V4L2_FIELD_NONE;
+    buffer.info.sequence = input.sequence;
+    buffer.info.flags = V4L2_BUF_FLAG_TIMESTAMP_MONOTONIC;
+    buffer.info.timestamp.tv_sec = (sinceEpoch / 1000000);
+    buffer.info.timestamp.tv_usec = (sinceEpoch % 1000000);
+
+    input.done.push_back(bufferIdx);
+
+    return;
+}
+
+// Emulates the input's operation up to the given time: reports changes in the
+// source, and captures the frames due by then into the queued buffers. Frames
+// for which there's no queued buffer are dropped.
+static void advance(const unsigned inputIdx, const std::chrono::steady_clock::time_point now)
+{
+    mock_input_s &input = INPUTS.at(inputIdx);
+
+    update_source_state(inputIdx, now);
+
+    if (!input.isStreaming)
+    {
+        return;
+    }
+
+    const auto period = frame_period(input);
+
+    // Skip over long stretches of time without emulating each frame in them,
+    // e.g. if no-one has accessed the device in a while.
+    if ((now - input.nextFrameTime) > std::chrono::seconds(1))
+    {
+        const auto numFramesSkipped = ((now - input.nextFrameTime) / period);
+
+        input.nextFrameTime += (numFramesSkipped * period);
+
+        if (input.hasSignal)
+        {
+            input.sequence += unsigned(numFramesSkipped);
+        }
+    }
+
+    while (input.nextFrameTime <= now)
+    {
+        if (input.hasSignal)
+        {
+            if (!input.incoming.empty())
+            {
+                capture_into_buffer(input, input.incoming.front(), input.nextFrameTime);
+                input.incoming.pop_front();
+            }
+
+            input.sequence++;
+        }
+
+        input.nextFrameTime += period;
+    }
+
+    return;
+}
+
+static void release_buffers(mock_input_s &input)
+{
+    for (auto &buffer: input.buffers)
+    {
+        // Mapped MMAP buffers get freed when the application unmaps them.
+        if ((input.memory == V4L2_MEMORY_MMAP) &&
+            buffer.ptr &&
+            !buffer.isMapped)
+        {
+            munmap(buffer.ptr, buffer.length);
+        }
+    }
+
+    input.buffers.clear();
+    input.incoming.clear();
+    input.done.clear();
+
+    return;
+}
+
+static mock_control_s* find_control(mock_input_s &input, const unsigned id)
+{
+    for (auto &control: input.controls)
+    {
+        if (control.id == id)
+        {
+            if (id == SIGNAL_TYPE_CONTROL_ID)
+            {
+                control.value = (input.hasSignal? DIGITAL_SIGNAL_CONTROL_VALUE : NO_SIGNAL_CONTROL_VALUE);
+            }
+
+            return &control;
+        }
+    }
+
+    return nullptr;
+}
+
+// Handles the given ioctl() request on a file of the mock device. Returns 0 on
+// success; or an errno value on failure. Must be called with MUTEX locked.
+static int handle_ioctl(const int fd, const unsigned long request, void *const arg)
+{
+    mock_file_s &file = OPEN_FILES.at(fd);
+    mock_input_s &input = INPUTS.at(file.inputIdx);
+    const auto now = std::chrono::steady_clock::now();
+
+    advance(file.inputIdx, now);
+
+    switch (request)
+    {
+        case VIDIOC_QUERYCAP:
+        {
+            v4l2_capability *const caps = (v4l2_capability*)arg;
+
+            *caps = {};
+            snprintf((char*)caps->driver, sizeof(caps->driver), "Vision");
+            snprintf((char*)caps->card, sizeof(caps->card), "Mock Vision Input %u", (file.inputIdx + 1));
+            snprintf((char*)caps->bus_info, sizeof(caps->bus_info), "mock:vision");
+            caps->version = ((1 << 16) | (0 << 8) | 0);
+            caps->device_caps = (V4L2_CAP_VIDEO_CAPTURE | V4L2_CAP_READWRITE | V4L2_CAP_STREAMING);
+            caps->capabilities = (caps->device_caps | V4L2_CAP_DEVICE_CAPS);
+
+            return 0;
+        }
+        case RGB133_VIDIOC_G_SRC_FMT:
+        {
+            v4l2_format *const format = (v4l2_format*)arg;
+            const mock_video_mode_s &mode = CONFIG.modes.at(input.modeIdx);
+
+            if (format->type != V4L2_BUF_TYPE_CAPTURE_SOURCE)
+            {
+                return EINVAL;
+            }
+
+            format->fmt.pix = {};
+            format->fmt.pix.width = mode.width;
+            format->fmt.pix.height = mode.height;
+            format->fmt.pix.priv = unsigned((mode.refreshRate * 1000) + 0.5);
+
+            return 0;
+        }
+        case VIDIOC_G_FMT:
+        case VIDIOC_S_FMT:
+        {
+            v4l2_format *const format = (v4l2_format*)arg;
+
+            if (format->type != V4L2_BUF_TYPE_VIDEO_CAPTURE)
+            {
+                return EINVAL;
+            }
+
+            if (request == VIDIOC_S_FMT)
+            {
+                if (!input.buffers.empty())
+                {
+                    return EBUSY;
+                }
+
+                v4l2_pix_format &pix = input.format;
+                unsigned bytesPerPixel = 4;
+
+                switch (format->fmt.pix.pixelformat)
+                {
+                    case V4L2_PIX_FMT_RGB555:
+                    case V4L2_PIX_FMT_RGB565: bytesPerPixel = 2; pix.pixelformat = format->fmt.pix.pixelformat; break;
+                    default: bytesPerPixel = 4; pix.pixelformat = V4L2_PIX_FMT_RGB32; break;
+                }
+
+                pix.width = std::max(1u, std::min(4096u, format->fmt.pix.width));
+                pix.height = std::max(1u, std::min(4096u, format->fmt.pix.height));
+                pix.field = V4L2_FIELD_NONE;
+                pix.bytesperline = (pix.width * bytesPerPixel);
+                pix.sizeimage = (pix.bytesperline * pix.height);
+            }
+
+            format->fmt.pix = input.format;
+
+            return 0;
+        }
+        case VIDIOC_S_SELECTION:
+        {
+            v4l2_selection *const selection = (v4l2_selection*)arg;
+            const mock_video_mode_s &mode = CONFIG.modes.at(input.modeIdx);
+
+            if ((selection->type != V4L2_BUF_TYPE_VIDEO_CAPTURE) ||
+                (selection->target != V4L2_SEL_TGT_CROP))
+            {
+                return EINVAL;
+            }
+
+            if (!input.buffers.empty())
+            {
+                return EBUSY;
+            }
+
+            // Adjust the rectangle to fit within the source frame.
+            selection->r.left = std::max(0, std::min(int(mode.width - 1), selection->r.left));
+            selection->r.top = std::max(0, std::min(int(mode.height - 1), selection->r.top));
+            selection->r.width = std::max(1u, std::min((mode.width - selection->r.left), selection->r.width));
+            selection->r.height = std::max(1u, std::min((mode.height - selection->r.top), selection->r.height));
+
+            input.crop = selection->r;
+
+            return 0;
+        }
+        case VIDIOC_G_SELECTION:
+        {
+            v4l2_selection *const selection = (v4l2_selection*)arg;
+
+            if ((selection->type != V4L2_BUF_TYPE_VIDEO_CAPTURE) ||
+                (selection->target != V4L2_SEL_TGT_CROP))
+            {
+                return EINVAL;
+            }
+
+            selection->r = input.crop;
+
+            return 0;
+        }
+        case VIDIOC_REQBUFS:
+        {
+            v4l2_requestbuffers *const reqBuf = (v4l2_requestbuffers*)arg;
+
+            // DMA-BUF import isn't supported, as with many real devices.
+            if ((reqBuf->type != V4L2_BUF_TYPE_VIDEO_CAPTURE) ||
+                ((reqBuf->memory != V4L2_MEMORY_MMAP) && (reqBuf->memory != V4L2_MEMORY_USERPTR)))
+            {
+                return EINVAL;
+            }
+
+            if (input.isStreaming ||
+                ((input.streamingFd >= 0) && (input.streamingFd != fd)))
+            {
+                return EBUSY;
+            }
+
+            release_buffers(input);
+            input.streamingFd = -1;
+
+            if (!reqBuf->count)
+            {
+                return 0;
+            }
+
+            const unsigned pageSize = unsigned(sysconf(_SC_PAGESIZE));
+            const unsigned length = (((input.format.sizeimage + pageSize - 1) / pageSize) * pageSize);
+
+            input.memory = reqBuf->memory;
+            input.streamingFd = fd;
+            reqBuf->count = std::min(reqBuf->count, CONFIG.maxNumBuffers);
+
+            for (unsigned i = 0; i < reqBuf->count; i++)
+            {
+                mock_buffer_s buffer = {};
+
+                if (input.memory == V4L2_MEMORY_MMAP)
+                {
+                    void *const ptr = mmap(NULL, length, (PROT_READ | PROT_WRITE), (MAP_PRIVATE | MAP_ANONYMOUS), -1, 0);
+
+                    if (ptr == MAP_FAILED)
+                    {
+                        release_buffers(input);
+                        input.streamingFd = -1;
+
+                        return ENOMEM;
+                    }
+
+                    buffer.ptr = (u8*)ptr;
+                    buffer.length = length;
+                    buffer.offset = (i * length);
+                }
+
+                input.buffers.push_back(buffer);
+            }
+
+            return 0;
+        }
+        case VIDIOC_QUERYBUF:
+        {
+            v4l2_buffer *const buf = (v4l2_buffer*)arg;
+
+            if ((buf->type != V4L2_BUF_TYPE_VIDEO_CAPTURE) ||
+                (buf->index >= input.buffers.size()))
+            {
+                return EINVAL;
+            }
+
+            const mock_buffer_s &buffer = input.buffers.at(buf->index);
+
+            buf->memory = input.memory;
+            buf->length = unsigned(buffer.length);
+            buf->flags = (V4L2_BUF_FLAG_TIMESTAMP_MONOTONIC |
+                          (buffer.isMapped? V4L2_BUF_FLAG_MAPPED : 0) |
+                          (buffer.isQueued? V4L2_BUF_FLAG_QUEUED : 0));
+
+            if (input.memory == V4L2_MEMORY_MMAP)
+            {
+                buf->m.offset = buffer.offset;
+            }
+
+            return 0;
+        }
+        case VIDIOC_QBUF:
+        {
+            v4l2_buffer *const buf = (v4l2_buffer*)arg;
+
+            if ((buf->type != V4L2_BUF_TYPE_VIDEO_CAPTURE) ||
+                (buf->memory != input.memory) ||
+                (buf->index >= input.buffers.size()) ||
+                (input.streamingFd != fd))
+            {
+                return EINVAL;
+            }
+
+            mock_buffer_s &buffer = input.buffers.at(buf->index);
+
+            if (buffer.isQueued)
+            {
+                return EINVAL;
+            }
+
+            if (input.memory == V4L2_MEMORY_USERPTR)
+            {
+                if (!buf->m.userptr ||
+                    (buf->length < input.format.sizeimage))
+                {
+                    return EINVAL;
+                }
+
+                buffer.ptr = (u8*)buf->m.userptr;
+                buffer.length = buf->length;
+            }
+
+            buffer.isQueued = true;
+            input.incoming.push_back(buf->index);
+
+            buf->flags = (V4L2_BUF_FLAG_TIMESTAMP_MONOTONIC | V4L2_BUF_FLAG_QUEUED);
+
+            return 0;
+        }
+        case VIDIOC_DQBUF:
+        {
+            v4l2_buffer *const buf = (v4l2_buffer*)arg;
+
+            if ((buf->type != V4L2_BUF_TYPE_VIDEO_CAPTURE) ||
+                (input.streamingFd != fd))
+            {
+                return EINVAL;
+            }
+
+            // VCS opens the device in non-blocking mode, so we don't emulate
+            // blocking until a frame is available.
+            if (input.done.empty())
+            {
+                return EAGAIN;
+            }
+
+            mock_buffer_s &buffer = input.buffers.at(input.done.front());
+            input.done.pop_front();
+
+            buffer.isQueued = false;
+
+            *buf = buffer.info;
+            buf->flags |= V4L2_BUF_FLAG_DONE;
+            buf->length = unsigned(buffer.length);
+
+            if (input.memory == V4L2_MEMORY_USERPTR)
+            {
+                buf->m.userptr = (unsigned long)buffer.ptr;
+            }
+            else
+            {
+                buf->m.offset = buffer.offset;
+            }
+
+            return 0;
+        }
+        case VIDIOC_STREAMON:
+        case VIDIOC_STREAMOFF:
+        {
+            if ((*(const int*)arg != V4L2_BUF_TYPE_VIDEO_CAPTURE) ||
+                (input.streamingFd != fd))
+            {
+                return EINVAL;
+            }
+
+            if (request == VIDIOC_STREAMON)
+            {
+                if (!input.isStreaming)
+                {
+                    input.isStreaming = true;
+                    input.sequence = 0;
+                    input.nextFrameTime = (now + frame_period(input));
+                }
+            }
+            else
+            {
+                // Stopping the stream returns all buffers to the application.
+                input.isStreaming = false;
+                input.incoming.clear();
+                input.done.clear();
+
+                for (auto &buffer: input.buffers)
+                {
+                    buffer.isQueued = false;
+                }
+            }
+
+            return 0;
+        }
+        case VIDIOC_QUERYCTRL:
+        {
+            v4l2_queryctrl *const query = (v4l2_queryctrl*)arg;
+            const mock_control_s *const control = find_control(input, query->id);
+
+            if (!control)
+            {
+                return EINVAL;
+            }
+
+            const unsigned id = query->id;
+
+            *query = {};
+            query->id = id;
+            query->type = V4L2_CTRL_TYPE_INTEGER;
+            snprintf((char*)query->name, sizeof(query->name), "%s", control->name);
+            query->minimum = control->minimum;
+            query->maximum = control->maximum;
+            query->step = 1;
+            query->default_value = control->defaultValue;
+            query->flags = (control->isReadOnly? (V4L2_CTRL_FLAG_READ_ONLY | V4L2_CTRL_FLAG_VOLATILE) : 0);
+
+            return 0;
+        }
+        case VIDIOC_G_CTRL:
+        case VIDIOC_S_CTRL:
+        {
+            v4l2_control *const v4lc = (v4l2_control*)arg;
+            mock_control_s *const control = find_control(input, v4lc->id);
+
+            if (!control)
+            {
+                return EINVAL;
+            }
+
+            if (request == VIDIOC_S_CTRL)
+            {
+                if (control->isReadOnly)
+                {
+                    return EACCES;
+                }
+
+                if ((v4lc->value < control->minimum) ||
+                    (v4lc->value > control->maximum))
+                {
+                    return ERANGE;
+                }
+
+                control->value = v4lc->value;
+            }
+
+            v4lc->value = control->value;
+
+            return 0;
+        }
+        case VIDIOC_G_EXT_CTRLS:
+        {
+            v4l2_ext_controls *const query = (v4l2_ext_controls*)arg;
+
+            for (unsigned i = 0; i < query->count; i++)
+            {
+                const mock_control_s *const control = find_control(input, query->controls[i].id);
+
+                if (!control)
+                {
+                    query->error_idx = i;
+                    return EINVAL;
+                }
+
+                query->controls[i].value = control->value;
+            }
+
+            return 0;
+        }
+        case VIDIOC_SUBSCRIBE_EVENT:
+        {
+            const v4l2_event_subscription *const subscription = (const v4l2_event_subscription*)arg;
+
+            if (!CONFIG.areEventsSupported)
+            {
+                return ENOTTY;
+            }
+
+            if (subscription->type == V4L2_EVENT_SOURCE_CHANGE)
+            {
+                file.isSourceChangeSubscribed = true;
+            }
+            else if ((subscription->type == V4L2_EVENT_CTRL) &&
+                     (subscription->id == SIGNAL_TYPE_CONTROL_ID))
+            {
+                file.isSignalSubscribed = true;
+            }
+            else
+            {
+                return EINVAL;
+            }
+
+            return 0;
+        }
+        case VIDIOC_DQEVENT:
+        {
+            v4l2_event *const event = (v4l2_event*)arg;
+
+            if (file.events.empty())
+            {
+                return ENOENT;
+            }
+
+            *event = file.events.front();
+            file.events.pop_front();
+            event->pending = unsigned(file.events.size());
+
+            return 0;
+        }
+        default: return ENOTTY;
+    }
+}
+
+int v4l_open(const char *const path, const int flags)
+{
+    unsigned idx = 0;
+    char trailing = 0;
+
+    if (sscanf(path, "/dev/video%u%c", &idx, &trailing) != 1)
+    {
+        return open(path, flags);
+    }
+
+    std::lock_guard<std::mutex> lock(MUTEX);
+
+    initialize();
+
+    if (idx >= INPUTS.size())
+    {
+        errno = ENOENT;
+        return -1;
+    }
+
+    // A real file descriptor, so that it won't clash with others.
+    const int fd = eventfd(0, EFD_CLOEXEC);
+
+    if (fd < 0)
+    {
+        return -1;
+    }
+
+    OPEN_FILES[fd] = {idx, false, false, {}};
+
+    return fd;
+}
+
+int v4l_close(const int fd)
+{
+    {
+        std::lock_guard<std::mutex> lock(MUTEX);
+
+        const auto file = OPEN_FILES.find(fd);
+
+        if (file != OPEN_FILES.end())
+        {
+            mock_input_s &input = INPUTS.at(file->second.inputIdx);
+
+            if (input.streamingFd == fd)
+            {
+                input.isStreaming = false;
+                input.streamingFd = -1;
+                release_buffers(input);
+            }
+
+            OPEN_FILES.erase(file);
+        }
+    }
+
+    return close(fd);
+}
+
+int v4l_ioctl(const int fd, const unsigned long request, void *const arg)
+{
+    std::lock_guard<std::mutex> lock(MUTEX);
+
+    if (!OPEN_FILES.count(fd))
+    {
+        return ioctl(fd, request, arg);
+    }
+
+    const int error = handle_ioctl(fd, request, arg);
+
+    if (error)
+    {
+        errno = error;
+        return -1;
+    }
+
+    return 0;
+}
+
+void* v4l_mmap(void *const addr, const size_t length, const int prot, const int flags, const int fd, const off_t offset)
+{
+    std::lock_guard<std::mutex> lock(MUTEX);
+
+    const auto file = OPEN_FILES.find(fd);
+
+    if (file == OPEN_FILES.end())
+    {
+        return mmap(addr, length, prot, flags, fd, offset);
+    }
+
+    mock_input_s &input = INPUTS.at(file->second.inputIdx);
+
+    for (auto &buffer: input.buffers)
+    {
+        if ((input.memory == V4L2_MEMORY_MMAP) &&
+            buffer.ptr &&
+            (buffer.offset == offset) &&
+            (buffer.length == length))
+        {
+            buffer.isMapped = true;
+            return buffer.ptr;
+        }
+    }
+
+    errno = EINVAL;
+    return MAP_FAILED;
+}
+
+int v4l_munmap(void *const addr, const size_t length)
+{
+    std::lock_guard<std::mutex> lock(MUTEX);
+
+    // Stop capturing into the memory, whether it's one of our MMAP buffers or
+    // a USERPTR buffer given to us by the application.
+    for (auto &input: INPUTS)
+    {
+        for (auto &buffer: input.buffers)
+        {
+            if (buffer.ptr == addr)
+            {
+                buffer.ptr = nullptr;
+                buffer.isMapped = false;
+            }
+        }
+    }
+
+    return munmap(addr, length);
+}
+
+int v4l_poll(pollfd *const fds, const nfds_t numFds, const int timeoutMs)
+{
+    {
+        std::lock_guard<std::mutex> lock(MUTEX);
+
+        // Polling on several files at once isn't supported for the mock device,
+        // as VCS doesn't need it.
+        if ((numFds != 1) ||
+            !OPEN_FILES.count(fds[0].fd))
+        {
+            return poll(fds, numFds, timeoutMs);
+        }
+    }
+
+    const auto deadline = ((timeoutMs < 0)? std::chrono::steady_clock::time_point::max()
+                                          : (std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs)));
+
+    while (true)
+    {
+        auto wakeTime = deadline;
+        const auto now = std::chrono::steady_clock::now();
+
+        {
+            std::lock_guard<std::mutex> lock(MUTEX);
+
+            const auto file = OPEN_FILES.find(fds[0].fd);
+
+            if (file == OPEN_FILES.end())
+            {
+                fds[0].revents = POLLNVAL;
+                return 1;
+            }
+
+            const mock_input_s &input = INPUTS.at(file->second.inputIdx);
+
+            advance(file->second.inputIdx, now);
+
+            fds[0].revents = 0;
+
+            if ((fds[0].events & POLLPRI) &&
+                !file->second.events.empty())
+            {
+                fds[0].revents |= POLLPRI;
+            }
+
+            if ((fds[0].events & POLLIN) &&
+                !input.done.empty())
+            {
+                fds[0].revents |= POLLIN;
+            }
+
+            if (fds[0].revents)
+            {
+                return 1;
+            }
+
+            if (input.isStreaming &&
+                input.hasSignal)
+            {
+                wakeTime = std::min(wakeTime, input.nextFrameTime);
+            }
+
+            wakeTime = std::min(wakeTime, next_source_change_after(now));
+        }
+
+        if (now >= deadline)
+        {
+            return 0;
+        }
+
+        std::this_thread::sleep_until(wakeTime);
+    }
+}
+
+std::vector<unsigned> v4l_mock_device_indices(void)
+{
+    std::lock_guard<std::mutex> lock(MUTEX);
+
+    initialize();
+
+    std::vector<unsigned> indices;
+
+    for (unsigned i = 0; i < INPUTS.size(); i++)
+    {
+        indices.push_back(i);
+    }
+
+    return indices;
+}
+
+#endif
+#endif
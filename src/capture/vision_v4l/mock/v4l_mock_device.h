@@ -0,0 +1,72 @@
+/*
+ * 2021 Tarpeeksi Hyvae Soft
+ *
+ * Software: VCS
+ *
+ * An emulated Vision capture card, for running the Vision/V4L capture code
+ * without the capture hardware or Datapath's driver. Included in builds with
+ * MOCK_V4L_DEVICE defined (see vcs.pro), in which the capture code's calls on
+ * /dev/videoX nodes are routed here via v4l_device_io.h.
+ *
+ * The card's inputs appear as /dev/video0, /dev/video1, etc. They implement the
+ * parts of the V4L2 API that VCS uses -- MMAP and USERPTR streaming, cropping,
+ * control and source change events, controls -- plus the Vision driver's
+ * RGB133_VIDIOC_G_SRC_FMT. While an input is streaming, it fills the queued
+ * buffers at the source's refresh rate with a test pattern, and like a real
+ * device drops frames for which no buffer is queued, leaving a gap in the buffer
+ * sequence.
+ *
+ * The source feeding the inputs is configured via environment variables:
+ *
+ *   VCS_MOCK_V4L_INPUTS
+ *       The number of inputs on the card. Default: 2.
+ *
+ *   VCS_MOCK_V4L_MODES
+ *       A comma-separated list of video modes, in the form WxH@Hz; e.g.
+ *       "640x480@60,720x400@70.086". Default: "640x480@60".
+ *
+ *   VCS_MOCK_V4L_MODE_INTERVAL_MS
+ *       How often the source switches to the next of the video modes. 0 means
+ *       it never does. Default: 0.
+ *
+ *   VCS_MOCK_V4L_SIGNAL_LOSS_INTERVAL_MS
+ *       How often the source loses its signal. 0 means it never does. Default: 0.
+ *
+ *   VCS_MOCK_V4L_SIGNAL_LOSS_DURATION_MS
+ *       How long each loss of signal lasts. Default: 1000.
+ *
+ *   VCS_MOCK_V4L_MAX_BUFFERS
+ *       The largest number of back buffers an input provides. Default: 32.
+ *
+ *   VCS_MOCK_V4L_EVENTS
+ *       Set to 0 to have the inputs refuse event subscriptions, so that VCS
+ *       polls them for signal and mode changes instead. Default: 1.
+ *
+ */
+
+#ifdef CAPTURE_DEVICE_VISION_V4L
+#ifdef MOCK_V4L_DEVICE
+
+#ifndef VCS_CAPTURE_VISION_V4L_MOCK_V4L_MOCK_DEVICE_H
+#define VCS_CAPTURE_VISION_V4L_MOCK_V4L_MOCK_DEVICE_H
+
+#include <vector>
+#include <poll.h>
+#include <sys/types.h>
+
+// Drop-in replacements for the corresponding system calls. Calls on files other
+// than the mock device's are passed on to the system.
+int v4l_open(const char *const path, const int flags);
+int v4l_close(const int fd);
+int v4l_ioctl(const int fd, const unsigned long request, void *const arg);
+void* v4l_mmap(void *const addr, const size_t length, const int prot, const int flags, const int fd, const off_t offset);
+int v4l_munmap(void *const addr, const size_t length);
+int v4l_poll(pollfd *const fds, const nfds_t numFds, const int timeoutMs);
+
+// Returns the indices (the X in /dev/videoX) of the mock device's inputs.
+std::vector<unsigned> v4l_mock_device_indices(void);
+
+#endif
+
+#endif
+#endif
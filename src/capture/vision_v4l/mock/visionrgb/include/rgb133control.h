@@ -0,0 +1,15 @@
+/*
+ * 2021 Tarpeeksi Hyvae Soft
+ *
+ * Software: VCS
+ *
+ * Stands in for Datapath's Vision driver header of the same name when building
+ * against the mock Vision device (see ../../v4l_mock_device.h). VCS uses none
+ * of its definitions directly.
+ *
+ */
+
+#ifndef VCS_CAPTURE_VISION_V4L_MOCK_VISIONRGB_RGB133CONTROL_H
+#define VCS_CAPTURE_VISION_V4L_MOCK_VISIONRGB_RGB133CONTROL_H
+
+#endif
@@ -0,0 +1,28 @@
+/*
+ * 2021 Tarpeeksi Hyvae Soft
+ *
+ * Software: VCS
+ *
+ * Stand-ins for the definitions VCS uses from Datapath's Vision driver header
+ * of the same name, for building against the mock Vision device (see
+ * ../../v4l_mock_device.h) without the driver. The values needn't match the
+ * driver's, as only the mock device interprets them.
+ *
+ */
+
+#ifndef VCS_CAPTURE_VISION_V4L_MOCK_VISIONRGB_RGB133V4L2_H
+#define VCS_CAPTURE_VISION_V4L_MOCK_VISIONRGB_RGB133V4L2_H
+
+#include <linux/videodev2.h>
+
+// The buffer type for querying the format of the input signal.
+#define V4L2_BUF_TYPE_CAPTURE_SOURCE ((v4l2_buf_type)0x80)
+
+// Reports the input signal's resolution in fmt.pix.width and fmt.pix.height,
+// and its refresh rate in millihertz in fmt.pix.priv.
+#define RGB133_VIDIOC_G_SRC_FMT _IOWR('V', (BASE_VIDIOC_PRIVATE + 1), struct v4l2_format)
+
+// One past the last of the driver's private control IDs.
+#define V4L2_CID_PRIVATE_LASTP1 (V4L2_CID_PRIVATE_BASE + 0x20)
+
+#endif
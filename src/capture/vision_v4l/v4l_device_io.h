@@ -0,0 +1,64 @@
+/*
+ * 2021 Tarpeeksi Hyvae Soft
+ *
+ * Software: VCS
+ *
+ * The system calls through which the Vision/V4L capture code accesses capture
+ * devices.
+ *
+ * In normal builds, these are simply the system's own calls. In builds with
+ * MOCK_V4L_DEVICE defined (see vcs.pro), calls on /dev/videoX nodes are instead
+ * served by an emulated Vision capture card (see mock/v4l_mock_device.h), so
+ * that the capture code can be run and profiled without the capture hardware.
+ * Calls on other files are passed on to the system in either case.
+ *
+ */
+
+#ifdef CAPTURE_DEVICE_VISION_V4L
+
+#ifndef VCS_CAPTURE_VISION_V4L_V4L_DEVICE_IO_H
+#define VCS_CAPTURE_VISION_V4L_V4L_DEVICE_IO_H
+
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
+
+#ifdef MOCK_V4L_DEVICE
+    #include "capture/vision_v4l/mock/v4l_mock_device.h"
+#else
+    inline int v4l_open(const char *const path, const int flags)
+    {
+        return open(path, flags);
+    }
+
+    inline int v4l_close(const int fd)
+    {
+        return close(fd);
+    }
+
+    inline int v4l_ioctl(const int fd, const unsigned long request, void *const arg)
+    {
+        return ioctl(fd, request, arg);
+    }
+
+    inline void* v4l_mmap(void *const addr, const size_t length, const int prot, const int flags, const int fd, const off_t offset)
+    {
+        return mmap(addr, length, prot, flags, fd, offset);
+    }
+
+    inline int v4l_munmap(void *const addr, const size_t length)
+    {
+        return munmap(addr, length);
+    }
+
+    inline int v4l_poll(pollfd *const fds, const nfds_t numFds, const int timeoutMs)
+    {
+        return poll(fds, numFds, timeoutMs);
+    }
+#endif
+
+#endif
+
+#endif
@@ -0,0 +1,244 @@
+/*
+ * 2021 Tarpeeksi Hyvae Soft
+ *
+ * Software: VCS
+ *
+ */
+
+#ifdef CAPTURE_DEVICE_VISION_V4L
+
+#include <sys/inotify.h>
+#include <sys/ioctl.h>
+#include <linux/videodev2.h>
+#include <dirent.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <climits>
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+#include <future>
+#include <vector>
+#include "capture/vision_v4l/v4l_device_registry.h"
+#include "capture/vision_v4l/v4l_device_io.h"
+#include "common/globals.h"
+
+void v4l_device_registry_c::initialize(void)
+{
+    this->inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+
+    if ((this->inotifyFd >= 0) &&
+        (inotify_add_watch(this->inotifyFd, "/dev", (IN_CREATE | IN_DELETE | IN_ATTRIB)) < 0))
+    {
+        close(this->inotifyFd);
+        this->inotifyFd = -1;
+    }
+
+    if (this->inotifyFd < 0)
+    {
+        DEBUG(("Can't watch /dev for capture devices (error %d). Re-scanning it when needed instead.", errno));
+    }
+
+    this->probe_all();
+
+    return;
+}
+
+void v4l_device_registry_c::release(void)
+{
+    if (this->inotifyFd >= 0)
+    {
+        close(this->inotifyFd);
+        this->inotifyFd = -1;
+    }
+
+    this->devices.clear();
+
+    return;
+}
+
+void v4l_device_registry_c::update(void)
+{
+    if (this->inotifyFd < 0)
+    {
+        this->probe_all();
+        return;
+    }
+
+    alignas(inotify_event) char buffer[4096];
+    ssize_t numBytesRead = 0;
+
+    while ((numBytesRead = read(this->inotifyFd, buffer, sizeof(buffer))) > 0)
+    {
+        for (ssize_t i = 0; i < numBytesRead;)
+        {
+            const inotify_event *const event = (const inotify_event*)(buffer + i);
+            unsigned deviceIdx = 0;
+
+            i += (sizeof(inotify_event) + event->len);
+
+            // We've missed some events, so can't know what changed.
+            if (event->mask & IN_Q_OVERFLOW)
+            {
+                this->probe_all();
+                continue;
+            }
+
+            if (!event->len ||
+                !v4l_device_registry_c::parse_device_file_name(event->name, &deviceIdx))
+            {
+                continue;
+            }
+
+            // Note: A newly-created device node may not be accessible until udev
+            // has adjusted its permissions, so we also re-probe it on IN_ATTRIB.
+            device_s device;
+            if (!(event->mask & IN_DELETE) &&
+                v4l_device_registry_c::probe(deviceIdx, &device))
+            {
+                this->devices[deviceIdx] = device;
+            }
+            else
+            {
+                this->devices.erase(deviceIdx);
+            }
+        }
+    }
+
+    return;
+}
+
+unsigned v4l_device_registry_c::num_inputs_on_card_of(const unsigned deviceIdx) const
+{
+    const auto inputDevice = this->devices.find(deviceIdx);
+
+    if (inputDevice == this->devices.end())
+    {
+        return unsigned(this->devices.size());
+    }
+
+    unsigned numInputs = 0;
+
+    for (const auto &device: this->devices)
+    {
+        if (device.second.busInfo == inputDevice->second.busInfo)
+        {
+            numInputs++;
+        }
+    }
+
+    return numInputs;
+}
+
+void v4l_device_registry_c::probe_all(void)
+{
+    std::vector<unsigned> deviceIdxs;
+
+    // Find the /dev/videoX nodes.
+    #ifdef MOCK_V4L_DEVICE
+        deviceIdxs = v4l_mock_device_indices();
+    #else
+        DIR *const dir = opendir("/dev");
+
+        if (!dir)
+        {
+            NBENE(("Failed to list the contents of /dev (error %d).", errno));
+            return;
+        }
+
+        while (const dirent *const entry = readdir(dir))
+        {
+            unsigned deviceIdx = 0;
+
+            if (v4l_device_registry_c::parse_device_file_name(entry->d_name, &deviceIdx))
+            {
+                deviceIdxs.push_back(deviceIdx);
+            }
+        }
+
+        closedir(dir);
+    #endif
+
+    // Probe the nodes in parallel, since some drivers are slow to respond.
+    std::vector<std::future<bool>> probes;
+    std::vector<device_s> probedDevices(deviceIdxs.size());
+
+    for (unsigned i = 0; i < deviceIdxs.size(); i++)
+    {
+        probes.push_back(std::async(std::launch::async, &v4l_device_registry_c::probe, deviceIdxs[i], &probedDevices[i]));
+    }
+
+    this->devices.clear();
+
+    for (unsigned i = 0; i < probes.size(); i++)
+    {
+        if (probes[i].get())
+        {
+            this->devices[probedDevices[i].idx] = probedDevices[i];
+        }
+    }
+
+    return;
+}
+
+bool v4l_device_registry_c::probe(const unsigned idx, device_s *const device)
+{
+    v4l2_capability caps = {};
+
+    const int deviceFile = v4l_open(("/dev/video" + std::to_string(idx)).c_str(), (O_RDONLY | O_NONBLOCK | O_CLOEXEC));
+
+    if (deviceFile < 0)
+    {
+        return false;
+    }
+
+    const bool isQueried = (v4l_ioctl(deviceFile, VIDIOC_QUERYCAP, &caps) >= 0);
+
+    v4l_close(deviceFile);
+
+    if (!isQueried)
+    {
+        return false;
+    }
+
+    const bool usesVisionDriver = (strcmp((const char*)caps.driver, "Vision") == 0);
+    const bool isVisionControlDevice = (strcmp((const char*)caps.card, "Vision Control") == 0);
+
+    if (!usesVisionDriver ||
+        isVisionControlDevice)
+    {
+        return false;
+    }
+
+    device->idx = idx;
+    device->card = (const char*)caps.card;
+    device->busInfo = (const char*)caps.bus_info;
+
+    return true;
+}
+
+bool v4l_device_registry_c::parse_device_file_name(const char *const fileName, unsigned *const idx)
+{
+    static const char prefix[] = "video";
+
+    if ((strncmp(fileName, prefix, (sizeof(prefix) - 1)) != 0) ||
+        !isdigit((unsigned char)fileName[sizeof(prefix) - 1]))
+    {
+        return false;
+    }
+
+    char *end = nullptr;
+    const unsigned long value = strtoul((fileName + sizeof(prefix) - 1), &end, 10);
+
+    if ((*end != '\0') ||
+        (value > UINT_MAX))
+    {
+        return false;
+    }
+
+    *idx = unsigned(value);
+
+    return true;
+}
+
+#endif
@@ -0,0 +1,89 @@
+/*
+ * 2021 Tarpeeksi Hyvae Soft
+ *
+ * Software: VCS
+ *
+ * Keeps track of the Vision capture devices (/dev/videoX nodes) present on the
+ * system. The nodes are probed once up front, after which the registry follows
+ * their appearance and removal via inotify on /dev, re-probing only the nodes
+ * that changed.
+ *
+ * Usage:
+ *
+ *   1. Initialize the registry (probes the current nodes):
+ *
+ *      v4l_device_registry_c registry;
+ *      registry.initialize();
+ *
+ *   2. Before querying the registry, have it catch up on device changes:
+ *
+ *      registry.update();
+ *      const unsigned numInputs = registry.num_inputs_on_card_of(0);
+ *
+ *   3. Release the registry when done:
+ *
+ *      registry.release();
+ *
+ */
+
+#ifdef CAPTURE_DEVICE_VISION_V4L
+
+#ifndef VCS_CAPTURE_V4L_DEVICE_REGISTRY_H
+#define VCS_CAPTURE_V4L_DEVICE_REGISTRY_H
+
+#include <string>
+#include <map>
+
+class v4l_device_registry_c
+{
+public:
+    // What we know of a Vision capture input (/dev/videoX node).
+    struct device_s
+    {
+        // The X in /dev/videoX.
+        unsigned idx;
+
+        // As reported by VIDIOC_QUERYCAP.
+        std::string card;
+        std::string busInfo;
+    };
+
+    // Probes all /dev/videoX nodes currently present and starts watching /dev
+    // for changes to them. If /dev can't be watched, the registry instead
+    // re-probes everything on each update().
+    void initialize(void);
+
+    void release(void);
+
+    // Brings the registry up to date with the devices added to or removed from
+    // the system since the previous call. Doesn't block.
+    void update(void);
+
+    // Returns the number of Vision capture inputs on the same capture card as
+    // the given /dev/videoX input, or on all Vision cards if the given input
+    // isn't known.
+    unsigned num_inputs_on_card_of(const unsigned deviceIdx) const;
+
+private:
+    // Probes all /dev/videoX nodes currently present, in parallel, replacing
+    // the registry's contents.
+    void probe_all(void);
+
+    // Returns true and fills in the given device's details if /dev/video<idx>
+    // is a Vision capture input; false otherwise.
+    static bool probe(const unsigned idx, device_s *const device);
+
+    // Returns true and sets *idx to X if the given file name is of the form
+    // videoX; false otherwise.
+    static bool parse_device_file_name(const char *const fileName, unsigned *const idx);
+
+    // The Vision capture inputs currently present, keyed by their device index.
+    std::map<unsigned, device_s> devices;
+
+    // File descriptor of the inotify instance watching /dev, or -1 if none.
+    int inotifyFd = -1;
+};
+
+#endif
+
+#endif
@@ -5,6 +5,12 @@
  */
 
 #include <unistd.h>
+#include <getopt.h>
+#include <cstring>
+#include <algorithm>
+#include "capture/captured_frame_ring.h"
+#include "capture/capture_thread.h"
+#include "capture/virtual/test_pattern.h"
 #include "common/globals.h"
 
 /*
@@ -17,6 +23,12 @@
 // Which input channel on the capture hardware we want to receive frames from.
 unsigned INPUT_CHANNEL_IDX = 0;
 
+// Input channels to capture from concurrently with the current one. 0-indexed.
+static std::vector<unsigned> CONCURRENT_INPUT_CHANNELS;
+
+// Input channels to keep on standby for quick switching to. 0-indexed.
+static std::vector<unsigned> STANDBY_INPUT_CHANNELS;
+
 // How many frames the capture card should drop between captures.
 unsigned FRAME_SKIP = 0;
 
@@ -32,6 +44,100 @@ static std::string ALIAS_FILE_NAME = "";
 // Name of (and path to) the filter set file on disk.
 static std::string FILTER_GRAPH_FILE_NAME = "";
 
+// How many captured frames the capture subsystem can hold for VCS to process,
+// and what to do when a new frame arrives while they're all in use.
+static unsigned FRAME_QUEUE_SIZE = 3;
+static captured_frame_ring_c::overflow_policy_e FRAME_QUEUE_OVERFLOW_POLICY = captured_frame_ring_c::overflow_policy_e::keep_newest;
+
+// Whether the capture subsystem should hand VCS its captured frames straight
+// from the capture device's memory rather than copying them out first.
+static bool ZERO_COPY_CAPTURE = false;
+
+// The kind of memory we'd prefer the capture device to deliver captured frames
+// into.
+static capture_memory_e CAPTURE_MEMORY = capture_memory_e::mmap;
+
+// Whether the capture subsystem should convert captured frames into BGRA as it
+// copies them out of the capture device's memory.
+static bool CONVERT_ON_CAPTURE = false;
+
+// Whether the capture subsystem should skip captured frames that have been
+// superseded by newer ones by the time it gets to them.
+static bool DRAIN_TO_NEWEST = false;
+
+// Whether the capture device should be asked to scale captured frames down to
+// the output resolution, rather than VCS scaling them.
+static bool HARDWARE_SCALING = false;
+
+// How capture threads should be scheduled. A negative CPU index means the
+// thread isn't pinned to a CPU, and a negative priority that the scheduling
+// policy's lowest priority is used.
+static int CAPTURE_THREAD_CPU = -1;
+static capture_thread_scheduling_e CAPTURE_THREAD_SCHEDULING = capture_thread_scheduling_e::standard;
+static int CAPTURE_THREAD_PRIORITY = -1;
+
+// Whether capture buffers should be locked into RAM.
+static bool LOCK_CAPTURE_MEMORY = false;
+
+// Which of the capture thread settings were given on the command line, in which
+// case they take precedence over those in the ini file.
+static bool IS_CAPTURE_THREAD_CPU_GIVEN = false;
+static bool IS_CAPTURE_THREAD_SCHEDULING_GIVEN = false;
+static bool IS_CAPTURE_THREAD_PRIORITY_GIVEN = false;
+static bool IS_LOCK_CAPTURE_MEMORY_GIVEN = false;
+
+// What the capture subsystem should do with frames identical to the previous
+// frame.
+static duplicate_frame_handling_e DUPLICATE_FRAME_HANDLING = duplicate_frame_handling_e::none;
+
+// The rate (in Hz) to which the capture subsystem should cap its captured
+// frames; or 0 for no cap.
+static double FRAME_RATE_LIMIT = 0;
+
+// The video mode, pixel format, and test pattern of the virtual capture
+// device's frames; and how often, in milliseconds, the device should switch to
+// another video mode, or 0 for never.
+static resolution_s VIRTUAL_RESOLUTION = {640, 480, 32};
+static double VIRTUAL_REFRESH_RATE = 60;
+static capture_pixel_format_e VIRTUAL_PIXEL_FORMAT = capture_pixel_format_e::rgb_888;
+static test_pattern_e VIRTUAL_PATTERN = test_pattern_e::scroll;
+static unsigned VIRTUAL_MODE_STORM_INTERVAL = 0;
+
+// The frame dump file the replay capture device replays; whether it replays the
+// frames as fast as VCS can process them rather than at their original timing;
+// and whether it starts over from the first frame once it reaches the end.
+static std::string REPLAY_FILE_NAME = "";
+static bool REPLAY_AS_FAST_AS_POSSIBLE = false;
+static bool REPLAY_LOOP = false;
+
+// Identifiers for command-line options that only have a long form.
+enum
+{
+    OPT_FRAME_QUEUE_SIZE = 256,
+    OPT_FRAME_QUEUE_OVERFLOW,
+    OPT_ZERO_COPY_CAPTURE,
+    OPT_CAPTURE_MEMORY,
+    OPT_CONVERT_ON_CAPTURE,
+    OPT_CAPTURE_THREAD_CPU,
+    OPT_CAPTURE_THREAD_SCHEDULING,
+    OPT_CAPTURE_THREAD_PRIORITY,
+    OPT_LOCK_CAPTURE_MEMORY,
+    OPT_NO_LOCK_CAPTURE_MEMORY,
+    OPT_CONCURRENT_INPUT,
+    OPT_DUPLICATE_FRAMES,
+    OPT_STANDBY_INPUT,
+    OPT_DRAIN_TO_NEWEST,
+    OPT_HARDWARE_SCALING,
+    OPT_FRAME_RATE_LIMIT,
+    OPT_VIRTUAL_MODE,
+    OPT_VIRTUAL_PIXEL_FORMAT,
+    OPT_VIRTUAL_PATTERN,
+    OPT_VIRTUAL_MODE_STORM,
+    OPT_REPLAY_FILE,
+    OPT_REPLAY_TIMING,
+    OPT_REPLAY_LOOP,
+};
+
 bool kcom_parse_command_line(const int argc, char *const argv[])
 {
     const char parseFailMsg[] = "VCS has to exit because it found unexpected values "
@@ -40,8 +146,36 @@ bool kcom_parse_command_line(const int argc, char *const argv[])
                                 "console window was not already open, run VCS "
                                 "again from the command line.";
 
+    static const option longOptions[] =
+    {
+        {"frame-queue-size",          required_argument, nullptr, OPT_FRAME_QUEUE_SIZE},
+        {"frame-queue-overflow",      required_argument, nullptr, OPT_FRAME_QUEUE_OVERFLOW},
+        {"zero-copy-capture",         no_argument,       nullptr, OPT_ZERO_COPY_CAPTURE},
+        {"capture-memory",            required_argument, nullptr, OPT_CAPTURE_MEMORY},
+        {"convert-on-capture",        no_argument,       nullptr, OPT_CONVERT_ON_CAPTURE},
+        {"capture-thread-cpu",        required_argument, nullptr, OPT_CAPTURE_THREAD_CPU},
+        {"capture-thread-scheduling", required_argument, nullptr, OPT_CAPTURE_THREAD_SCHEDULING},
+        {"capture-thread-priority",   required_argument, nullptr, OPT_CAPTURE_THREAD_PRIORITY},
+        {"lock-capture-memory",       no_argument,       nullptr, OPT_LOCK_CAPTURE_MEMORY},
+        {"no-lock-capture-memory",    no_argument,       nullptr, OPT_NO_LOCK_CAPTURE_MEMORY},
+        {"concurrent-input",          required_argument, nullptr, OPT_CONCURRENT_INPUT},
+        {"duplicate-frames",          required_argument, nullptr, OPT_DUPLICATE_FRAMES},
+        {"standby-input",             required_argument, nullptr, OPT_STANDBY_INPUT},
+        {"drain-to-newest",           no_argument,       nullptr, OPT_DRAIN_TO_NEWEST},
+        {"hardware-scaling",          no_argument,       nullptr, OPT_HARDWARE_SCALING},
+        {"frame-rate-limit",          required_argument, nullptr, OPT_FRAME_RATE_LIMIT},
+        {"virtual-mode",              required_argument, nullptr, OPT_VIRTUAL_MODE},
+        {"virtual-pixel-format",      required_argument, nullptr, OPT_VIRTUAL_PIXEL_FORMAT},
+        {"virtual-pattern",           required_argument, nullptr, OPT_VIRTUAL_PATTERN},
+        {"virtual-mode-storm",        required_argument, nullptr, OPT_VIRTUAL_MODE_STORM},
+        {"replay-file",               required_argument, nullptr, OPT_REPLAY_FILE},
+        {"replay-timing",             required_argument, nullptr, OPT_REPLAY_TIMING},
+        {"replay-loop",               no_argument,       nullptr, OPT_REPLAY_LOOP},
+        {nullptr,                     0,                 nullptr, 0},
+    };
+
     int c = 0;
-    while ((c = getopt(argc, argv, "i:m:v:a:f:")) != -1)
+    while ((c = getopt_long(argc, argv, "i:m:v:a:f:", longOptions, nullptr)) != -1)
     {
         switch (c)
         {
@@ -108,6 +242,435 @@ bool kcom_parse_command_line(const int argc, char *const argv[])
                 FILTER_GRAPH_FILE_NAME = optarg;
                 break;
             }
+            case OPT_FRAME_QUEUE_SIZE:
+            {
+                const int minSize = 1;
+                const int maxSize = captured_frame_ring_c::maxNumSlots;
+
+                const int size = strtol(optarg, NULL, 10);
+
+                if ((size < minSize) ||
+                    (size > maxSize))
+                {
+                    NBENE(("Frame queue size (--frame-queue-size) is out of bounds. Expected range: %d-%d.",
+                           minSize, maxSize));
+
+                    kd_show_headless_error_message("", parseFailMsg);
+
+                    return false;
+                }
+
+                FRAME_QUEUE_SIZE = unsigned(size);
+
+                break;
+            }
+            case OPT_FRAME_QUEUE_OVERFLOW:
+            {
+                if (strcmp(optarg, "newest") == 0)
+                {
+                    FRAME_QUEUE_OVERFLOW_POLICY = captured_frame_ring_c::overflow_policy_e::keep_newest;
+                }
+                else if (strcmp(optarg, "oldest") == 0)
+                {
+                    FRAME_QUEUE_OVERFLOW_POLICY = captured_frame_ring_c::overflow_policy_e::keep_oldest;
+                }
+                else
+                {
+                    NBENE(("Unrecognized frame queue overflow policy (--frame-queue-overflow). "
+                           "Expected \"newest\" or \"oldest\"."));
+
+                    kd_show_headless_error_message("", parseFailMsg);
+
+                    return false;
+                }
+
+                break;
+            }
+            case OPT_ZERO_COPY_CAPTURE:
+            {
+                ZERO_COPY_CAPTURE = true;
+                break;
+            }
+            case OPT_DRAIN_TO_NEWEST:
+            {
+                DRAIN_TO_NEWEST = true;
+                break;
+            }
+            case OPT_HARDWARE_SCALING:
+            {
+                HARDWARE_SCALING = true;
+                break;
+            }
+            case OPT_CAPTURE_MEMORY:
+            {
+                if (strcmp(optarg, "dmabuf") == 0)
+                {
+                    CAPTURE_MEMORY = capture_memory_e::dmabuf;
+                }
+                else if (strcmp(optarg, "userptr") == 0)
+                {
+                    CAPTURE_MEMORY = capture_memory_e::userptr;
+                }
+                else if (strcmp(optarg, "mmap") == 0)
+                {
+                    CAPTURE_MEMORY = capture_memory_e::mmap;
+                }
+                else
+                {
+                    NBENE(("Unrecognized capture memory type (--capture-memory). "
+                           "Expected \"dmabuf\", \"userptr\", or \"mmap\"."));
+
+                    kd_show_headless_error_message("", parseFailMsg);
+
+                    return false;
+                }
+
+                break;
+            }
+            case OPT_CONVERT_ON_CAPTURE:
+            {
+                CONVERT_ON_CAPTURE = true;
+                break;
+            }
+            case OPT_CAPTURE_THREAD_CPU:
+            {
+                const int minIdx = 0;
+                const int maxIdx = 1023;
+
+                char *end = nullptr;
+                const int idx = strtol(optarg, &end, 10);
+
+                if ((end == optarg) ||
+                    (idx < minIdx) ||
+                    (idx > maxIdx))
+                {
+                    NBENE(("Capture thread CPU index (--capture-thread-cpu) is out of bounds. Expected range: %d-%d.",
+                           minIdx, maxIdx));
+
+                    kd_show_headless_error_message("", parseFailMsg);
+
+                    return false;
+                }
+
+                CAPTURE_THREAD_CPU = idx;
+                IS_CAPTURE_THREAD_CPU_GIVEN = true;
+
+                break;
+            }
+            case OPT_CAPTURE_THREAD_SCHEDULING:
+            {
+                if (strcmp(optarg, "standard") == 0)
+                {
+                    CAPTURE_THREAD_SCHEDULING = capture_thread_scheduling_e::standard;
+                }
+                else if (strcmp(optarg, "fifo") == 0)
+                {
+                    CAPTURE_THREAD_SCHEDULING = capture_thread_scheduling_e::fifo;
+                }
+                else if (strcmp(optarg, "rr") == 0)
+                {
+                    CAPTURE_THREAD_SCHEDULING = capture_thread_scheduling_e::round_robin;
+                }
+                else
+                {
+                    NBENE(("Unrecognized capture thread scheduling policy (--capture-thread-scheduling). "
+                           "Expected \"standard\", \"fifo\" or \"rr\"."));
+
+                    kd_show_headless_error_message("", parseFailMsg);
+
+                    return false;
+                }
+
+                IS_CAPTURE_THREAD_SCHEDULING_GIVEN = true;
+
+                break;
+            }
+            case OPT_CAPTURE_THREAD_PRIORITY:
+            {
+                const int minPriority = 1;
+                const int maxPriority = 99;
+
+                const int priority = strtol(optarg, NULL, 10);
+
+                if ((priority < minPriority) ||
+                    (priority > maxPriority))
+                {
+                    NBENE(("Capture thread priority (--capture-thread-priority) is out of bounds. Expected range: %d-%d.",
+                           minPriority, maxPriority));
+
+                    kd_show_headless_error_message("", parseFailMsg);
+
+                    return false;
+                }
+
+                CAPTURE_THREAD_PRIORITY = priority;
+                IS_CAPTURE_THREAD_PRIORITY_GIVEN = true;
+
+                break;
+            }
+            case OPT_LOCK_CAPTURE_MEMORY:
+            {
+                LOCK_CAPTURE_MEMORY = true;
+                IS_LOCK_CAPTURE_MEMORY_GIVEN = true;
+                break;
+            }
+            case OPT_NO_LOCK_CAPTURE_MEMORY:
+            {
+                LOCK_CAPTURE_MEMORY = false;
+                IS_LOCK_CAPTURE_MEMORY_GIVEN = true;
+                break;
+            }
+            case OPT_CONCURRENT_INPUT:
+            {
+                const unsigned minChannelIdx = 1;    // Values must be 1-indexed.
+                const unsigned maxChannelIdx = 8192; // Sanity check.
+
+                const unsigned channelIdx = strtol(optarg, NULL, 10);
+
+                if ((channelIdx < minChannelIdx) ||
+                    (channelIdx > maxChannelIdx))
+                {
+                    NBENE(("Concurrent input channel index (--concurrent-input) is out of bounds. Expected range: %u-%u.",
+                           minChannelIdx, maxChannelIdx));
+
+                    kd_show_headless_error_message("", parseFailMsg);
+
+                    return false;
+                }
+
+                // VCS expects the channel index to be 0-indexed, so let's convert.
+                if (std::find(CONCURRENT_INPUT_CHANNELS.begin(),
+                              CONCURRENT_INPUT_CHANNELS.end(),
+                              (channelIdx - 1)) == CONCURRENT_INPUT_CHANNELS.end())
+                {
+                    CONCURRENT_INPUT_CHANNELS.push_back(channelIdx - 1);
+                }
+
+                break;
+            }
+            case OPT_STANDBY_INPUT:
+            {
+                const unsigned minChannelIdx = 1;    // Values must be 1-indexed.
+                const unsigned maxChannelIdx = 8192; // Sanity check.
+
+                const unsigned channelIdx = strtol(optarg, NULL, 10);
+
+                if ((channelIdx < minChannelIdx) ||
+                    (channelIdx > maxChannelIdx))
+                {
+                    NBENE(("Standby input channel index (--standby-input) is out of bounds. Expected range: %u-%u.",
+                           minChannelIdx, maxChannelIdx));
+
+                    kd_show_headless_error_message("", parseFailMsg);
+
+                    return false;
+                }
+
+                // VCS expects the channel index to be 0-indexed, so let's convert.
+                if (std::find(STANDBY_INPUT_CHANNELS.begin(),
+                              STANDBY_INPUT_CHANNELS.end(),
+                              (channelIdx - 1)) == STANDBY_INPUT_CHANNELS.end())
+                {
+                    STANDBY_INPUT_CHANNELS.push_back(channelIdx - 1);
+                }
+
+                break;
+            }
+            case OPT_DUPLICATE_FRAMES:
+            {
+                if (strcmp(optarg, "keep") == 0)
+                {
+                    DUPLICATE_FRAME_HANDLING = duplicate_frame_handling_e::none;
+                }
+                else if (strcmp(optarg, "flag") == 0)
+                {
+                    DUPLICATE_FRAME_HANDLING = duplicate_frame_handling_e::flag;
+                }
+                else if (strcmp(optarg, "drop") == 0)
+                {
+                    DUPLICATE_FRAME_HANDLING = duplicate_frame_handling_e::drop;
+                }
+                else
+                {
+                    NBENE(("Unrecognized duplicate frame handling (--duplicate-frames). "
+                           "Expected \"keep\", \"flag\", or \"drop\"."));
+
+                    kd_show_headless_error_message("", parseFailMsg);
+
+                    return false;
+                }
+
+                break;
+            }
+            case OPT_FRAME_RATE_LIMIT:
+            {
+                const double minRate = 1;
+                const double maxRate = 1000;
+
+                char *end = nullptr;
+                const double rate = strtod(optarg, &end);
+
+                if ((end == optarg) ||
+                    (rate < minRate) ||
+                    (rate > maxRate))
+                {
+                    NBENE(("Frame rate limit (--frame-rate-limit) is out of bounds. Expected range: %g-%g.",
+                           minRate, maxRate));
+
+                    kd_show_headless_error_message("", parseFailMsg);
+
+                    return false;
+                }
+
+                FRAME_RATE_LIMIT = rate;
+
+                break;
+            }
+            case OPT_VIRTUAL_MODE:
+            {
+                const double maxRate = 1000;
+
+                unsigned width = 0;
+                unsigned height = 0;
+                double rate = 0;
+
+                if ((sscanf(optarg, "%ux%u@%lf", &width, &height, &rate) != 3) ||
+                    (width < MIN_CAPTURE_WIDTH) ||
+                    (width > MAX_CAPTURE_WIDTH) ||
+                    (height < MIN_CAPTURE_HEIGHT) ||
+                    (height > MAX_CAPTURE_HEIGHT) ||
+                    (rate <= 0) ||
+                    (rate > maxRate))
+                {
+                    NBENE(("Malformed or out-of-bounds virtual video mode (--virtual-mode). Expected "
+                           "<width>x<height>@<Hz> of at most %ux%u@%g.",
+                           MAX_CAPTURE_WIDTH, MAX_CAPTURE_HEIGHT, maxRate));
+
+                    kd_show_headless_error_message("", parseFailMsg);
+
+                    return false;
+                }
+
+                VIRTUAL_RESOLUTION = {width, height, VIRTUAL_RESOLUTION.bpp};
+                VIRTUAL_REFRESH_RATE = rate;
+
+                break;
+            }
+            case OPT_VIRTUAL_PIXEL_FORMAT:
+            {
+                if (strcmp(optarg, "rgb888") == 0)
+                {
+                    VIRTUAL_PIXEL_FORMAT = capture_pixel_format_e::rgb_888;
+                    VIRTUAL_RESOLUTION.bpp = 32;
+                }
+                else if (strcmp(optarg, "rgb565") == 0)
+                {
+                    VIRTUAL_PIXEL_FORMAT = capture_pixel_format_e::rgb_565;
+                    VIRTUAL_RESOLUTION.bpp = 16;
+                }
+                else if (strcmp(optarg, "rgb555") == 0)
+                {
+                    VIRTUAL_PIXEL_FORMAT = capture_pixel_format_e::rgb_555;
+                    VIRTUAL_RESOLUTION.bpp = 16;
+                }
+                else
+                {
+                    NBENE(("Unrecognized virtual pixel format (--virtual-pixel-format). "
+                           "Expected \"rgb888\", \"rgb565\", or \"rgb555\"."));
+
+                    kd_show_headless_error_message("", parseFailMsg);
+
+                    return false;
+                }
+
+                break;
+            }
+            case OPT_VIRTUAL_PATTERN:
+            {
+                if (strcmp(optarg, "static") == 0)
+                {
+                    VIRTUAL_PATTERN = test_pattern_e::still;
+                }
+                else if (strcmp(optarg, "scroll") == 0)
+                {
+                    VIRTUAL_PATTERN = test_pattern_e::scroll;
+                }
+                else if (strcmp(optarg, "full") == 0)
+                {
+                    VIRTUAL_PATTERN = test_pattern_e::full_change;
+                }
+                else if (strcmp(optarg, "sprite") == 0)
+                {
+                    VIRTUAL_PATTERN = test_pattern_e::sprite;
+                }
+                else
+                {
+                    NBENE(("Unrecognized virtual test pattern (--virtual-pattern). "
+                           "Expected \"static\", \"scroll\", \"full\", or \"sprite\"."));
+
+                    kd_show_headless_error_message("", parseFailMsg);
+
+                    return false;
+                }
+
+                break;
+            }
+            case OPT_VIRTUAL_MODE_STORM:
+            {
+                const int minInterval = 1;
+                const int maxInterval = 60000;
+
+                char *end = nullptr;
+                const int interval = strtol(optarg, &end, 10);
+
+                if ((end == optarg) ||
+                    (interval < minInterval) ||
+                    (interval > maxInterval))
+                {
+                    NBENE(("Virtual mode storm interval (--virtual-mode-storm) is out of bounds. Expected range: %d-%d.",
+                           minInterval, maxInterval));
+
+                    kd_show_headless_error_message("", parseFailMsg);
+
+                    return false;
+                }
+
+                VIRTUAL_MODE_STORM_INTERVAL = unsigned(interval);
+
+                break;
+            }
+            case OPT_REPLAY_FILE:
+            {
+                REPLAY_FILE_NAME = optarg;
+                break;
+            }
+            case OPT_REPLAY_TIMING:
+            {
+                if (strcmp(optarg, "original") == 0)
+                {
+                    REPLAY_AS_FAST_AS_POSSIBLE = false;
+                }
+                else if (strcmp(optarg, "fast") == 0)
+                {
+                    REPLAY_AS_FAST_AS_POSSIBLE = true;
+                }
+                else
+                {
+                    NBENE(("Unrecognized replay timing (--replay-timing). "
+                           "Expected \"original\" or \"fast\"."));
+
+                    kd_show_headless_error_message("", parseFailMsg);
+
+                    return false;
+                }
+
+                break;
+            }
+            case OPT_REPLAY_LOOP:
+            {
+                REPLAY_LOOP = true;
+                break;
+            }
         }
     }
 
@@ -135,11 +698,174 @@ void kcom_override_video_presets_file_name(const std::string newFilename)
     return;
 }
 
+void kcom_override_capture_thread_cpu(const int cpuIdx)
+{
+    CAPTURE_THREAD_CPU = cpuIdx;
+
+    return;
+}
+
+void kcom_override_capture_thread_scheduling(const capture_thread_scheduling_e scheduling)
+{
+    CAPTURE_THREAD_SCHEDULING = scheduling;
+
+    return;
+}
+
+void kcom_override_capture_thread_priority(const int priority)
+{
+    CAPTURE_THREAD_PRIORITY = priority;
+
+    return;
+}
+
+void kcom_override_lock_capture_memory(const bool lock)
+{
+    LOCK_CAPTURE_MEMORY = lock;
+
+    return;
+}
+
 unsigned kcom_mem_cache_size_mb(void)
 {
     return MEM_CACHE_SIZE_MB;
 }
 
+unsigned kcom_frame_queue_size(void)
+{
+    return FRAME_QUEUE_SIZE;
+}
+
+captured_frame_ring_c::overflow_policy_e kcom_frame_queue_overflow_policy(void)
+{
+    return FRAME_QUEUE_OVERFLOW_POLICY;
+}
+
+bool kcom_zero_copy_capture(void)
+{
+    return ZERO_COPY_CAPTURE;
+}
+
+bool kcom_drain_to_newest(void)
+{
+    return DRAIN_TO_NEWEST;
+}
+
+bool kcom_hardware_scaling(void)
+{
+    return HARDWARE_SCALING;
+}
+
+capture_memory_e kcom_capture_memory(void)
+{
+    return CAPTURE_MEMORY;
+}
+
+bool kcom_convert_on_capture(void)
+{
+    return CONVERT_ON_CAPTURE;
+}
+
+int kcom_capture_thread_cpu(void)
+{
+    return CAPTURE_THREAD_CPU;
+}
+
+capture_thread_scheduling_e kcom_capture_thread_scheduling(void)
+{
+    return CAPTURE_THREAD_SCHEDULING;
+}
+
+int kcom_capture_thread_priority(void)
+{
+    return CAPTURE_THREAD_PRIORITY;
+}
+
+bool kcom_lock_capture_memory(void)
+{
+    return LOCK_CAPTURE_MEMORY;
+}
+
+bool kcom_is_capture_thread_cpu_given(void)
+{
+    return IS_CAPTURE_THREAD_CPU_GIVEN;
+}
+
+bool kcom_is_capture_thread_scheduling_given(void)
+{
+    return IS_CAPTURE_THREAD_SCHEDULING_GIVEN;
+}
+
+bool kcom_is_capture_thread_priority_given(void)
+{
+    return IS_CAPTURE_THREAD_PRIORITY_GIVEN;
+}
+
+bool kcom_is_lock_capture_memory_given(void)
+{
+    return IS_LOCK_CAPTURE_MEMORY_GIVEN;
+}
+
+const std::vector<unsigned>& kcom_concurrent_input_channels(void)
+{
+    return CONCURRENT_INPUT_CHANNELS;
+}
+
+const std::vector<unsigned>& kcom_standby_input_channels(void)
+{
+    return STANDBY_INPUT_CHANNELS;
+}
+
+duplicate_frame_handling_e kcom_duplicate_frame_handling(void)
+{
+    return DUPLICATE_FRAME_HANDLING;
+}
+
+double kcom_frame_rate_limit(void)
+{
+    return FRAME_RATE_LIMIT;
+}
+
+resolution_s kcom_virtual_resolution(void)
+{
+    return VIRTUAL_RESOLUTION;
+}
+
+double kcom_virtual_refresh_rate(void)
+{
+    return VIRTUAL_REFRESH_RATE;
+}
+
+capture_pixel_format_e kcom_virtual_pixel_format(void)
+{
+    return VIRTUAL_PIXEL_FORMAT;
+}
+
+test_pattern_e kcom_virtual_pattern(void)
+{
+    return VIRTUAL_PATTERN;
+}
+
+unsigned kcom_virtual_mode_storm_interval(void)
+{
+    return VIRTUAL_MODE_STORM_INTERVAL;
+}
+
+const std::string& kcom_replay_file_name(void)
+{
+    return REPLAY_FILE_NAME;
+}
+
+bool kcom_replay_as_fast_as_possible(void)
+{
+    return REPLAY_AS_FAST_AS_POSSIBLE;
+}
+
+bool kcom_replay_loop(void)
+{
+    return REPLAY_LOOP;
+}
+
 const std::string& kcom_aliases_file_name(void)
 {
     return ALIAS_FILE_NAME;
@@ -8,10 +8,42 @@
 #define VCS_COMMON_COMMAND_LINE_COMMAND_LINE_H
 
 #include <string>
+#include <vector>
+#include "capture/captured_frame_ring.h"
+#include "capture/capture_thread.h"
+
+enum class test_pattern_e;
 
 bool kcom_parse_command_line(const int argc, char *const argv[]);
 
 unsigned kcom_mem_cache_size_mb(void);
+unsigned kcom_frame_queue_size(void);
+captured_frame_ring_c::overflow_policy_e kcom_frame_queue_overflow_policy(void);
+bool kcom_zero_copy_capture(void);
+bool kcom_drain_to_newest(void);
+bool kcom_hardware_scaling(void);
+capture_memory_e kcom_capture_memory(void);
+bool kcom_convert_on_capture(void);
+int kcom_capture_thread_cpu(void);
+capture_thread_scheduling_e kcom_capture_thread_scheduling(void);
+int kcom_capture_thread_priority(void);
+bool kcom_lock_capture_memory(void);
+bool kcom_is_capture_thread_cpu_given(void);
+bool kcom_is_capture_thread_scheduling_given(void);
+bool kcom_is_capture_thread_priority_given(void);
+bool kcom_is_lock_capture_memory_given(void);
+const std::vector<unsigned>& kcom_concurrent_input_channels(void);
+const std::vector<unsigned>& kcom_standby_input_channels(void);
+duplicate_frame_handling_e kcom_duplicate_frame_handling(void);
+double kcom_frame_rate_limit(void);
+resolution_s kcom_virtual_resolution(void);
+double kcom_virtual_refresh_rate(void);
+capture_pixel_format_e kcom_virtual_pixel_format(void);
+test_pattern_e kcom_virtual_pattern(void);
+unsigned kcom_virtual_mode_storm_interval(void);
+const std::string& kcom_replay_file_name(void);
+bool kcom_replay_as_fast_as_possible(void);
+bool kcom_replay_loop(void);
 const std::string& kcom_aliases_file_name(void);
 const std::string& kcom_filter_graph_file_name(void);
 const std::string& kcom_video_presets_file_name(void);
@@ -19,5 +51,9 @@ const std::string& kcom_video_presets_file_name(void);
 void kcom_override_filter_graph_file_name(const std::string newFilename);
 void kcom_override_aliases_file_name(const std::string newFilename);
 void kcom_override_video_presets_file_name(const std::string newFilename);
+void kcom_override_capture_thread_cpu(const int cpuIdx);
+void kcom_override_capture_thread_scheduling(const capture_thread_scheduling_e scheduling);
+void kcom_override_capture_thread_priority(const int priority);
+void kcom_override_lock_capture_memory(const bool lock);
 
 #endif
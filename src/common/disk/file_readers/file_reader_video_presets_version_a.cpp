@@ -109,6 +109,14 @@ bool file_reader::video_presets::version_a::read(const std::string &filename,
                     preset->activatesWithShortcut = rowData.at(row).at(1).toInt();
                     preset->activationShortcut = rowData.at(row).at(2).toStdString();
                 }
+                else if (metadataName == "captureRegion")
+                {
+                    preset->hasCaptureRegion = rowData.at(row).at(1).toInt();
+                    preset->captureRegion.x = rowData.at(row).at(2).toUInt();
+                    preset->captureRegion.y = rowData.at(row).at(3).toUInt();
+                    preset->captureRegion.w = rowData.at(row).at(4).toUInt();
+                    preset->captureRegion.h = rowData.at(row).at(5).toUInt();
+                }
                 else if (metadataName == "name")
                 {
                     preset->name = rowData.at(row).at(1).toStdString();
@@ -23,7 +23,7 @@ bool file_writer::video_presets::version_a::write(const std::string &filename,
     {
         // Write the metadata.
         {
-            outFile << "metadataCount,4\n";
+            outFile << "metadataCount,5\n";
 
             outFile << "name,{" << QString::fromStdString(p->name) << "}\n";
 
@@ -44,6 +44,12 @@ bool file_writer::video_presets::version_a::write(const std::string &filename,
 
             outFile << "activatedByShortcut," << p->activatesWithShortcut << ","
                                               << QString::fromStdString(p->activationShortcut) << "\n";
+
+            outFile << "captureRegion," << p->hasCaptureRegion << ","
+                                        << p->captureRegion.x << ","
+                                        << p->captureRegion.y << ","
+                                        << p->captureRegion.w << ","
+                                        << p->captureRegion.h << "\n";
         }
 
         // Write the video parameters.
@@ -0,0 +1,62 @@
+/*
+ * 2021 Tarpeeksi Hyvae Soft
+ *
+ * Software: VCS
+ *
+ */
+
+#include <algorithm>
+#include "common/latency/latency_tracker.h"
+
+void latency_tracker_c::add_sample(const std::chrono::steady_clock::time_point captureTimestamp)
+{
+    if (captureTimestamp.time_since_epoch().count() == 0)
+    {
+        return;
+    }
+
+    const auto latency = (std::chrono::steady_clock::now() - captureTimestamp);
+
+    this->samplesMs[this->numSamplesRecorded % windowSize] = std::chrono::duration<double, std::milli>(latency).count();
+    this->numSamplesRecorded++;
+
+    return;
+}
+
+latency_stats_s latency_tracker_c::stats(void) const
+{
+    latency_stats_s stats;
+
+    stats.numSamples = unsigned(std::min<unsigned long>(this->numSamplesRecorded, windowSize));
+
+    if (!stats.numSamples)
+    {
+        return stats;
+    }
+
+    double sorted[windowSize];
+    std::copy(this->samplesMs, (this->samplesMs + stats.numSamples), sorted);
+    std::sort(sorted, (sorted + stats.numSamples));
+
+    double sum = 0;
+    for (unsigned i = 0; i < stats.numSamples; i++)
+    {
+        sum += sorted[i];
+    }
+
+    // Nearest-rank percentile.
+    const unsigned p99Rank = ((stats.numSamples * 99 + 99) / 100);
+
+    stats.minMs = sorted[0];
+    stats.avgMs = (sum / stats.numSamples);
+    stats.p99Ms = sorted[p99Rank - 1];
+
+    return stats;
+}
+
+void latency_tracker_c::reset(void)
+{
+    this->numSamplesRecorded = 0;
+
+    return;
+}
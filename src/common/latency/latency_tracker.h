@@ -0,0 +1,69 @@
+/*
+ * 2021 Tarpeeksi Hyvae Soft
+ *
+ * Software: VCS
+ *
+ */
+
+#ifndef VCS_COMMON_LATENCY_LATENCY_TRACKER_H
+#define VCS_COMMON_LATENCY_LATENCY_TRACKER_H
+
+#include <chrono>
+
+// Summary statistics of the latencies recorded by a latency tracker, in
+// milliseconds.
+struct latency_stats_s
+{
+    double minMs = 0;
+    double avgMs = 0;
+    double p99Ms = 0;
+
+    // The number of samples the statistics were derived from. Zero if no
+    // latencies have been recorded.
+    unsigned numSamples = 0;
+};
+
+// Records the latencies between the capture of frames and some later point in
+// their processing (e.g. their being scaled or displayed), keeping a sliding
+// window of the most recent samples.
+//
+// Usage:
+//
+//   1. Create a tracker:
+//
+//      latency_tracker_c tracker;
+//
+//   2. When a frame reaches the point of interest, record its latency:
+//
+//      tracker.add_sample(frame.timestamp);
+//
+//   3. Query the latency statistics over the window:
+//
+//      const latency_stats_s stats = tracker.stats();
+//
+// The tracker isn't thread-safe; all calls should come from the same thread.
+//
+class latency_tracker_c
+{
+public:
+    // The number of most recent samples the statistics are computed over.
+    static const unsigned windowSize = 256;
+
+    // Records the time elapsed between the given capture timestamp and now.
+    // Timestamps with no value (e.g. of frames not produced by a capture
+    // device) are ignored.
+    void add_sample(const std::chrono::steady_clock::time_point captureTimestamp);
+
+    latency_stats_s stats(void) const;
+
+    void reset(void);
+
+private:
+    double samplesMs[windowSize];
+
+    // The total number of samples recorded since the most recent reset(); the
+    // index of the next sample in the window is this modulo the window size.
+    unsigned long numSamplesRecorded = 0;
+};
+
+#endif
@@ -19,6 +19,7 @@
  */
 
 #include <vector>
+#include <algorithm>
 #include "common/timer/timer.h"
 
 static std::vector<timer_c> ACTIVE_TIMERS;
@@ -49,3 +50,17 @@ void kt_update_timers(void)
 
     return;
 }
+
+int kt_ms_until_next_timeout(void)
+{
+    int msUntilTimeout = -1;
+
+    for (const timer_c &timer: ACTIVE_TIMERS)
+    {
+        const int ms = int(timer.ms_until_timeout());
+
+        msUntilTimeout = ((msUntilTimeout < 0)? ms : std::min(msUntilTimeout, ms));
+    }
+
+    return msUntilTimeout;
+}
@@ -54,6 +54,16 @@ public:
         return;
     }
 
+    // Returns the number of milliseconds until the timer's next timeout, or 0
+    // if the timeout is already due.
+    unsigned ms_until_timeout(void) const
+    {
+        const auto timeNow = std::chrono::system_clock::now();
+        const unsigned msSinceLastTimeout = std::chrono::duration_cast<std::chrono::milliseconds>(timeNow - this->timeOfLastTimeout).count();
+
+        return ((msSinceLastTimeout >= this->intervalMs)? 0 : (this->intervalMs - msSinceLastTimeout));
+    }
+
     const unsigned intervalMs;
 
     const std::function<void(const unsigned elapsedMs)> timeoutFunction;
@@ -72,4 +82,8 @@ void kt_release_timers(void);
 
 void kt_update_timers(void);
 
+// Returns the number of milliseconds until the soonest timeout of any timer, or
+// -1 if there are no timers.
+int kt_ms_until_next_timeout(void);
+
 #endif
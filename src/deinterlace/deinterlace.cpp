@@ -0,0 +1,483 @@
+/*
+ * 2021 Tarpeeksi Hyvae Soft
+ *
+ * Software: VCS
+ *
+ */
+
+#include <algorithm>
+#include <cstdlib>
+#include <condition_variable>
+#include <cstring>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "deinterlace/deinterlace.h"
+#include "capture/capture.h"
+#include "common/globals.h"
+#include "common/memory/heap_mem.h"
+
+#if defined(__AVX2__)
+    #include <immintrin.h>
+#elif defined(__SSE2__)
+    #include <emmintrin.h>
+#endif
+
+// The amount by which a color channel's value must change between frames for
+// the motion-adaptive mode to consider the pixel to be in motion. Leaves some
+// headroom for analog noise.
+static const unsigned MOTION_THRESHOLD = 12;
+
+// Frames smaller than this many bytes are processed on the calling thread
+// alone, since splitting them between threads would cost more than it saves.
+static const unsigned MIN_NUM_BYTES_FOR_WORKERS = (720 * 480 * 4);
+
+// The largest number of threads (including the calling one) among which a
+// frame's rows are split.
+static const unsigned MAX_NUM_BANDS = 4;
+
+static deinterlacing_mode_e DEINTERLACING_MODE = deinterlacing_mode_e::weave;
+
+struct deinterlacer_channel_s
+{
+    // The de-interlaced frame.
+    heap_mem<u8> output;
+
+    // For motion-adaptive de-interlacing: the previous frame's pixels; and a
+    // buffer into which the current frame's pixels are copied to serve as the
+    // previous frame for the next one. Allocated on first use.
+    heap_mem<u8> prevFrames[2];
+    unsigned prevFrameIdx = 0;
+    resolution_s prevFrameRes = {0, 0, 0};
+
+    unsigned numFramesProcessed = 0;
+};
+
+// The de-interlacing state of each input channel, keyed by channel index.
+static std::unordered_map<unsigned, deinterlacer_channel_s*> CHANNELS;
+
+// The parameters for de-interlacing one frame, shared by the threads among
+// which the frame's rows are split.
+struct deinterlace_job_s
+{
+    const u8 *src;
+    u8 *dst;
+
+    // For motion-adaptive de-interlacing; see deinterlacer_channel_s. The
+    // previous frame is null if there's none to compare against.
+    const u8 *prevFrame;
+    u8 *nextPrevFrame;
+
+    unsigned pitch;
+    unsigned height;
+
+    deinterlacing_mode_e mode;
+
+    // The field (0 = even rows, 1 = odd rows) whose rows are kept as they are.
+    unsigned keptField;
+};
+
+// Worker threads that process the frame's rows alongside the calling thread.
+// Each worker processes one horizontal band of the frame, the calling thread
+// the first band.
+static std::vector<std::thread> WORKERS;
+static std::mutex WORKER_MUTEX;
+static std::condition_variable WORKER_WAKE;
+static std::condition_variable WORKER_DONE;
+static const deinterlace_job_s *WORKER_JOB = nullptr;
+static unsigned WORKER_JOB_ID = 0;
+static unsigned NUM_BANDS_PENDING = 0;
+static bool ARE_WORKERS_EXITING = false;
+
+// Writes into 'dst' the average of the corresponding bytes in 'above' and
+// 'below', rounding up.
+static void interpolate_row(u8 *const dst,
+                            const u8 *const above,
+                            const u8 *const below,
+                            const unsigned numBytes)
+{
+    unsigned i = 0;
+
+    #if defined(__AVX2__)
+        for (; (i + 32) <= numBytes; i += 32)
+        {
+            const __m256i a = _mm256_loadu_si256((const __m256i*)(above + i));
+            const __m256i b = _mm256_loadu_si256((const __m256i*)(below + i));
+
+            _mm256_storeu_si256((__m256i*)(dst + i), _mm256_avg_epu8(a, b));
+        }
+    #elif defined(__SSE2__)
+        for (; (i + 16) <= numBytes; i += 16)
+        {
+            const __m128i a = _mm_loadu_si128((const __m128i*)(above + i));
+            const __m128i b = _mm_loadu_si128((const __m128i*)(below + i));
+
+            _mm_storeu_si128((__m128i*)(dst + i), _mm_avg_epu8(a, b));
+        }
+    #endif
+
+    for (; i < numBytes; i++)
+    {
+        dst[i] = u8((above[i] + below[i] + 1) / 2);
+    }
+
+    return;
+}
+
+// Writes into 'dst' the pixels of 'cur' (a row of the field being
+// reconstructed), except that pixels in motion are replaced by the average of
+// 'above' and 'below' (the neighboring rows of the kept field). A pixel is in
+// motion if any of its color channels in 'cur' or 'above' has changed by more
+// than MOTION_THRESHOLD since the previous frame ('curPrev', 'abovePrev').
+static void motion_adaptive_row(u8 *const dst,
+                                const u8 *const cur,
+                                const u8 *const curPrev,
+                                const u8 *const above,
+                                const u8 *const abovePrev,
+                                const u8 *const below,
+                                const unsigned numBytes)
+{
+    unsigned i = 0;
+
+    #if defined(__AVX2__)
+        const __m256i threshold = _mm256_set1_epi8(char(MOTION_THRESHOLD));
+        const __m256i zero = _mm256_setzero_si256();
+
+        for (; (i + 32) <= numBytes; i += 32)
+        {
+            const __m256i c = _mm256_loadu_si256((const __m256i*)(cur + i));
+            const __m256i cp = _mm256_loadu_si256((const __m256i*)(curPrev + i));
+            const __m256i a = _mm256_loadu_si256((const __m256i*)(above + i));
+            const __m256i ap = _mm256_loadu_si256((const __m256i*)(abovePrev + i));
+            const __m256i b = _mm256_loadu_si256((const __m256i*)(below + i));
+
+            const __m256i deltaCur = _mm256_or_si256(_mm256_subs_epu8(c, cp), _mm256_subs_epu8(cp, c));
+            const __m256i deltaAbove = _mm256_or_si256(_mm256_subs_epu8(a, ap), _mm256_subs_epu8(ap, a));
+            const __m256i excess = _mm256_subs_epu8(_mm256_max_epu8(deltaCur, deltaAbove), threshold);
+
+            // All bits set for the pixels none of whose channels exceeded the
+            // threshold.
+            const __m256i isStatic = _mm256_cmpeq_epi32(excess, zero);
+
+            _mm256_storeu_si256((__m256i*)(dst + i), _mm256_blendv_epi8(_mm256_avg_epu8(a, b), c, isStatic));
+        }
+    #elif defined(__SSE2__)
+        const __m128i threshold = _mm_set1_epi8(char(MOTION_THRESHOLD));
+        const __m128i zero = _mm_setzero_si128();
+
+        for (; (i + 16) <= numBytes; i += 16)
+        {
+            const __m128i c = _mm_loadu_si128((const __m128i*)(cur + i));
+            const __m128i cp = _mm_loadu_si128((const __m128i*)(curPrev + i));
+            const __m128i a = _mm_loadu_si128((const __m128i*)(above + i));
+            const __m128i ap = _mm_loadu_si128((const __m128i*)(abovePrev + i));
+            const __m128i b = _mm_loadu_si128((const __m128i*)(below + i));
+
+            const __m128i deltaCur = _mm_or_si128(_mm_subs_epu8(c, cp), _mm_subs_epu8(cp, c));
+            const __m128i deltaAbove = _mm_or_si128(_mm_subs_epu8(a, ap), _mm_subs_epu8(ap, a));
+            const __m128i excess = _mm_subs_epu8(_mm_max_epu8(deltaCur, deltaAbove), threshold);
+
+            // All bits set for the pixels none of whose channels exceeded the
+            // threshold.
+            const __m128i isStatic = _mm_cmpeq_epi32(excess, zero);
+
+            _mm_storeu_si128((__m128i*)(dst + i), _mm_or_si128(_mm_and_si128(isStatic, c),
+                                                               _mm_andnot_si128(isStatic, _mm_avg_epu8(a, b))));
+        }
+    #endif
+
+    for (; (i + 4) <= numBytes; i += 4)
+    {
+        bool isMoving = false;
+
+        for (unsigned c = 0; c < 4; c++)
+        {
+            if ((unsigned(abs(cur[i + c] - curPrev[i + c])) > MOTION_THRESHOLD) ||
+                (unsigned(abs(above[i + c] - abovePrev[i + c])) > MOTION_THRESHOLD))
+            {
+                isMoving = true;
+                break;
+            }
+        }
+
+        for (unsigned c = 0; c < 4; c++)
+        {
+            dst[i + c] = (isMoving? u8((above[i + c] + below[i + c] + 1) / 2) : cur[i + c]);
+        }
+    }
+
+    return;
+}
+
+// De-interlaces the rows [startRow, endRow) of the job's frame.
+static void deinterlace_rows(const deinterlace_job_s &job, const unsigned startRow, const unsigned endRow)
+{
+    const auto row_of = [&job](const u8 *const frame, const unsigned y){ return (frame + (y * job.pitch)); };
+
+    for (unsigned y = startRow; y < endRow; y++)
+    {
+        u8 *const dstRow = (job.dst + (y * job.pitch));
+
+        if ((y % 2) == job.keptField)
+        {
+            memcpy(dstRow, row_of(job.src, y), job.pitch);
+        }
+        else
+        {
+            // The neighboring rows of the kept field. At the frame's edges, the
+            // one neighbor stands in for the other.
+            const unsigned above = ((y == 0)? 1 : (y - 1));
+            const unsigned below = (((y + 1) >= job.height)? (y - 1) : (y + 1));
+
+            if ((job.mode == deinterlacing_mode_e::motion_adaptive) &&
+                job.prevFrame)
+            {
+                motion_adaptive_row(dstRow,
+                                    row_of(job.src, y),
+                                    row_of(job.prevFrame, y),
+                                    row_of(job.src, above),
+                                    row_of(job.prevFrame, above),
+                                    row_of(job.src, below),
+                                    job.pitch);
+            }
+            else
+            {
+                interpolate_row(dstRow, row_of(job.src, above), row_of(job.src, below), job.pitch);
+            }
+        }
+
+        if (job.nextPrevFrame)
+        {
+            memcpy((job.nextPrevFrame + (y * job.pitch)), row_of(job.src, y), job.pitch);
+        }
+    }
+
+    return;
+}
+
+static void band_rows(const unsigned bandIdx, const unsigned numBands, const unsigned height,
+                      unsigned *const startRow, unsigned *const endRow)
+{
+    *startRow = ((height * bandIdx) / numBands);
+    *endRow = ((height * (bandIdx + 1)) / numBands);
+
+    return;
+}
+
+static void worker_thread(const unsigned bandIdx, const unsigned numBands)
+{
+    unsigned latestJobId = 0;
+
+    while (true)
+    {
+        const deinterlace_job_s *job = nullptr;
+
+        {
+            std::unique_lock<std::mutex> lock(WORKER_MUTEX);
+
+            WORKER_WAKE.wait(lock, [&latestJobId]{ return (ARE_WORKERS_EXITING || (WORKER_JOB_ID != latestJobId)); });
+
+            if (ARE_WORKERS_EXITING)
+            {
+                return;
+            }
+
+            latestJobId = WORKER_JOB_ID;
+            job = WORKER_JOB;
+        }
+
+        unsigned startRow = 0, endRow = 0;
+        band_rows(bandIdx, numBands, job->height, &startRow, &endRow);
+        deinterlace_rows(*job, startRow, endRow);
+
+        {
+            std::lock_guard<std::mutex> lock(WORKER_MUTEX);
+
+            if (--NUM_BANDS_PENDING == 0)
+            {
+                WORKER_DONE.notify_one();
+            }
+        }
+    }
+}
+
+// De-interlaces the job's frame, splitting its rows between the calling thread
+// and the worker threads if the frame is large enough.
+static void run_job(const deinterlace_job_s &job)
+{
+    if (WORKERS.empty() ||
+        ((job.pitch * job.height) < MIN_NUM_BYTES_FOR_WORKERS))
+    {
+        deinterlace_rows(job, 0, job.height);
+        return;
+    }
+
+    const unsigned numBands = unsigned(WORKERS.size() + 1);
+
+    {
+        std::lock_guard<std::mutex> lock(WORKER_MUTEX);
+
+        WORKER_JOB = &job;
+        WORKER_JOB_ID++;
+        NUM_BANDS_PENDING = unsigned(WORKERS.size());
+    }
+
+    WORKER_WAKE.notify_all();
+
+    unsigned startRow = 0, endRow = 0;
+    band_rows(0, numBands, job.height, &startRow, &endRow);
+    deinterlace_rows(job, startRow, endRow);
+
+    {
+        std::unique_lock<std::mutex> lock(WORKER_MUTEX);
+
+        WORKER_DONE.wait(lock, []{ return (NUM_BANDS_PENDING == 0); });
+    }
+
+    return;
+}
+
+static deinterlacer_channel_s& channel_of(const unsigned channelIdx)
+{
+    deinterlacer_channel_s *&channel = CHANNELS[channelIdx];
+
+    if (!channel)
+    {
+        channel = new deinterlacer_channel_s;
+        channel->output.allocate(MAX_NUM_BYTES_IN_CAPTURED_FRAME, "De-interlacer output buffer");
+    }
+
+    return *channel;
+}
+
+u8* kdi_deinterlace(u8 *const pixels, const resolution_s &r, const unsigned channelIdx)
+{
+    if ((DEINTERLACING_MODE == deinterlacing_mode_e::weave) ||
+        (r.bpp != 32) ||
+        (r.h < 2))
+    {
+        return pixels;
+    }
+
+    deinterlacer_channel_s &channel = channel_of(channelIdx);
+    const unsigned numBytes = (r.w * r.h * (r.bpp / 8));
+
+    deinterlace_job_s job;
+    job.src = pixels;
+    job.dst = channel.output.data();
+    job.prevFrame = nullptr;
+    job.nextPrevFrame = nullptr;
+    job.pitch = (r.w * (r.bpp / 8));
+    job.height = r.h;
+    job.mode = DEINTERLACING_MODE;
+
+    channel.output.size_check(numBytes);
+
+    switch (DEINTERLACING_MODE)
+    {
+        case deinterlacing_mode_e::field_1: job.keptField = 1; break;
+        case deinterlacing_mode_e::alternating_field: job.keptField = (channel.numFramesProcessed % 2); break;
+        default: job.keptField = 0; break;
+    }
+
+    if (DEINTERLACING_MODE == deinterlacing_mode_e::motion_adaptive)
+    {
+        if (channel.prevFrames[0].is_null())
+        {
+            channel.prevFrames[0].allocate(MAX_NUM_BYTES_IN_CAPTURED_FRAME, "De-interlacer previous frame buffer");
+            channel.prevFrames[1].allocate(MAX_NUM_BYTES_IN_CAPTURED_FRAME, "De-interlacer previous frame buffer");
+            channel.prevFrameRes = {0, 0, 0};
+        }
+
+        if ((channel.prevFrameRes.w == r.w) &&
+            (channel.prevFrameRes.h == r.h) &&
+            (channel.prevFrameRes.bpp == r.bpp))
+        {
+            job.prevFrame = channel.prevFrames[channel.prevFrameIdx].data();
+        }
+
+        job.nextPrevFrame = channel.prevFrames[!channel.prevFrameIdx].data();
+    }
+
+    run_job(job);
+
+    if (job.nextPrevFrame)
+    {
+        channel.prevFrameIdx = !channel.prevFrameIdx;
+        channel.prevFrameRes = r;
+    }
+    else
+    {
+        channel.prevFrameRes = {0, 0, 0};
+    }
+
+    channel.numFramesProcessed++;
+
+    return channel.output.data();
+}
+
+void kdi_initialize_deinterlacer(void)
+{
+    const unsigned numBands = std::max(1u, std::min(MAX_NUM_BANDS, std::thread::hardware_concurrency()));
+
+    INFO(("Initializing the de-interlacer with %u thread(s).", numBands));
+
+    ARE_WORKERS_EXITING = false;
+
+    for (unsigned i = 1; i < numBands; i++)
+    {
+        WORKERS.emplace_back(worker_thread, i, numBands);
+    }
+
+    return;
+}
+
+void kdi_release_deinterlacer(void)
+{
+    INFO(("Releasing the de-interlacer."));
+
+    {
+        std::lock_guard<std::mutex> lock(WORKER_MUTEX);
+
+        ARE_WORKERS_EXITING = true;
+    }
+
+    WORKER_WAKE.notify_all();
+
+    for (auto &worker: WORKERS)
+    {
+        worker.join();
+    }
+
+    WORKERS.clear();
+
+    for (auto &channel: CHANNELS)
+    {
+        channel.second->output.release();
+
+        if (!channel.second->prevFrames[0].is_null())
+        {
+            channel.second->prevFrames[0].release();
+            channel.second->prevFrames[1].release();
+        }
+
+        delete channel.second;
+    }
+
+    CHANNELS.clear();
+
+    return;
+}
+
+void kdi_set_deinterlacing_mode(const deinterlacing_mode_e mode)
+{
+    DEINTERLACING_MODE = mode;
+
+    return;
+}
+
+deinterlacing_mode_e kdi_deinterlacing_mode(void)
+{
+    return DEINTERLACING_MODE;
+}
@@ -0,0 +1,129 @@
+/*
+ * 2021 Tarpeeksi Hyvae Soft
+ *
+ * Software: VCS
+ *
+ */
+
+/*! @file
+ *
+ * @brief
+ * The de-interlacing subsystem interface.
+ *
+ * The de-interlacing subsystem removes the combing artefacts of interlaced
+ * frames -- frames whose even and odd pixel rows (fields) were sampled at
+ * different times -- in VCS rather than in the capture device; for capture
+ * devices that can't de-interlace, or that ignore the de-interlacing mode set
+ * with kc_set_deinterlacing_mode().
+ *
+ * The captured frames are expected to arrive woven, i.e. with both fields
+ * interleaved into one frame.
+ *
+ * ## Usage
+ *
+ *   1. Call kdi_initialize_deinterlacer() to initialize the subsystem. This is
+ *      VCS's default startup behavior.
+ *
+ *   2. Call kdi_set_deinterlacing_mode() to select how frames are de-interlaced.
+ *
+ *   3. Call kdi_deinterlace() with each frame to be de-interlaced.
+ *
+ *   4. Call kdi_release_deinterlacer() to release the subsystem. This is VCS's
+ *      default exit behavior.
+ *
+ */
+
+#ifndef VCS_DEINTERLACE_DEINTERLACE_H
+#define VCS_DEINTERLACE_DEINTERLACE_H
+
+#include "common/globals.h"
+
+struct resolution_s;
+
+/*!
+ * Enumerates the de-interlacing modes of the de-interlacing subsystem.
+ *
+ * @see
+ * kdi_set_deinterlacing_mode()
+ */
+enum class deinterlacing_mode_e
+{
+    /*! Frames are passed through as they are, with both fields interleaved.*/
+    weave,
+
+    /*! Each frame's rows are taken from one of its fields, alternating between
+     *  the two fields from frame to frame, and the other field's rows are
+     *  interpolated. Unlike a true bob de-interlacer, which outputs each field
+     *  as a frame of its own, this outputs one frame per input frame, so the
+     *  other field of each frame is discarded. With a capture device that
+     *  weaves each new field with the previous one (delivering frames at the
+     *  field rate), this nonetheless shows each field in turn.*/
+    alternating_field,
+
+    /*! Each frame's rows are taken from its first (even) field, and the second
+     *  field's rows are interpolated.*/
+    field_0,
+
+    /*! Each frame's rows are taken from its second (odd) field, and the first
+     *  field's rows are interpolated.*/
+    field_1,
+
+    /*! Pixels in the second field that haven't changed since the previous frame
+     *  are woven, and those that have are interpolated from the first field; so
+     *  that static areas keep their full vertical resolution while moving ones
+     *  don't comb.*/
+    motion_adaptive,
+};
+
+/*!
+ * Initializes the de-interlacing subsystem.
+ *
+ * By default, VCS will call this function on program startup.
+ *
+ * @see
+ * kdi_release_deinterlacer()
+ */
+void kdi_initialize_deinterlacer(void);
+
+/*!
+ * Releases the de-interlacing subsystem, including its memory buffers and
+ * worker threads.
+ *
+ * By default, VCS will call this function on program exit.
+ *
+ * @warning
+ * Calling this function invalidates the pointers returned by kdi_deinterlace().
+ */
+void kdi_release_deinterlacer(void);
+
+/*!
+ * De-interlaces the given frame of 32-bit pixels according to the current
+ * de-interlacing mode.
+ *
+ * Returns a pointer to a subsystem-managed buffer holding the de-interlaced
+ * frame, which stays valid until the next call to this function for the same
+ * input channel. In weave mode, or if the frame isn't 32-bit, returns
+ * @p pixels.
+ *
+ * The input data won't be modified.
+ *
+ * @p channelIdx identifies the input channel the frame was captured from. Each
+ * channel is de-interlaced separately, so that frames captured concurrently
+ * from different channels (see kc_open_concurrent_input_channel()) don't get
+ * mixed.
+ *
+ * Large frames are split between worker threads.
+ */
+u8* kdi_deinterlace(u8 *const pixels, const resolution_s &r, const unsigned channelIdx);
+
+/*!
+ * Sets the de-interlacing mode applied by kdi_deinterlace().
+ */
+void kdi_set_deinterlacing_mode(const deinterlacing_mode_e mode);
+
+/*!
+ * Returns the current de-interlacing mode.
+ */
+deinterlacing_mode_e kdi_deinterlacing_mode(void);
+
+#endif
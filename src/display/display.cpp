@@ -6,5 +6,28 @@
  */
 
 #include "display/display.h"
+#include "capture/capture.h"
 
 vcs_event_c<void> kd_evDirty;
+
+static latency_tracker_c CAPTURE_TO_PRESENT_LATENCY;
+
+void kd_report_frame_presented(const captured_frame_s &frame)
+{
+    static std::chrono::steady_clock::time_point prevTimestamp = {};
+
+    if (frame.timestamp == prevTimestamp)
+    {
+        return;
+    }
+
+    prevTimestamp = frame.timestamp;
+    CAPTURE_TO_PRESENT_LATENCY.add_sample(frame.timestamp);
+
+    return;
+}
+
+latency_stats_s kd_capture_to_present_latency(void)
+{
+    return CAPTURE_TO_PRESENT_LATENCY.stats();
+}
@@ -33,7 +33,9 @@
 #include <vector>
 #include "common/types.h"
 #include "common/propagate/vcs_event.h"
+#include "common/latency/latency_tracker.h"
 
+struct captured_frame_s;
 struct log_entry_s;
 struct resolution_alias_s;
 class FilterGraphNode;
@@ -249,6 +251,28 @@ void kd_update_output_window_size(void);
  */
 void kd_spin_event_loop(void);
 
+/*!
+ * Asks the GUI to block until it has events to process, until the capture
+ * subsystem signals a new capture event (see kc_capture_event_fd()), or until
+ * @p maxWaitMs milliseconds have passed, whichever comes first. A @p maxWaitMs
+ * of -1 means no time limit. The GUI should process any of its events that it
+ * was woken up by.
+ *
+ * VCS calls this function when it has no capture events to process, in place
+ * of busy-waiting on the capture subsystem. It's not called if the platform
+ * doesn't provide a capture event fd.
+ *
+ * The following sample Qt 5 code waits for events, given a QSocketNotifier
+ * watching kc_capture_event_fd() and a single-shot QTimer for the time limit:
+ *
+ * @code
+ * timer.start(maxWaitMs);
+ * QCoreApplication::processEvents(QEventLoop::WaitForMoreEvents);
+ * timer.stop();
+ * @endcode
+ */
+void kd_wait_for_events(const int maxWaitMs);
+
 /*!
  * Asks the GUI to display an info message to the user.
  * 
@@ -311,4 +335,23 @@ bool kd_add_log_entry(const log_entry_s e);
  */
 bool kd_is_fullscreen(void);
 
+/*!
+ * To be called by the output window's paint routine each time it has drawn
+ * the given frame (typically, the scaler's frame buffer) on screen. Repeated
+ * draws of the same frame are counted only once.
+ * 
+ * @see
+ * kd_capture_to_present_latency()
+ */
+void kd_report_frame_presented(const captured_frame_s &frame);
+
+/*!
+ * Returns statistics of the time elapsed between the capture of recent frames
+ * and their having been drawn on screen.
+ * 
+ * @see
+ * kd_report_frame_presented(), ks_capture_to_scale_latency()
+ */
+latency_stats_s kd_capture_to_present_latency(void);
+
 #endif
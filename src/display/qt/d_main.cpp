@@ -9,6 +9,8 @@
 
 #include <QApplication>
 #include <QMessageBox>
+#include <QSocketNotifier>
+#include <QTimer>
 #include <cassert>
 #include <thread>
 #include "display/qt/windows/output_window.h"
@@ -96,6 +98,49 @@ void kd_spin_event_loop(void)
     return;
 }
 
+void kd_wait_for_events(const int maxWaitMs)
+{
+    ASSERT_WINDOW_IS_NOT_NULL;
+
+    // Wakes the event loop up when the capture subsystem has new events. We
+    // don't need to respond to the notification itself, since VCS's main loop
+    // will poll the capture subsystem once we return.
+    static QSocketNotifier *captureEventNotifier = nullptr;
+
+    // Wakes the event loop up once the maximum wait time has passed.
+    static QTimer *wakeUpTimer = nullptr;
+
+    if (!wakeUpTimer)
+    {
+        wakeUpTimer = new QTimer(WINDOW);
+        wakeUpTimer->setSingleShot(true);
+
+        if (kc_capture_event_fd() >= 0)
+        {
+            captureEventNotifier = new QSocketNotifier(kc_capture_event_fd(), QSocketNotifier::Read, WINDOW);
+        }
+    }
+
+    // Without the notifier, the capture subsystem couldn't wake us up.
+    if (!captureEventNotifier)
+    {
+        DEBUG(("Asked to wait for events without a capture event fd. Ignoring this."));
+
+        return;
+    }
+
+    if (maxWaitMs >= 0)
+    {
+        wakeUpTimer->start(maxWaitMs);
+    }
+
+    QCoreApplication::processEvents(QEventLoop::WaitForMoreEvents);
+
+    wakeUpTimer->stop();
+
+    return;
+}
+
 void kd_update_output_window_title(void)
 {
     if (WINDOW)
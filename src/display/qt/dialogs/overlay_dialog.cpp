@@ -19,6 +19,7 @@
 #include "display/qt/utility.h"
 #include "display/display.h"
 #include "capture/capture.h"
+#include "scaler/scaler.h"
 #include "ui_overlay_dialog.h"
 
 OverlayDialog::OverlayDialog(QWidget *parent) :
@@ -97,6 +98,45 @@ OverlayDialog::OverlayDialog(QWidget *parent) :
                     this->insert_text_into_overlay_editor("$areFramesDropped");
                 });
 
+                // Latency from capture to scaling and to display.
+                {
+                    QMenu *latencyMenu = new QMenu("Latency", this->menuBar);
+
+                    connect(latencyMenu->addAction("Scale latency, min (ms)"), &QAction::triggered, this, [=]
+                    {
+                        this->insert_text_into_overlay_editor("$scaleLatencyMin");
+                    });
+
+                    connect(latencyMenu->addAction("Scale latency, avg (ms)"), &QAction::triggered, this, [=]
+                    {
+                        this->insert_text_into_overlay_editor("$scaleLatencyAvg");
+                    });
+
+                    connect(latencyMenu->addAction("Scale latency, p99 (ms)"), &QAction::triggered, this, [=]
+                    {
+                        this->insert_text_into_overlay_editor("$scaleLatencyP99");
+                    });
+
+                    latencyMenu->addSeparator();
+
+                    connect(latencyMenu->addAction("Output latency, min (ms)"), &QAction::triggered, this, [=]
+                    {
+                        this->insert_text_into_overlay_editor("$outputLatencyMin");
+                    });
+
+                    connect(latencyMenu->addAction("Output latency, avg (ms)"), &QAction::triggered, this, [=]
+                    {
+                        this->insert_text_into_overlay_editor("$outputLatencyAvg");
+                    });
+
+                    connect(latencyMenu->addAction("Output latency, p99 (ms)"), &QAction::triggered, this, [=]
+                    {
+                        this->insert_text_into_overlay_editor("$outputLatencyP99");
+                    });
+
+                    outputMenu->addMenu(latencyMenu);
+                }
+
                 variablesMenu->addMenu(outputMenu);
             }
 
@@ -240,11 +280,19 @@ QString OverlayDialog::parsed_overlay_string(void)
 
     const auto inRes = kc_get_capture_resolution();
     const auto outRes = ks_output_resolution();
+    const latency_stats_s scaleLatency = ks_capture_to_scale_latency();
+    const latency_stats_s outputLatency = kd_capture_to_present_latency();
 
     parsed.replace("$inputResolution",  QString("%1 \u00d7 %2").arg(inRes.w).arg(inRes.h));
     parsed.replace("$outputResolution", QString("%1 \u00d7 %2").arg(outRes.w).arg(outRes.h));
     parsed.replace("$inputHz",          QString::number(kc_get_capture_refresh_rate().value<unsigned>()));
     parsed.replace("$areFramesDropped", ((kc_get_missed_frames_count() > 0)? "Dropping frames" : ""));
+    parsed.replace("$scaleLatencyMin",  QString::number(scaleLatency.minMs, 'f', 1));
+    parsed.replace("$scaleLatencyAvg",  QString::number(scaleLatency.avgMs, 'f', 1));
+    parsed.replace("$scaleLatencyP99",  QString::number(scaleLatency.p99Ms, 'f', 1));
+    parsed.replace("$outputLatencyMin", QString::number(outputLatency.minMs, 'f', 1));
+    parsed.replace("$outputLatencyAvg", QString::number(outputLatency.avgMs, 'f', 1));
+    parsed.replace("$outputLatencyP99", QString::number(outputLatency.p99Ms, 'f', 1));
     parsed.replace("$systemTime",       QDateTime::currentDateTime().time().toString());
     parsed.replace("$systemDate",       QDateTime::currentDateTime().date().toString());
 
@@ -21,7 +21,9 @@
 #include "display/qt/utility.h"
 #include "display/display.h"
 #include "capture/capture.h"
+#include "capture/capture_thread.h"
 #include "common/disk/disk.h"
+#include "scaler/scaler.h"
 #include "ui_signal_dialog.h"
 
 // Used to keep track of how long we've had a particular video mode set.
@@ -52,9 +54,18 @@ SignalDialog::SignalDialog(QWidget *parent) :
             ui->tableWidget_propertyTable->modify_property("Input channel",  "No signal");
             ui->tableWidget_propertyTable->modify_property("Resolution",     "-");
             ui->tableWidget_propertyTable->modify_property("Refresh rate",   "-");
+            ui->tableWidget_propertyTable->modify_property("Measured rate",  "-");
             ui->tableWidget_propertyTable->modify_property("Frame rate",   "-");
+            ui->tableWidget_propertyTable->modify_property("Unique frames",  "-");
             ui->tableWidget_propertyTable->modify_property("Uptime",         "-");
             ui->tableWidget_propertyTable->modify_property("Frames dropped", "-");
+            ui->tableWidget_propertyTable->modify_property("Frames skipped", "-");
+            ui->tableWidget_propertyTable->modify_property("Frame queue",    "-");
+            ui->tableWidget_propertyTable->modify_property("Back buffers",   "-");
+            ui->tableWidget_propertyTable->modify_property("Scheduling latency", "-");
+            ui->tableWidget_propertyTable->modify_property("Scale latency",  "-");
+            ui->tableWidget_propertyTable->modify_property("Output latency", "-");
+            ui->tableWidget_propertyTable->modify_property("Mode change latency", "-");
         }
 
         // Start timers to keep track of the video mode's uptime and dropped
@@ -75,6 +86,106 @@ SignalDialog::SignalDialog(QWidget *parent) :
                     ui->tableWidget_propertyTable->modify_property("Frames dropped", QString::number(NUM_DROPPED_FRAMES));
                 }
 
+                // Update the count of frames skipped in favor of newer ones.
+                {
+                    ui->tableWidget_propertyTable->modify_property("Frames skipped", QString::number(kc_get_skipped_frames_count()));
+                }
+
+                // Update the frame queue's occupancy.
+                {
+                    const frame_queue_status_s queue = kc_get_frame_queue_status();
+
+                    ui->tableWidget_propertyTable->modify_property("Frame queue", QString("%1/%2 (peak %3)").arg(queue.numOccupied)
+                                                                                                       .arg(queue.capacity)
+                                                                                                       .arg(queue.peakOccupied));
+                }
+
+                // Update the number of back buffers, with the history of its
+                // adjustments as a tooltip.
+                {
+                    const back_buffer_status_s backBuffers = kc_get_back_buffer_status();
+                    const auto timeNow = std::chrono::steady_clock::now();
+                    QStringList history;
+
+                    for (auto it = backBuffers.history.rbegin(); it != backBuffers.history.rend(); it++)
+                    {
+                        const auto secondsAgo = std::chrono::duration_cast<std::chrono::seconds>(timeNow - it->timestamp).count();
+
+                        history << QString("%1 \u2192 %2, %3 s ago: %4").arg(it->oldCount)
+                                                                     .arg(it->newCount)
+                                                                     .arg(secondsAgo)
+                                                                     .arg(QString::fromStdString(it->reason));
+                    }
+
+                    if (!backBuffers.count)
+                    {
+                        ui->tableWidget_propertyTable->modify_property("Back buffers", "-");
+                    }
+                    else if (!backBuffers.isAdaptive)
+                    {
+                        ui->tableWidget_propertyTable->modify_property("Back buffers", QString::number(backBuffers.count));
+                    }
+                    else
+                    {
+                        ui->tableWidget_propertyTable->modify_property("Back buffers", QString("%1 (adaptive, %2\u2013%3)").arg(backBuffers.count)
+                                                                                                                   .arg(backBuffers.minCount)
+                                                                                                                   .arg(backBuffers.maxCount),
+                                                                       (history.isEmpty()? "No adjustments made." : history.join("\n")));
+                    }
+                }
+
+                // Update the refresh rate and jitter measured from the frames'
+                // capture timestamps (rate, standard deviation / 99th
+                // percentile of the intervals), with a histogram of the
+                // intervals as a tooltip.
+                {
+                    const frame_interval_stats_s intervals = kc_get_frame_interval_stats();
+
+                    if (!intervals.numSamples)
+                    {
+                        ui->tableWidget_propertyTable->modify_property("Measured rate", "-");
+                    }
+                    else
+                    {
+                        QStringList histogram;
+
+                        for (unsigned i = 0; i < frame_interval_stats_s::numHistogramBins; i++)
+                        {
+                            const double binStartMs = (intervals.histogramStartMs + (i * intervals.histogramBinWidthMs));
+
+                            histogram << QString("%1 ms: %2").arg(QString::number(binStartMs, 'f', 2))
+                                                             .arg(intervals.histogram[i]);
+                        }
+
+                        ui->tableWidget_propertyTable->modify_property("Measured rate", QString("%1 Hz, \u00b1%2 / %3 ms").arg(QString::number(intervals.refreshRate, 'f', 3))
+                                                                                                                       .arg(QString::number(intervals.stddevMs, 'f', 2))
+                                                                                                                       .arg(QString::number(intervals.p99Ms, 'f', 2)),
+                                                                       QString("Frame intervals over the last %1 frames:\n%2").arg(intervals.numSamples)
+                                                                                                                             .arg(histogram.join("\n")));
+                    }
+                }
+
+                // Update the latency between the capture thread waking up for a
+                // new frame and its having queued the frame for VCS.
+                {
+                    ui->tableWidget_propertyTable->modify_property("Scheduling latency", latency_stats_to_qstring(kc_get_capture_scheduling_latency()));
+                }
+
+                // Update the latencies from capture to scaling and to display
+                // (min / avg / 99th percentile).
+                {
+                    ui->tableWidget_propertyTable->modify_property("Scale latency", latency_stats_to_qstring(ks_capture_to_scale_latency()));
+                    ui->tableWidget_propertyTable->modify_property("Output latency", latency_stats_to_qstring(kd_capture_to_present_latency()));
+                }
+
+                // Update the time it took to receive a frame after the most recent
+                // video mode change.
+                {
+                    const double modeChangeLatency = kc_get_video_mode_change_latency();
+
+                    ui->tableWidget_propertyTable->modify_property("Mode change latency", ((modeChangeLatency < 0)? "-" : QString("%1 ms").arg(QString::number(modeChangeLatency, 'f', 1))));
+                }
+
                 // Update uptime.
                 {
                     const unsigned seconds = unsigned(VIDEO_MODE_UPTIME.elapsed() / 1000);
@@ -143,6 +254,11 @@ SignalDialog::SignalDialog(QWidget *parent) :
             ui->tableWidget_propertyTable->modify_property("Frame rate", QString("%1 FPS").arg(fps));
         });
 
+        kc_evUniqueFramesPerSecond.listen([this](const unsigned fps)
+        {
+            ui->tableWidget_propertyTable->modify_property("Unique frames", QString("%1 FPS").arg(fps));
+        });
+
         kc_evNewVideoMode.listen([update_info](const video_mode_s&)
         {
             update_info();
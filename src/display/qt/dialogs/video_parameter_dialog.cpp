@@ -89,6 +89,7 @@ VideoParameterDialog::VideoParameterDialog(QWidget *parent) :
         ui->pushButton_resolutionSeparator->setText("\u00d7");
 
         ui->groupBox_activation->setEnabled(false);
+        ui->groupBox_captureRegion->setEnabled(false);
         ui->comboBox_presetList->setEnabled(false);
         ui->pushButton_deletePreset->setEnabled(false);
         ui->groupBox_videoPresetName->setEnabled(false);
@@ -102,6 +103,14 @@ VideoParameterDialog::VideoParameterDialog(QWidget *parent) :
         ui->spinBox_resolutionY->setMinimum(int(minres.w));
         ui->spinBox_resolutionY->setMaximum(int(maxres.w));
 
+        ui->spinBox_captureRegionX->setMaximum(int(maxres.w - minres.w));
+        ui->spinBox_captureRegionY->setMaximum(int(maxres.h - minres.h));
+        ui->spinBox_captureRegionWidth->setMinimum(int(minres.w));
+        ui->spinBox_captureRegionWidth->setMaximum(int(maxres.w));
+        ui->spinBox_captureRegionHeight->setMinimum(int(minres.h));
+        ui->spinBox_captureRegionHeight->setMaximum(int(maxres.h));
+        ui->label_captureRegionSizeSeparator->setText("\u00d7");
+
         ui->parameterGrid_videoParams->add_scroller("Hor. size");
         ui->parameterGrid_videoParams->add_scroller("Hor. position");
         ui->parameterGrid_videoParams->add_scroller("Ver. position");
@@ -146,6 +155,7 @@ VideoParameterDialog::VideoParameterDialog(QWidget *parent) :
         connect(ui->comboBox_presetList, &VideoPresetList::list_became_empty, this, [this]
         {
             ui->groupBox_activation->setEnabled(false);
+            ui->groupBox_captureRegion->setEnabled(false);
             ui->comboBox_presetList->setEnabled(false);
             ui->pushButton_deletePreset->setEnabled(false);
             ui->groupBox_videoPresetName->setEnabled(false);
@@ -158,6 +168,7 @@ VideoParameterDialog::VideoParameterDialog(QWidget *parent) :
         connect(ui->comboBox_presetList, &VideoPresetList::list_became_populated, this, [this]
         {
             ui->groupBox_activation->setEnabled(true);
+            ui->groupBox_captureRegion->setEnabled(true);
             ui->comboBox_presetList->setEnabled(true);
             ui->pushButton_deletePreset->setEnabled(true);
             ui->groupBox_videoPresetName->setEnabled(true);
@@ -235,6 +246,25 @@ VideoParameterDialog::VideoParameterDialog(QWidget *parent) :
             }
         });
 
+        // Changes to the preset's capture region.
+        {
+            const auto capture_region_changed = [this]
+            {
+                if (ui->comboBox_presetList->current_preset() &&
+                    CONTROLS_LIVE_UPDATE)
+                {
+                    this->broadcast_current_preset_parameters();
+                    emit this->data_changed();
+                }
+            };
+
+            connect(ui->groupBox_captureRegion, &QGroupBox::toggled, this, capture_region_changed);
+            connect(ui->spinBox_captureRegionX, QOverload<int>::of(&QSpinBox::valueChanged), this, capture_region_changed);
+            connect(ui->spinBox_captureRegionY, QOverload<int>::of(&QSpinBox::valueChanged), this, capture_region_changed);
+            connect(ui->spinBox_captureRegionWidth, QOverload<int>::of(&QSpinBox::valueChanged), this, capture_region_changed);
+            connect(ui->spinBox_captureRegionHeight, QOverload<int>::of(&QSpinBox::valueChanged), this, capture_region_changed);
+        }
+
         connect(ui->parameterGrid_videoParams, &ParameterGrid::parameter_value_changed_by_user, this, [this]
         {
             emit this->data_changed();
@@ -313,7 +343,9 @@ VideoParameterDialog::VideoParameterDialog(QWidget *parent) :
 
         connect(ui->pushButton_resolutionSeparator, &QPushButton::clicked, this, [this](void)
         {
-            const auto currentResolution = kc_get_capture_resolution();
+            // Presets activate based on the resolution of the input signal, which
+            // may differ from the capture resolution if a capture region is active.
+            const auto currentResolution = kc_get_source_resolution();
 
             ui->spinBox_resolutionX->setValue(int(currentResolution.w));
             ui->spinBox_resolutionY->setValue(int(currentResolution.h));
@@ -534,6 +566,12 @@ void VideoParameterDialog::broadcast_current_preset_parameters(void)
     preset->videoParameters.phase              = ui->parameterGrid_videoParams->value("Phase");
     preset->videoParameters.verticalPosition   = ui->parameterGrid_videoParams->value("Ver. position");
 
+    preset->hasCaptureRegion = ui->groupBox_captureRegion->isChecked();
+    preset->captureRegion.x  = unsigned(ui->spinBox_captureRegionX->value());
+    preset->captureRegion.y  = unsigned(ui->spinBox_captureRegionY->value());
+    preset->captureRegion.w  = unsigned(ui->spinBox_captureRegionWidth->value());
+    preset->captureRegion.h  = unsigned(ui->spinBox_captureRegionHeight->value());
+
     kc_evVideoPresetParamsChanged.fire(preset);
 
     return;
@@ -679,6 +717,24 @@ void VideoParameterDialog::update_preset_controls_with_current_preset_data(void)
             ui->parameterGrid_videoParams->set_value("Blue ct.", currentParams.blueContrast);
         }
 
+        // Capture region.
+        {
+            const auto &region = preset->captureRegion;
+
+            ui->spinBox_captureRegionX->setMaximum(std::max(ui->spinBox_captureRegionX->maximum(), int(region.x)));
+            ui->spinBox_captureRegionY->setMaximum(std::max(ui->spinBox_captureRegionY->maximum(), int(region.y)));
+            ui->spinBox_captureRegionWidth->setMinimum(std::min(ui->spinBox_captureRegionWidth->minimum(), int(region.w)));
+            ui->spinBox_captureRegionWidth->setMaximum(std::max(ui->spinBox_captureRegionWidth->maximum(), int(region.w)));
+            ui->spinBox_captureRegionHeight->setMinimum(std::min(ui->spinBox_captureRegionHeight->minimum(), int(region.h)));
+            ui->spinBox_captureRegionHeight->setMaximum(std::max(ui->spinBox_captureRegionHeight->maximum(), int(region.h)));
+
+            ui->groupBox_captureRegion->setChecked(preset->hasCaptureRegion);
+            ui->spinBox_captureRegionX->setValue(int(region.x));
+            ui->spinBox_captureRegionY->setValue(int(region.y));
+            ui->spinBox_captureRegionWidth->setValue(int(region.w));
+            ui->spinBox_captureRegionHeight->setValue(int(region.h));
+        }
+
         CONTROLS_LIVE_UPDATE = true;
     }
 
@@ -8,12 +8,47 @@
 
 #include <QSettings>
 #include "display/qt/persistent_settings.h"
+#include "common/command_line/command_line.h"
 
 static QSettings SETTINGS_FILE("vcs.ini", QSettings::IniFormat);
 
 void kpers_initialize(void)
 {
-    /// Nothing at the moment.
+    // Capture thread settings not given on the command line may come from the
+    // ini file. These need to be known before the capture subsystem starts, so
+    // unlike other settings they can't wait for the GUI to restore them.
+    {
+        if (!kcom_is_capture_thread_cpu_given() &&
+            kpers_contains(INI_GROUP_CAPTURE, "thread_cpu"))
+        {
+            kcom_override_capture_thread_cpu(kpers_value_of(INI_GROUP_CAPTURE, "thread_cpu").toInt());
+        }
+
+        if (!kcom_is_capture_thread_scheduling_given())
+        {
+            const QString scheduling = kpers_value_of(INI_GROUP_CAPTURE, "thread_scheduling").toString();
+
+            if (scheduling == "fifo")
+            {
+                kcom_override_capture_thread_scheduling(capture_thread_scheduling_e::fifo);
+            }
+            else if (scheduling == "rr")
+            {
+                kcom_override_capture_thread_scheduling(capture_thread_scheduling_e::round_robin);
+            }
+        }
+
+        if (!kcom_is_capture_thread_priority_given() &&
+            kpers_contains(INI_GROUP_CAPTURE, "thread_priority"))
+        {
+            kcom_override_capture_thread_priority(kpers_value_of(INI_GROUP_CAPTURE, "thread_priority").toInt());
+        }
+
+        if (!kcom_is_lock_capture_memory_given())
+        {
+            kcom_override_lock_capture_memory(kpers_value_of(INI_GROUP_CAPTURE, "lock_memory", false).toBool());
+        }
+    }
 
     return;
 }
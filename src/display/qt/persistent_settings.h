@@ -20,6 +20,11 @@
 #define INI_GROUP_VIDEO_PRESETS         "VIDEO_PRESETS"
 #define INI_GROUP_FILTER_GRAPH          "FILTER_GRAPH"
 #define INI_GROUP_ALIAS_RESOLUTIONS     "ALIAS_RESOLUTIONS"
+#define INI_GROUP_CAPTURE               "CAPTURE"
+
+// Applies the settings that need to be in effect before VCS's subsystems are
+// initialized. Should be called after the command line has been parsed.
+void kpers_initialize(void);
 
 QVariant kpers_value_of(const QString &group, const QString &name, const QVariant &defaultValue = QVariant());
 
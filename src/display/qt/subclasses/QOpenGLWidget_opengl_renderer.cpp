@@ -11,6 +11,7 @@
 #include <QOpenGLWidget>
 #include <QMatrix4x4>
 #include "display/qt/subclasses/QOpenGLWidget_opengl_renderer.h"
+#include "display/display.h"
 #include "capture/capture.h"
 #include "common/globals.h"
 #include "scaler/scaler.h"
@@ -93,6 +94,8 @@ void OGLWidget::paintGL()
             glTexCoord2i(1, 0); glVertex2i(this->width(), 0);
             glTexCoord2i(0, 0); glVertex2i(0,             0);
         glEnd();
+
+        kd_report_frame_presented(frame);
     }
 
     // Draw the overlay, if any.
@@ -34,7 +34,7 @@ PropertyTable::PropertyTable(QWidget *parent) : QTableWidget(parent)
     return;
 }
 
-void PropertyTable::modify_property(QString propertyName, QString value)
+void PropertyTable::modify_property(QString propertyName, QString value, QString toolTip)
 {
     // Row index in the table of the item with the given property name.
     int rowIdx = 0;
@@ -56,7 +56,12 @@ void PropertyTable::modify_property(QString propertyName, QString value)
     }
 
     modify_property:
-    this->setItem(rowIdx, 1, new QTableWidgetItem(value));
+    {
+        auto *const valueItem = new QTableWidgetItem(value);
+
+        valueItem->setToolTip(toolTip);
+        this->setItem(rowIdx, 1, valueItem);
+    }
 
     return;
 }
@@ -22,8 +22,9 @@ public:
     explicit PropertyTable(QWidget *parent = 0);
 
     // Adds a property with the given name and value; or if a property by this
-    // name already exists in the table, modifies its value.
-    void modify_property(QString propertyName, QString value);
+    // name already exists in the table, modifies its value. The tooltip, if
+    // given, is shown when hovering over the value.
+    void modify_property(QString propertyName, QString value, QString toolTip = "");
 
 private:
 };
@@ -13,6 +13,7 @@
 #include <QWidget>
 #include <QTimer>
 #include "common/globals.h"
+#include "common/latency/latency_tracker.h"
 
 class set_qcombobox_idx_c
 {
@@ -45,4 +46,18 @@ private:
     QComboBox *const targetBox;
 };
 
+// Returns the given latency statistics as a GUI-displayable string of the form
+// "min / average / 99th percentile ms".
+inline QString latency_stats_to_qstring(const latency_stats_s &stats)
+{
+    if (!stats.numSamples)
+    {
+        return "-";
+    }
+
+    return QString("%1 / %2 / %3 ms").arg(QString::number(stats.minMs, 'f', 1))
+                                     .arg(QString::number(stats.avgMs, 'f', 1))
+                                     .arg(QString::number(stats.p99Ms, 'f', 1));
+}
+
 #endif
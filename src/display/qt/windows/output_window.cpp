@@ -46,6 +46,7 @@
 #include "display/qt/dialogs/about_dialog.h"
 #include "display/qt/persistent_settings.h"
 #include "anti_tear/anti_tear.h"
+#include "deinterlace/deinterlace.h"
 #include "common/propagate/vcs_event.h"
 #include "capture/video_presets.h"
 #include "capture/capture.h"
@@ -179,8 +180,6 @@ MainWindow::MainWindow(QWidget *parent) :
 
             QMenu *deinterlacing = new QMenu("De-interlacing", this);
             {
-                deinterlacing->setEnabled(kc_device_supports_deinterlacing());
-
                 QActionGroup *group = new QActionGroup(this);
 
                 QAction *weave = new QAction("Weave", this);
@@ -188,6 +187,9 @@ MainWindow::MainWindow(QWidget *parent) :
                 weave->setCheckable(true);
                 deinterlacing->addAction(weave);
 
+                // Selects the capture device's bob de-interlacing, or, when
+                // applied in VCS, the alternating-field mode that approximates
+                // it at the frame rate (see deinterlacing_mode_e).
                 QAction *bob = new QAction("Bob", this);
                 bob->setActionGroup(group);
                 bob->setCheckable(true);
@@ -203,42 +205,72 @@ MainWindow::MainWindow(QWidget *parent) :
                 field1->setCheckable(true);
                 deinterlacing->addAction(field1);
 
-                const auto set_mode = [=](const capture_deinterlacing_mode_e mode)
+                QAction *motionAdaptive = new QAction("Motion adaptive", this);
+                motionAdaptive->setActionGroup(group);
+                motionAdaptive->setCheckable(true);
+                deinterlacing->addAction(motionAdaptive);
+
+                deinterlacing->addSeparator();
+
+                // Whether VCS de-interlaces the frames itself rather than
+                // leaving it to the capture device. Capture devices that can't
+                // de-interlace always leave it to VCS, and only VCS provides
+                // motion-adaptive de-interlacing.
+                QAction *inVcs = new QAction("Apply in VCS", this);
+                inVcs->setCheckable(true);
+                inVcs->setChecked(kpers_value_of(INI_GROUP_OUTPUT, "deinterlace_in_vcs", false).toBool() ||
+                                  !kc_device_supports_deinterlacing());
+                inVcs->setEnabled(kc_device_supports_deinterlacing());
+                deinterlacing->addAction(inVcs);
+
+                const auto apply_mode = [=](const deinterlacing_mode_e mode)
                 {
-                    switch (mode)
+                    const bool isAppliedInVcs = (inVcs->isChecked() || (mode == deinterlacing_mode_e::motion_adaptive));
+
+                    if (kc_device_supports_deinterlacing())
                     {
-                        case capture_deinterlacing_mode_e::bob:
-                        {
-                            kc_set_deinterlacing_mode(capture_deinterlacing_mode_e::bob);
-                            kpers_set_value(INI_GROUP_OUTPUT, "interlacing_mode", "Bob");
-                            break;
-                        }
-                        case capture_deinterlacing_mode_e::weave:
-                        {
-                            kc_set_deinterlacing_mode(capture_deinterlacing_mode_e::weave);
-                            kpers_set_value(INI_GROUP_OUTPUT, "interlacing_mode", "Weave");
-                            break;
-                        }
-                        case capture_deinterlacing_mode_e::field_0:
+                        switch (isAppliedInVcs? deinterlacing_mode_e::weave : mode)
                         {
-                            kc_set_deinterlacing_mode(capture_deinterlacing_mode_e::field_0);
-                            kpers_set_value(INI_GROUP_OUTPUT, "interlacing_mode", "Field 1");
-                            break;
-                        }
-                        case capture_deinterlacing_mode_e::field_1:
-                        {
-                            kc_set_deinterlacing_mode(capture_deinterlacing_mode_e::field_1);
-                            kpers_set_value(INI_GROUP_OUTPUT, "interlacing_mode", "Field 2");
-                            break;
+                            case deinterlacing_mode_e::alternating_field: kc_set_deinterlacing_mode(capture_deinterlacing_mode_e::bob); break;
+                            case deinterlacing_mode_e::field_0: kc_set_deinterlacing_mode(capture_deinterlacing_mode_e::field_0); break;
+                            case deinterlacing_mode_e::field_1: kc_set_deinterlacing_mode(capture_deinterlacing_mode_e::field_1); break;
+                            default: kc_set_deinterlacing_mode(capture_deinterlacing_mode_e::weave); break;
                         }
+                    }
+
+                    kdi_set_deinterlacing_mode(isAppliedInVcs? mode : deinterlacing_mode_e::weave);
+                };
+
+                const auto set_mode = [=](const deinterlacing_mode_e mode)
+                {
+                    switch (mode)
+                    {
+                        case deinterlacing_mode_e::alternating_field: kpers_set_value(INI_GROUP_OUTPUT, "interlacing_mode", "Bob"); break;
+                        case deinterlacing_mode_e::weave: kpers_set_value(INI_GROUP_OUTPUT, "interlacing_mode", "Weave"); break;
+                        case deinterlacing_mode_e::field_0: kpers_set_value(INI_GROUP_OUTPUT, "interlacing_mode", "Field 1"); break;
+                        case deinterlacing_mode_e::field_1: kpers_set_value(INI_GROUP_OUTPUT, "interlacing_mode", "Field 2"); break;
+                        case deinterlacing_mode_e::motion_adaptive: kpers_set_value(INI_GROUP_OUTPUT, "interlacing_mode", "Motion adaptive"); break;
                         default: k_assert(0, "Unknown deinterlacing mode."); break;
                     }
+
+                    apply_mode(mode);
                 };
 
-                connect(bob, &QAction::triggered, this, [=]{set_mode(capture_deinterlacing_mode_e::bob);});
-                connect(weave, &QAction::triggered, this, [=]{set_mode(capture_deinterlacing_mode_e::weave);});
-                connect(field0, &QAction::triggered, this, [=]{set_mode(capture_deinterlacing_mode_e::field_0);});
-                connect(field1, &QAction::triggered, this, [=]{set_mode(capture_deinterlacing_mode_e::field_1);});
+                connect(bob, &QAction::triggered, this, [=]{set_mode(deinterlacing_mode_e::alternating_field);});
+                connect(weave, &QAction::triggered, this, [=]{set_mode(deinterlacing_mode_e::weave);});
+                connect(field0, &QAction::triggered, this, [=]{set_mode(deinterlacing_mode_e::field_0);});
+                connect(field1, &QAction::triggered, this, [=]{set_mode(deinterlacing_mode_e::field_1);});
+                connect(motionAdaptive, &QAction::triggered, this, [=]{set_mode(deinterlacing_mode_e::motion_adaptive);});
+
+                connect(inVcs, &QAction::triggered, this, [=](const bool isChecked)
+                {
+                    kpers_set_value(INI_GROUP_OUTPUT, "deinterlace_in_vcs", isChecked);
+
+                    if (group->checkedAction())
+                    {
+                        group->checkedAction()->trigger();
+                    }
+                });
 
                 // Activate the default setting.
                 {
@@ -250,6 +282,7 @@ MainWindow::MainWindow(QWidget *parent) :
                     else if (defaultMode.toLower() == "weave") action = weave;
                     else if (defaultMode.toLower() == "field 1") action = field0;
                     else if (defaultMode.toLower() == "field 2") action = field1;
+                    else if (defaultMode.toLower() == "motion adaptive") action = motionAdaptive;
 
                     action->trigger();
                 }
@@ -731,9 +764,13 @@ MainWindow::MainWindow(QWidget *parent) :
 
     // Listen for app events.
     {
-        ks_evNewScaledImage.listen([this]
+        // The output window shows only the current input channel.
+        ks_evNewScaledImage.listen([this](const captured_frame_s &frame)
         {
-            this->redraw();
+            if (frame.channel == kc_get_device_input_channel_idx())
+            {
+                this->redraw();
+            }
         });
 
         ks_evFramesPerSecond.listen([this](const unsigned fps)
@@ -1137,6 +1174,7 @@ void MainWindow::paintEvent(QPaintEvent *)
     if (!frameImage.isNull())
     {
         painter.drawImage(0, 0, frameImage);
+        kd_report_frame_presented(ks_frame_buffer());
     }
 
     // Draw the overlay.
@@ -69,6 +69,18 @@ void abstract_filter_c::set_parameters(const std::vector<std::pair<unsigned, dou
     return;
 }
 
+unsigned abstract_filter_c::input_channel_idx(void) const
+{
+    return this->inputChannelIdx;
+}
+
+void abstract_filter_c::set_input_channel_idx(const unsigned channelIdx)
+{
+    this->inputChannelIdx = channelIdx;
+
+    return;
+}
+
 std::vector<std::pair<unsigned, double>> abstract_filter_c::parameters(void) const
 {
     auto params = std::vector<std::pair<unsigned, double>>{};
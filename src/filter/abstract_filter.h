@@ -46,6 +46,11 @@ public:
 
     void set_parameters(const std::vector<std::pair<unsigned, double>> &parameters);
 
+    // The index of the input channel whose frames the filter is applied to.
+    unsigned input_channel_idx(void) const;
+
+    void set_input_channel_idx(const unsigned channelIdx);
+
     virtual abstract_filter_c* create_clone(void) const = 0;
 
     virtual std::string name(void) const = 0;
@@ -89,6 +94,8 @@ protected:
 
 private:
     std::vector<double> parameterValues;
+
+    unsigned inputChannelIdx = 0;
 };
 
 #endif
@@ -11,6 +11,7 @@
 #include <functional>
 #include <cstring>
 #include <vector>
+#include <map>
 #include <cmath>
 #include "display/display.h"
 #include "capture/capture.h"
@@ -33,6 +34,13 @@ static std::vector<abstract_filter_c*> FILTER_POOL;
 // frames.
 static std::vector<std::vector<abstract_filter_c*>> FILTER_CHAINS;
 
+// Each input channel's own copies of FILTER_CHAINS, keyed by the channel's
+// index. Filters may keep state across the frames they filter (e.g. a frame
+// rate filter's history of frames), so frames from different channels are
+// filtered by different filter instances, which take their parameter values
+// from those in FILTER_CHAINS. Created on demand by channel_filter_chains().
+static std::map<unsigned, std::vector<std::vector<abstract_filter_c*>>> CHANNEL_FILTER_CHAINS;
+
 // The index in the list of filter chains of the chain that was most recently used.
 // Generally, this will be the filter chain that matches the current input/output
 // resolution.
@@ -75,9 +83,59 @@ void kf_initialize_filters(void)
     return;
 }
 
+// Deletes all per-channel copies of the filter chains, to be re-created from
+// FILTER_CHAINS as needed.
+static void release_channel_filter_chains(void)
+{
+    for (auto &channelChains: CHANNEL_FILTER_CHAINS)
+    {
+        for (auto &chain: channelChains.second)
+        {
+            for (auto *filter: chain)
+            {
+                delete filter;
+            }
+        }
+    }
+
+    CHANNEL_FILTER_CHAINS.clear();
+
+    return;
+}
+
+// Returns the given input channel's copies of FILTER_CHAINS, creating them if
+// they don't yet exist.
+static std::vector<std::vector<abstract_filter_c*>>& channel_filter_chains(const unsigned channelIdx)
+{
+    auto &chains = CHANNEL_FILTER_CHAINS[channelIdx];
+
+    if (chains.size() != FILTER_CHAINS.size())
+    {
+        for (const auto &filterChain: FILTER_CHAINS)
+        {
+            std::vector<abstract_filter_c*> chain;
+
+            for (const auto *filter: filterChain)
+            {
+                abstract_filter_c *const clone = filter->create_clone();
+                clone->set_input_channel_idx(channelIdx);
+                chain.push_back(clone);
+            }
+
+            chains.push_back(chain);
+        }
+    }
+
+    return chains;
+}
+
 // Apply to the given pixel buffer the chain of filters (if any) whose input gate
-// matches the frame's resolution and output gate that of the current output resolution.
-void kf_apply_matching_filter_chain(u8 *const pixels, const resolution_s &r)
+// matches the frame's resolution and input channel, and output gate the given
+// output resolution.
+void kf_apply_matching_filter_chain(u8 *const pixels,
+                                    const resolution_s &r,
+                                    const resolution_s &outputRes,
+                                    const unsigned channelIdx)
 {
     if (!FILTERING_ENABLED) return;
 
@@ -85,10 +143,25 @@ void kf_apply_matching_filter_chain(u8 *const pixels, const resolution_s &r)
 
     std::pair<const std::vector<abstract_filter_c*>*, unsigned> partialMatch = {nullptr, 0};
     std::pair<const std::vector<abstract_filter_c*>*, unsigned> openMatch = {nullptr, 0};
-    const resolution_s outputRes = ks_output_resolution();
 
-    static const auto apply_chain = [&pixels, &r](const std::vector<abstract_filter_c*> &chain, const unsigned idx)
+    // The GUI's indication of the most recently used chain follows the input
+    // channel being displayed.
+    const bool isCurrentChannel = (channelIdx == kc_get_device_input_channel_idx());
+
+    const auto apply_chain = [&pixels, &r, isCurrentChannel, channelIdx](const std::vector<abstract_filter_c*> &filterChain, const unsigned idx)
     {
+        std::vector<abstract_filter_c*> &chain = channel_filter_chains(channelIdx).at(idx);
+
+        // The channel's copies of the filters follow the user's adjustments of
+        // the originals.
+        for (unsigned c = 0; c < chain.size(); c++)
+        {
+            for (unsigned p = 0; p < filterChain[c]->num_parameters(); p++)
+            {
+                chain[c]->set_parameter(p, filterChain[c]->parameter(p));
+            }
+        }
+
         // The gate filters are expected to be #first and #last, while the actual
         // applicable filters are the ones in-between.
         for (unsigned c = 1; c < (chain.size() - 1); c++)
@@ -96,7 +169,10 @@ void kf_apply_matching_filter_chain(u8 *const pixels, const resolution_s &r)
             chain[c]->apply(pixels, r);
         }
 
-        MOST_RECENT_FILTER_CHAIN_IDX = idx;
+        if (isCurrentChannel)
+        {
+            MOST_RECENT_FILTER_CHAIN_IDX = idx;
+        }
 
         return;
     };
@@ -111,13 +187,23 @@ void kf_apply_matching_filter_chain(u8 *const pixels, const resolution_s &r)
 
         const unsigned inputGateWidth = filterChain.front()->parameter(filter_input_gate_c::PARAM_WIDTH);
         const unsigned inputGateHeight = filterChain.front()->parameter(filter_input_gate_c::PARAM_HEIGHT);
+        const unsigned inputGateChannel = filterChain.front()->parameter(filter_input_gate_c::PARAM_CHANNEL);
 
         const unsigned outputGateWidth = filterChain.back()->parameter(filter_output_gate_c::PARAM_WIDTH);
         const unsigned outputGateHeight = filterChain.back()->parameter(filter_output_gate_c::PARAM_HEIGHT);
 
+        // An input gate channel of 0 means pass frames from all input channels.
+        // Otherwise, it's the 1-indexed channel whose frames to pass.
+        if (inputGateChannel &&
+            (inputGateChannel != (channelIdx + 1)))
+        {
+            continue;
+        }
+
         // A gate size of 0 in either dimension means pass all values. Otherwise, the
         // value must match the corresponding size of the frame or output.
-        if (!inputGateWidth &&
+        if (!inputGateChannel &&
+            !inputGateWidth &&
             !inputGateHeight &&
             !outputGateWidth &&
             !outputGateHeight)
@@ -167,6 +253,7 @@ void kf_register_filter_chain(std::vector<abstract_filter_c*> newChain)
              "Detected a malformed filter chain.");
 
     FILTER_CHAINS.push_back(newChain);
+    release_channel_filter_chains();
 
     return;
 }
@@ -174,6 +261,7 @@ void kf_register_filter_chain(std::vector<abstract_filter_c*> newChain)
 void kf_unregister_all_filter_chains(void)
 {
     FILTER_CHAINS.clear();
+    release_channel_filter_chains();
     MOST_RECENT_FILTER_CHAIN_IDX = -1;
 
     return;
@@ -233,6 +321,8 @@ void kf_release_filters(void)
 
     MOST_RECENT_FILTER_CHAIN_IDX = -1;
 
+    release_channel_filter_chains();
+
     for (auto *filter: FILTER_POOL)
     {
         delete filter;
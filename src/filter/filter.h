@@ -97,7 +97,7 @@
  *      @code
  *      kc_evNewCapturedFrame.listen([](const captured_frame_s &frame)
  *      {
- *          kf_apply_matching_filter_chain(frame.pixels.data(), frame.r);
+ *          kf_apply_matching_filter_chain(frame.pixels.data(), frame.r, ks_output_resolution(), frame.channel);
  *      });
  *      @endcode
  * 
@@ -414,9 +414,16 @@ void kf_unregister_all_filter_chains(void);
 /*!
  * Applies to the @p pixels of an image of resolution @p r the first filter chain
  * registered with kf_register_filter_chain() whose input condition matches @p r
- * and whose output condition matches the scaler subsystem's current output
- * resolution. If there's no chain that matches these conditions, no chain will
- * be applied.
+ * and whose output condition matches @p outputRes, the resolution to which the
+ * image will be scaled. If there's no chain that matches these conditions, no
+ * chain will be applied.
+ * 
+ * @p channelIdx is the index of the input channel the image was captured from.
+ * Chains whose input condition names a specific channel are only applied to
+ * that channel's images. Each input channel's images are filtered by its own
+ * copies of the chains' filters, so that the state filters keep across frames
+ * (e.g. for frame rate or frame delta filtering) is never shared between
+ * channels.
  * 
  * If the filter subsystem is disabled, or if there are no registered filter
  * chains, calling this function has no effect.
@@ -428,7 +435,10 @@ void kf_unregister_all_filter_chains(void);
  * @see
  * kf_register_filter_chain(), ks_output_resolution(), kf_set_filtering_enabled()
  */
-void kf_apply_matching_filter_chain(u8 *const pixels, const resolution_s &r);
+void kf_apply_matching_filter_chain(u8 *const pixels,
+                                    const resolution_s &r,
+                                    const resolution_s &outputRes,
+                                    const unsigned channelIdx);
 
 /*!
  * Returns a list of the filter types that're available via this subsystem
@@ -11,6 +11,7 @@
 #include "anti_tear/anti_tear.h"
 #include "filter/abstract_filter.h"
 #include "filter/filters/anti_tear/gui/filtergui_anti_tear.h"
+#include "anti_tear/anti_tearer.h"
 
 class filter_anti_tear_c : public abstract_filter_c
 {
@@ -48,6 +49,14 @@ public:
         this->guiDescription = new filtergui_anti_tear_c(this);
     }
 
+    ~filter_anti_tear_c(void)
+    {
+        if (this->isAntiTearerInitialized)
+        {
+            this->antiTearer.release();
+        }
+    }
+
     CLONABLE_FILTER_TYPE(filter_anti_tear_c)
 
     std::string uuid(void) const override { return "11c27e0a-a000-41e9-a134-7579073c7dc5"; }
@@ -57,6 +66,10 @@ public:
     void apply(u8 *const pixels, const resolution_s &r) override;
 
 private:
+    // Keeps track of the tears in the frames this filter is applied to;
+    // initialized on first use.
+    anti_tearer_c antiTearer;
+    bool isAntiTearerInitialized = false;
 };
 
 #endif
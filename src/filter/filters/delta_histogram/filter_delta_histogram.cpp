@@ -19,7 +19,10 @@ void filter_delta_histogram_c::apply(u8 *const pixels, const resolution_s &r)
     this->assert_input_validity(pixels, r);
 
     #ifdef USE_OPENCV
-        static heap_mem<u8> prevFramePixels(MAX_NUM_BYTES_IN_CAPTURED_FRAME, "Delta histogram buffer");
+        if (this->prevFramePixels.is_null())
+        {
+            this->prevFramePixels.allocate(MAX_NUM_BYTES_IN_CAPTURED_FRAME, "Delta histogram buffer");
+        }
 
         const unsigned numBins = 512;
         const unsigned numColorChannels = (r.bpp / 8);
@@ -32,9 +35,9 @@ void filter_delta_histogram_c::apply(u8 *const pixels, const resolution_s &r)
         for (uint i = 0; i < (r.w * r.h); i++)
         {
             const uint idx = i * numColorChannels;
-            const uint deltaBlue = (pixels[idx + 0] - prevFramePixels[idx + 0]) + 255;
-            const uint deltaGreen = (pixels[idx + 1] - prevFramePixels[idx + 1]) + 255;
-            const uint deltaRed = (pixels[idx + 2] - prevFramePixels[idx + 2]) + 255;
+            const uint deltaBlue = (pixels[idx + 0] - this->prevFramePixels[idx + 0]) + 255;
+            const uint deltaGreen = (pixels[idx + 1] - this->prevFramePixels[idx + 1]) + 255;
+            const uint deltaRed = (pixels[idx + 2] - this->prevFramePixels[idx + 2]) + 255;
 
             k_assert(deltaBlue < numBins, "");
             k_assert(deltaGreen < numBins, "");
@@ -69,7 +72,7 @@ void filter_delta_histogram_c::apply(u8 *const pixels, const resolution_s &r)
             cv::line(output, cv::Point(x1, y1r), cv::Point(x2, y2r), cv::Scalar(0, 0, 255), 2, CV_AA);
         }
 
-        memcpy(prevFramePixels.data(), pixels, prevFramePixels.size_check(r.w * r.h * numColorChannels));
+        memcpy(this->prevFramePixels.data(), pixels, this->prevFramePixels.size_check(r.w * r.h * numColorChannels));
     #endif
 
     return;
@@ -8,6 +8,7 @@
 #ifndef VCS_FILTER_FILTERS_DELTA_HISTGRAM_FILTER_DELTA_HISTOGRAM_H
 #define VCS_FILTER_FILTERS_DELTA_HISTGRAM_FILTER_DELTA_HISTOGRAM_H
 
+#include "common/memory/heap_mem.h"
 #include "filter/abstract_filter.h"
 #include "filter/filters/delta_histogram/gui/filtergui_delta_histogram.h"
 
@@ -20,6 +21,11 @@ public:
         this->guiDescription = new filtergui_delta_histogram_c(this);
     }
 
+    ~filter_delta_histogram_c(void)
+    {
+        this->prevFramePixels.release();
+    }
+
     CLONABLE_FILTER_TYPE(filter_delta_histogram_c)
 
     void apply(u8 *const pixels, const resolution_s &r) override;
@@ -29,6 +35,9 @@ public:
     filter_category_e category(void) const override { return filter_category_e::meta; }
 
 private:
+    // The pixels of the previous frame this filter was applied to; allocated
+    // on first use.
+    heap_mem<u8> prevFramePixels;
 };
 
 #endif
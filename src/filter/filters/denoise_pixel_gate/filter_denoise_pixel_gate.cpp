@@ -14,25 +14,29 @@ void filter_denoise_pixel_gate_c::apply(u8 *const pixels, const resolution_s &r)
     this->assert_input_validity(pixels, r);
 
     const unsigned threshold = this->parameter(PARAM_THRESHOLD);
-    static heap_mem<u8> prevPixels(MAX_NUM_BYTES_IN_CAPTURED_FRAME, "Denoising filter buffer");
+
+    if (this->prevPixels.is_null())
+    {
+        this->prevPixels.allocate(MAX_NUM_BYTES_IN_CAPTURED_FRAME, "Denoising filter buffer");
+    }
 
     for (uint i = 0; i < (r.h * r.w); i++)
     {
         const u32 idx = (i * (r.bpp / 8));
 
-        if ((abs(pixels[idx + 0] - prevPixels[idx + 0]) > threshold) ||
-            (abs(pixels[idx + 1] - prevPixels[idx + 1]) > threshold) ||
-            (abs(pixels[idx + 2] - prevPixels[idx + 2]) > threshold))
+        if ((abs(pixels[idx + 0] - this->prevPixels[idx + 0]) > threshold) ||
+            (abs(pixels[idx + 1] - this->prevPixels[idx + 1]) > threshold) ||
+            (abs(pixels[idx + 2] - this->prevPixels[idx + 2]) > threshold))
         {
-            prevPixels[idx + 0] = pixels[idx + 0];
-            prevPixels[idx + 1] = pixels[idx + 1];
-            prevPixels[idx + 2] = pixels[idx + 2];
+            this->prevPixels[idx + 0] = pixels[idx + 0];
+            this->prevPixels[idx + 1] = pixels[idx + 1];
+            this->prevPixels[idx + 2] = pixels[idx + 2];
         }
         else
         {
-            pixels[idx + 0] = prevPixels[idx + 0];
-            pixels[idx + 1] = prevPixels[idx + 1];
-            pixels[idx + 2] = prevPixels[idx + 2];
+            pixels[idx + 0] = this->prevPixels[idx + 0];
+            pixels[idx + 1] = this->prevPixels[idx + 1];
+            pixels[idx + 2] = this->prevPixels[idx + 2];
         }
     }
 
@@ -8,6 +8,7 @@
 #ifndef VCS_FILTER_FILTERS_DENOISE_PIXEL_GATE_FILTER_DENOISE_PIXEL_GATE_H
 #define VCS_FILTER_FILTERS_DENOISE_PIXEL_GATE_FILTER_DENOISE_PIXEL_GATE_H
 
+#include "common/memory/heap_mem.h"
 #include "filter/abstract_filter.h"
 #include "filter/filters/denoise_pixel_gate/gui/filtergui_denoise_pixel_gate.h"
 
@@ -22,6 +23,11 @@ public:
         this->guiDescription = new filtergui_denoise_pixel_gate_c(this);
     }
 
+    ~filter_denoise_pixel_gate_c(void)
+    {
+        this->prevPixels.release();
+    }
+
     CLONABLE_FILTER_TYPE(filter_denoise_pixel_gate_c)
 
     std::string uuid(void) const override { return "94adffac-be42-43ac-9839-9cc53a6d615c"; }
@@ -31,6 +37,8 @@ public:
     void apply(u8 *const pixels, const resolution_s &r) override;
 
 private:
+    // The pixels last shown for each position; allocated on first use.
+    heap_mem<u8> prevPixels;
 };
 
 #endif
@@ -6,6 +6,7 @@
  */
 
 #include "filter/filters/frame_rate/filter_frame_rate.h"
+#include "capture/capture.h"
 
 #ifdef USE_OPENCV
     #include <opencv2/imgproc/imgproc.hpp>
@@ -15,52 +16,62 @@
 
 // Counts the number of unique frames per second, i.e. frames in which the pixels
 // change between frames by less than a set threshold (which is to account for
-// analog capture artefacts).
+// analog capture artefacts). If the capture subsystem is detecting duplicate
+// frames, its count of unique frames on the filter's input channel is shown
+// instead, since it has already compared the frames; the threshold then doesn't
+// apply, as only identical frames are considered duplicates.
 void filter_frame_rate_c::apply(u8 *const pixels, const resolution_s &r)
 {
     this->assert_input_validity(pixels, r);
 
     #ifdef USE_OPENCV
-        static heap_mem<u8> prevPixels(MAX_NUM_BYTES_IN_CAPTURED_FRAME, "Frame rate filter buffer");
-        static u32 uniqueFramesProcessed = 0;
-        static u32 uniqueFramesPerSecond = 0;
-        static auto timeElapsed = std::chrono::system_clock::now();
+        if (this->prevPixels.is_null())
+        {
+            this->prevPixels.allocate(MAX_NUM_BYTES_IN_CAPTURED_FRAME, "Frame rate filter buffer");
+        }
 
         const unsigned threshold = this->parameter(PARAM_THRESHOLD);
         const unsigned corner = this->parameter(PARAM_CORNER);
         const unsigned bgColorType = this->parameter(PARAM_BG_COLOR);
         const unsigned textColorType = this->parameter(PARAM_TEXT_COLOR);
 
-        for (u32 i = 0; i < (r.w * r.h); i++)
+        if (kc_get_duplicate_frame_handling() != duplicate_frame_handling_e::none)
         {
-            const u32 idx = (i * (r.bpp / 8));
-
-            if ((abs(pixels[idx + 0] - prevPixels[idx + 0]) >= threshold) ||
-                (abs(pixels[idx + 1] - prevPixels[idx + 1]) >= threshold) ||
-                (abs(pixels[idx + 2] - prevPixels[idx + 2]) >= threshold))
+            this->uniqueFramesPerSecond = kc_get_unique_frame_rate(this->input_channel_idx());
+        }
+        else
+        {
+            for (u32 i = 0; i < (r.w * r.h); i++)
             {
-                uniqueFramesProcessed++;
-                break;
+                const u32 idx = (i * (r.bpp / 8));
+
+                if ((abs(pixels[idx + 0] - this->prevPixels[idx + 0]) >= threshold) ||
+                    (abs(pixels[idx + 1] - this->prevPixels[idx + 1]) >= threshold) ||
+                    (abs(pixels[idx + 2] - this->prevPixels[idx + 2]) >= threshold))
+                {
+                    this->uniqueFramesProcessed++;
+                    break;
+                }
             }
-        }
 
-        memcpy(prevPixels.data(),
-               pixels,
-               prevPixels.size_check(r.w * r.h * (r.bpp / 8)));
+            memcpy(this->prevPixels.data(),
+                   pixels,
+                   this->prevPixels.size_check(r.w * r.h * (r.bpp / 8)));
 
-        const auto timeNow = std::chrono::system_clock::now();
-        const double secsElapsed = (std::chrono::duration_cast<std::chrono::milliseconds>(timeNow - timeElapsed).count() / 1000.0);
-        if (secsElapsed >= 1)
-        {
-            uniqueFramesPerSecond = std::round(uniqueFramesProcessed / secsElapsed);
-            uniqueFramesProcessed = 0;
-            timeElapsed = std::chrono::system_clock::now();
+            const auto timeNow = std::chrono::system_clock::now();
+            const double secsElapsed = (std::chrono::duration_cast<std::chrono::milliseconds>(timeNow - this->timeElapsed).count() / 1000.0);
+            if (secsElapsed >= 1)
+            {
+                this->uniqueFramesPerSecond = std::round(this->uniqueFramesProcessed / secsElapsed);
+                this->uniqueFramesProcessed = 0;
+                this->timeElapsed = std::chrono::system_clock::now();
+            }
         }
 
         // Draw the counter into the frame.
         {
             const unsigned margin = 7;
-            std::string counterString = std::to_string(uniqueFramesPerSecond);
+            std::string counterString = std::to_string(this->uniqueFramesPerSecond);
             cv::Size textSize = cv::getTextSize(counterString, cv::FONT_HERSHEY_DUPLEX, 1, 2, nullptr);
             cv::Mat output = cv::Mat(r.h, r.w, CV_8UC4, pixels);
 
@@ -9,6 +9,7 @@
 #define VCS_FILTER_FILTERS_FRAME_RATE_FILTER_FRAME_RATE_H
 
 #include <chrono>
+#include "common/memory/heap_mem.h"
 #include "filter/abstract_filter.h"
 #include "filter/filters/frame_rate/gui/filtergui_frame_rate.h"
 
@@ -44,6 +45,11 @@ public:
         this->guiDescription = new filtergui_frame_rate_c(this);
     }
 
+    ~filter_frame_rate_c(void)
+    {
+        this->prevPixels.release();
+    }
+
     CLONABLE_FILTER_TYPE(filter_frame_rate_c)
 
     std::string uuid(void) const override { return "badb0129-f48c-4253-a66f-b0ec94e225a0"; }
@@ -53,6 +59,13 @@ public:
     void apply(u8 *const pixels, const resolution_s &r) override;
 
 private:
+    // The pixels of the previous frame this filter was applied to; allocated
+    // on first use.
+    heap_mem<u8> prevPixels;
+
+    u32 uniqueFramesProcessed = 0;
+    u32 uniqueFramesPerSecond = 0;
+    std::chrono::system_clock::time_point timeElapsed = std::chrono::system_clock::now();
 };
 
 #endif
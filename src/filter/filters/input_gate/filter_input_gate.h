@@ -15,11 +15,17 @@ class filter_input_gate_c : public abstract_filter_c
 {
 public:
     enum { PARAM_WIDTH,
-           PARAM_HEIGHT };
+           PARAM_HEIGHT,
+           PARAM_CHANNEL };
+
+    // The largest input channel index (1-indexed) selectable for PARAM_CHANNEL,
+    // whose value of 0 means any channel.
+    static const unsigned maxChannel = 8;
 
     filter_input_gate_c(const std::vector<std::pair<unsigned, double>> &initialParamValues = {}) :
         abstract_filter_c({{PARAM_WIDTH, 640},
-                           {PARAM_HEIGHT, 480}},
+                           {PARAM_HEIGHT, 480},
+                           {PARAM_CHANNEL, 0}},
                           initialParamValues)
     {
         this->guiDescription = new filtergui_input_gate_c(this);
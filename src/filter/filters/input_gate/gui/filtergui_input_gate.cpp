@@ -30,5 +30,20 @@ filtergui_input_gate_c::filtergui_input_gate_c(abstract_filter_c *const filter)
         this->guiFields.push_back({"", {width, separator, height}});
     }
 
+    {
+        auto *const channel = new filtergui_combobox_s;
+
+        channel->get_value = [=]{return filter->parameter(filter_input_gate_c::PARAM_CHANNEL);};
+        channel->set_value = [=](const double value){filter->set_parameter(filter_input_gate_c::PARAM_CHANNEL, value);};
+        channel->items = {"Any"};
+
+        for (unsigned i = 1; i <= filter_input_gate_c::maxChannel; i++)
+        {
+            channel->items.push_back("#" + std::to_string(i));
+        }
+
+        this->guiFields.push_back({"Channel", {channel}});
+    }
+
     return;
 }
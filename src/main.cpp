@@ -7,7 +7,8 @@
 #if (!defined(CAPTURE_DEVICE_VIRTUAL) &&\
      !defined(CAPTURE_DEVICE_VISION_V4L) &&\
      !defined(CAPTURE_DEVICE_RGBEASY) &&\
-     !defined(CAPTURE_DEVICE_DOSBOX_MMAP))
+     !defined(CAPTURE_DEVICE_DOSBOX_MMAP) &&\
+     !defined(CAPTURE_DEVICE_REPLAY))
     #error "Unrecognized value for the capture device toggle"
 #endif
 
@@ -15,8 +16,10 @@
 #include <thread>
 #include <mutex>
 #include "display/qt/windows/output_window.h"
+#include "display/qt/persistent_settings.h"
 #include "common/command_line/command_line.h"
 #include "anti_tear/anti_tear.h"
+#include "deinterlace/deinterlace.h"
 #include "common/propagate/vcs_event.h"
 #include "capture/capture.h"
 #include "display/display.h"
@@ -47,6 +50,7 @@ static void cleanup_all(void)
     ks_release_scaler();
     kc_release_capture();
     kat_release_anti_tear();
+    kdi_release_deinterlacer();
     kf_release_filters();
     kvideopreset_release();
     krecord_release();
@@ -97,6 +101,7 @@ static bool initialize_all(void)
     if (!PROGRAM_EXIT_REQUESTED) ks_initialize_scaler();
     if (!PROGRAM_EXIT_REQUESTED) kc_initialize_capture();
     if (!PROGRAM_EXIT_REQUESTED) kat_initialize_anti_tear();
+    if (!PROGRAM_EXIT_REQUESTED) kdi_initialize_deinterlacer();
     if (!PROGRAM_EXIT_REQUESTED) kf_initialize_filters();
 
     // Ideally, do these last.
@@ -108,83 +113,107 @@ static bool initialize_all(void)
     return !PROGRAM_EXIT_REQUESTED;
 }
 
-static capture_event_e process_next_capture_event(void)
+// Handles the capture events that have accumulated since the previous call.
+// Returns true if there were any events other than idling ones.
+static bool process_capture_events(void)
 {
     std::lock_guard<std::mutex> lock(kc_capture_mutex());
 
-    const capture_event_e e = kc_pop_capture_event_queue();
+    static capture_event_s events[32];
 
-    switch (e)
-    {
-        case capture_event_e::unrecoverable_error:
-        {
-            NBENE(("The capture device has reported an unrecoverable error."));
+    // Clear the signal before draining, so that any event that arrives after
+    // this point will signal again and wake the main loop.
+    kc_clear_capture_event_signal();
 
-            kc_evUnrecoverableError.fire();
+    const unsigned numEvents = kc_drain_capture_event_queue(events, NUM_ELEMENTS(events));
+    bool hadEvents = false;
 
-            break;
-        }
-        case capture_event_e::new_frame:
+    for (unsigned i = 0; i < numEvents; i++)
+    {
+        switch (events[i].type)
         {
-            if (kc_has_valid_signal())
+            case capture_event_e::unrecoverable_error:
             {
-                const auto &frame = kc_get_frame_buffer();
-                kc_evNewCapturedFrame.fire(frame);
-            }
+                NBENE(("The capture device has reported an unrecoverable error."));
 
-            kc_mark_frame_buffer_as_processed();
+                kc_evUnrecoverableError.fire();
 
-            break;
-        }
-        case capture_event_e::new_video_mode:
-        {
-            if (kc_has_valid_signal())
-            {
-                kc_evNewProposedVideoMode.fire(kc_get_capture_video_mode());
+                break;
             }
+            case capture_event_e::new_frame:
+            {
+                // The capture subsystem only reports frames from concurrently-
+                // captured input channels while they have a valid signal.
+                const unsigned channelIdx = events[i].channel;
+                const bool isCurrentChannel = (channelIdx == kc_get_device_input_channel_idx());
 
-            break;
-        }
-        case capture_event_e::signal_lost:
-        {
-            kc_evSignalLost.fire();
-            break;
-        }
-        case capture_event_e::signal_gained:
-        {
-            kc_evSignalGained.fire();
-            break;
-        }
-        case capture_event_e::invalid_signal:
-        {
-            kc_evInvalidSignal.fire();
-            break;
-        }
-        case capture_event_e::invalid_device:
-        {
-            kc_evInvalidDevice.fire();
-            break;
-        }
-        case capture_event_e::sleep:
-        {
-            std::this_thread::sleep_for(std::chrono::milliseconds(4)); /// TODO. Is 4 the best wait-time?
+                if (!isCurrentChannel ||
+                    kc_has_valid_signal())
+                {
+                    const auto &frame = kc_get_frame_buffer(channelIdx);
+                    kc_evNewCapturedFrame.fire(frame);
+                }
 
-            break;
-        }
-        case capture_event_e::none:
-        {
-            /// TODO. Technically we might loop until we get an event other than
-            /// none, but for now we just move on.
+                kc_mark_frame_buffer_as_processed(channelIdx);
 
-            break;
-        }
-        default:
-        {
-            k_assert(0, "Unhandled capture event.");
+                break;
+            }
+            case capture_event_e::new_video_mode:
+            {
+                if (kc_has_valid_signal())
+                {
+                    kc_evNewProposedVideoMode.fire(kc_get_capture_video_mode());
+                }
+
+                break;
+            }
+            case capture_event_e::signal_lost:
+            {
+                kc_evSignalLost.fire();
+                break;
+            }
+            case capture_event_e::signal_gained:
+            {
+                kc_evSignalGained.fire();
+                break;
+            }
+            case capture_event_e::invalid_signal:
+            {
+                kc_evInvalidSignal.fire();
+                break;
+            }
+            case capture_event_e::invalid_device:
+            {
+                kc_evInvalidDevice.fire();
+                break;
+            }
+            case capture_event_e::sleep:
+            {
+                // If the capture subsystem can wake us up, the main loop will
+                // wait for it to do so.
+                if (kc_capture_event_fd() < 0)
+                {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(4)); /// TODO. Is 4 the best wait-time?
+                }
+
+                break;
+            }
+            case capture_event_e::none:
+            {
+                break;
+            }
+            default:
+            {
+                k_assert(0, "Unhandled capture event.");
+            }
         }
+
+        hadEvents = (hadEvents ||
+                     ((events[i].type != capture_event_e::none) &&
+                      (events[i].type != capture_event_e::sleep)));
     }
 
-    return e;
+    return hadEvents;
 }
 
 // Load in any data files that the user requested via the command-line.
@@ -225,6 +254,9 @@ int main(int argc, char *argv[])
         return 1;
     }
 
+    INFO(("Loading persistent settings."));
+    kpers_initialize();
+
     INFO(("Initializing VCS."));
     if (!initialize_all())
     {
@@ -253,9 +285,18 @@ int main(int argc, char *argv[])
 
         while (!PROGRAM_EXIT_REQUESTED)
         {
-            process_next_capture_event();
+            const bool hadCaptureEvents = process_capture_events();
             kt_update_timers();
             kd_spin_event_loop();
+
+            // If there's nothing more to do for now, block until the capture
+            // subsystem has a new event for us, the GUI needs attention, or
+            // a timer is due to fire.
+            if ((kc_capture_event_fd() >= 0) &&
+                !hadCaptureEvents)
+            {
+                kd_wait_for_events(kt_ms_until_next_timeout());
+            }
         }
     }
 
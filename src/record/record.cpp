@@ -51,7 +51,8 @@ void krecord_initialize(void)
 
     ks_evNewScaledImage.listen([](const captured_frame_s &frame)
     {
-        if (krecord_is_recording())
+        if (krecord_is_recording() &&
+            (frame.channel == kc_get_device_input_channel_idx()))
         {
             krecord_record_frame(frame);
         }
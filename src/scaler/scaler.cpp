@@ -9,8 +9,11 @@
 #include <algorithm>
 #include <cstring>
 #include <vector>
+#include <unordered_map>
 #include <cmath>
+#include <chrono>
 #include "anti_tear/anti_tear.h"
+#include "deinterlace/deinterlace.h"
 #include "common/propagate/vcs_event.h"
 #include "capture/capture.h"
 #include "display/display.h"
@@ -20,6 +23,7 @@
 #include "record/record.h"
 #include "scaler/scaler.h"
 #include "common/timer/timer.h"
+#include "common/command_line/command_line.h"
 
 #ifdef USE_OPENCV
     #include <opencv2/imgproc/imgproc.hpp>
@@ -27,11 +31,12 @@
 #endif
 
 // The arguments taken by scaling functions.
-#define SCALER_FUNC_PARAMS u8 *const pixelData, const resolution_s &srcResolution, const resolution_s &dstResolution
+#define SCALER_FUNC_PARAMS u8 *const pixelData, u8 *const dstPixels, const resolution_s &srcResolution, const resolution_s &dstResolution
 
 vcs_event_c<const resolution_s&> ks_evNewOutputResolution;
 
 // The most recent captured frame has now been processed and is ready for display.
+// The frame's 'channel' identifies the input channel it was captured from.
 vcs_event_c<const captured_frame_s&> ks_evNewScaledImage;
 
 // The number of frames processed (see newFrame) in the last second.
@@ -72,6 +77,13 @@ static const image_scaler_s *CUR_DOWNSCALER = nullptr;
 // The frame buffer where scaled frames are to be placed.
 static captured_frame_s FRAME_BUFFER;
 
+// Frame buffers for the scaled frames of input channels being captured
+// concurrently with the current one (see kc_open_concurrent_input_channel()),
+// keyed by channel index. Allocated as needed.
+static std::unordered_map<unsigned, captured_frame_s*> CONCURRENT_FRAME_BUFFERS;
+
+static latency_tracker_c CAPTURE_TO_SCALE_LATENCY;
+
 // Scratch buffers.
 static heap_mem<u8> COLORCONV_BUFFER;
 static heap_mem<u8> TMP_BUFFER;
@@ -119,20 +131,11 @@ resolution_s ks_base_resolution(void)
     return RESOLUTION_OVERRIDE;
 }
 
-// Returns the resolution at which the scaler will output after performing all the actions
-// (e.g. relative scaling or aspect ratio correction) that it has been asked to.
+// Returns the resolution at which a frame of the given resolution would be
+// output.
 //
-resolution_s ks_output_resolution(void)
+static resolution_s output_resolution_of(const resolution_s &inRes)
 {
-    // While recording video, the output resolution is required to stay locked
-    // to the video resolution.
-    if (krecord_is_recording())
-    {
-        const auto r = krecord_video_resolution();
-        return {r.w, r.h, OUTPUT_BIT_DEPTH};
-    }
-
-    resolution_s inRes = kc_get_capture_resolution();
     resolution_s outRes = inRes;
 
     // Base resolution.
@@ -174,11 +177,89 @@ resolution_s ks_output_resolution(void)
     return outRes;
 }
 
+// Returns the resolution at which the scaler will output after performing all the actions
+// (e.g. relative scaling or aspect ratio correction) that it has been asked to.
+//
+resolution_s ks_output_resolution(void)
+{
+    // While recording video, the output resolution is required to stay locked
+    // to the video resolution.
+    if (krecord_is_recording())
+    {
+        const auto r = krecord_video_resolution();
+        return {r.w, r.h, OUTPUT_BIT_DEPTH};
+    }
+
+    return output_resolution_of(kc_get_capture_resolution());
+}
+
 bool ks_is_aspect_ratio_enabled(void)
 {
     return IS_ASPECT_RATIO_ENABLED;
 }
 
+// If hardware scaling is enabled (see kcom_hardware_scaling()), asks the capture
+// device to deliver the current channel's frames already scaled down to the
+// given output resolution, so that we only need to copy them. We leave it to
+// software when the scaling would involve more than a plain resize, e.g.
+// aspect ratio correction; when filtering is enabled, as filter chains are
+// matched against the capture resolution; and when de-interlacing or anti-
+// tearing in VCS, as they need the frame's rows as captured.
+//
+// Since each change in the requested resolution has the capture device
+// reconfigure its stream, a new resolution is only requested once the output
+// resolution has settled on it (e.g. once the user has finished resizing the
+// output window). Hardware scaling is turned off without delay, though.
+static void update_hardware_scaling(const resolution_s &outputRes)
+{
+    static const auto settleTime = std::chrono::milliseconds(500);
+    static resolution_s requestedRes = {0, 0, 0};
+    static resolution_s pendingRes = {0, 0, 0};
+    static auto pendingSince = std::chrono::steady_clock::now();
+    const resolution_s captureRes = kc_get_capture_resolution();
+    const resolution_s minRes = kc_get_device_minimum_resolution();
+    resolution_s targetRes = {0, 0, 0};
+
+    if (kcom_hardware_scaling() &&
+        !kf_is_filtering_enabled() &&
+        (kdi_deinterlacing_mode() == deinterlacing_mode_e::weave) &&
+        !kat_is_anti_tear_enabled() &&
+        (outputRes.w <= captureRes.w) &&
+        (outputRes.h <= captureRes.h) &&
+        (outputRes.w >= minRes.w) &&
+        (outputRes.h >= minRes.h) &&
+        ((outputRes.w != captureRes.w) || (outputRes.h != captureRes.h)) &&
+        (!IS_ASPECT_RATIO_ENABLED ||
+         ((ASPECT_RATIO == scaler_aspect_ratio_e::native) &&
+          (resolution_to_aspect(outputRes) == resolution_to_aspect(captureRes)))))
+    {
+        targetRes = outputRes;
+    }
+
+    if ((targetRes.w == requestedRes.w) &&
+        (targetRes.h == requestedRes.h))
+    {
+        pendingRes = requestedRes;
+        return;
+    }
+
+    if ((targetRes.w != pendingRes.w) ||
+        (targetRes.h != pendingRes.h))
+    {
+        pendingRes = targetRes;
+        pendingSince = std::chrono::steady_clock::now();
+    }
+
+    if (!targetRes.w ||
+        ((std::chrono::steady_clock::now() - pendingSince) >= settleTime))
+    {
+        kc_set_hardware_scaling_resolution(targetRes);
+        requestedRes = targetRes;
+    }
+
+    return;
+}
+
 #if USE_OPENCV
 // Returns a resolution corresponding to srcResolution scaled up to dstResolution but
 // maintaining srcResolution's aspect ratio according to the scaler's current aspect
@@ -292,12 +373,10 @@ void s_scaler_nearest(SCALER_FUNC_PARAMS)
     }
 
     #if USE_OPENCV
-        opencv_scale(pixelData, FRAME_BUFFER.pixels.data(), srcResolution, dstResolution, cv::INTER_NEAREST);
+        opencv_scale(pixelData, dstPixels, srcResolution, dstResolution, cv::INTER_NEAREST);
     #else
         double deltaW = (srcResolution.w / double(dstResolution.w));
         double deltaH = (srcResolution.h / double(dstResolution.h));
-        u8 *const dst = FRAME_BUFFER.pixels.data();
-
         for (uint y = 0; y < dstResolution.h; y++)
         {
             for (uint x = 0; x < dstResolution.w; x++)
@@ -305,7 +384,7 @@ void s_scaler_nearest(SCALER_FUNC_PARAMS)
                 const uint dstIdx = ((x + y * dstResolution.w) * 4);
                 const uint srcIdx = ((uint(x * deltaW) + uint(y * deltaH) * srcResolution.w) * 4);
 
-                memcpy(&dst[dstIdx], &pixelData[srcIdx], 4);
+                memcpy(&dstPixels[dstIdx], &pixelData[srcIdx], 4);
             }
         }
     #endif
@@ -323,7 +402,7 @@ void s_scaler_linear(SCALER_FUNC_PARAMS)
     }
 
     #if USE_OPENCV
-        opencv_scale(pixelData, FRAME_BUFFER.pixels.data(), srcResolution, dstResolution, cv::INTER_LINEAR);
+        opencv_scale(pixelData, dstPixels, srcResolution, dstResolution, cv::INTER_LINEAR);
     #else
         k_assert(0, "Attempted to use a scaling filter that hasn't been implemented for non-OpenCV builds.");
     #endif
@@ -341,7 +420,7 @@ void s_scaler_area(SCALER_FUNC_PARAMS)
     }
 
     #if USE_OPENCV
-        opencv_scale(pixelData, FRAME_BUFFER.pixels.data(), srcResolution, dstResolution, cv::INTER_AREA);
+        opencv_scale(pixelData, dstPixels, srcResolution, dstResolution, cv::INTER_AREA);
     #else
         k_assert(0, "Attempted to use a scaling filter that hasn't been implemented for non-OpenCV builds.");
     #endif
@@ -359,7 +438,7 @@ void s_scaler_cubic(SCALER_FUNC_PARAMS)
     }
 
     #if USE_OPENCV
-        opencv_scale(pixelData, FRAME_BUFFER.pixels.data(), srcResolution, dstResolution, cv::INTER_CUBIC);
+        opencv_scale(pixelData, dstPixels, srcResolution, dstResolution, cv::INTER_CUBIC);
     #else
         k_assert(0, "Attempted to use a scaling filter that hasn't been implemented for non-OpenCV builds.");
     #endif
@@ -378,7 +457,7 @@ void s_scaler_lanczos(SCALER_FUNC_PARAMS)
     }
 
     #if USE_OPENCV
-        opencv_scale(pixelData, FRAME_BUFFER.pixels.data(), srcResolution, dstResolution, cv::INTER_LANCZOS4);
+        opencv_scale(pixelData, dstPixels, srcResolution, dstResolution, cv::INTER_LANCZOS4);
     #else
         k_assert(0, "Attempted to use a scaling filter that hasn't been implemented for non-OpenCV builds.");
     #endif
@@ -439,9 +518,12 @@ void ks_initialize_scaler(void)
         kd_evDirty.fire();
     });
 
-    ks_evNewScaledImage.listen([]
+    ks_evNewScaledImage.listen([](const captured_frame_s &frame)
     {
-        NUM_FRAMES_SCALED_PER_SECOND++;
+        if (frame.channel == kc_get_device_input_channel_idx())
+        {
+            NUM_FRAMES_SCALED_PER_SECOND++;
+        }
     });
 
     kt_timer(1000, [](const unsigned)
@@ -462,6 +544,14 @@ void ks_release_scaler(void)
     FRAME_BUFFER.pixels.release();
     TMP_BUFFER.release();
 
+    for (auto &frameBuffer: CONCURRENT_FRAME_BUFFERS)
+    {
+        frameBuffer.second->pixels.release();
+        delete frameBuffer.second;
+    }
+
+    CONCURRENT_FRAME_BUFFERS.clear();
+
     return;
 }
 
@@ -521,19 +611,54 @@ void s_convert_frame_to_bgra(const captured_frame_s &frame)
     return;
 }
 
+// Returns the frame buffer into which to scale the frames of the given input
+// channel.
+static captured_frame_s& frame_buffer_of(const unsigned channelIdx)
+{
+    if (channelIdx == kc_get_device_input_channel_idx())
+    {
+        return FRAME_BUFFER;
+    }
+
+    captured_frame_s *&frameBuffer = CONCURRENT_FRAME_BUFFERS[channelIdx];
+
+    if (!frameBuffer)
+    {
+        frameBuffer = new captured_frame_s;
+        frameBuffer->pixels.allocate(MAX_NUM_BYTES_IN_OUTPUT_FRAME, "Scaler output buffer (concurrent channel)");
+        frameBuffer->pixelFormat = capture_pixel_format_e::rgb_888;
+        frameBuffer->r = {0, 0, 0};
+        frameBuffer->channel = channelIdx;
+    }
+
+    return *frameBuffer;
+}
+
 // Takes the given image and scales it according to the scaler's current internal
 // resolution settings. The scaled image is placed in the scaler's internal buffer,
 // not in the source buffer.
 //
+// Frames from input channels other than the current one are scaled into buffers
+// of their own, and at an output resolution derived from their own resolution.
+//
 void ks_scale_frame(const captured_frame_s &frame)
 {
+    const bool isCurrentChannel = (frame.channel == kc_get_device_input_channel_idx());
+    captured_frame_s &dstFrame = frame_buffer_of(frame.channel);
     u8 *pixelData = frame.pixels.data();
     resolution_s frameRes = frame.r; /// Temp hack. May want to modify the .bpp value.
-    resolution_s outputRes = ks_output_resolution();
+    resolution_s outputRes = (isCurrentChannel? ks_output_resolution() : output_resolution_of(frame.r));
 
     const resolution_s minres = kc_get_device_minimum_resolution();
     const resolution_s maxres = kc_get_device_maximum_resolution();
 
+    // Frames the capture device has already scaled to the output resolution
+    // will be passed through below without being scaled again.
+    if (isCurrentChannel)
+    {
+        update_hardware_scaling(outputRes);
+    }
+
     // Verify that we have a workable frame.
     {
         if ((frame.r.bpp != 16) &&
@@ -556,7 +681,8 @@ void ks_scale_frame(const captured_frame_s &frame)
             NBENE(("Was asked to scale a null frame. Ignoring it."));
             goto done;
         }
-        else if (frame.pixelFormat != kc_get_capture_pixel_format())
+        else if ((frame.pixelFormat != kc_get_capture_pixel_format()) &&
+                 (frame.pixelFormat != capture_pixel_format_e::rgb_888))
         {
             NBENE(("Was asked to scale a frame whose pixel format differed from the expected. Ignoring it."));
             goto done;
@@ -581,12 +707,38 @@ void ks_scale_frame(const captured_frame_s &frame)
                    frame.r.w, frame.r.h, maxres.w, maxres.h));
             goto done;
         }
-        else if (FRAME_BUFFER.pixels.is_null())
+        else if (dstFrame.pixels.is_null())
         {
             goto done;
         }
     }
 
+    // A duplicate of the frame we scaled last would come out as the image we
+    // already have, so we pass that on again instead of processing the frame;
+    // unless the output size has since changed, or the processing depends on
+    // more than the frame itself.
+    if (frame.isDuplicate &&
+        dstFrame.sequence &&
+        (frame.sequence == (dstFrame.sequence + 1)) &&
+        (frame.channel == dstFrame.channel) &&
+        (outputRes.w == dstFrame.r.w) &&
+        (outputRes.h == dstFrame.r.h) &&
+        (kdi_deinterlacing_mode() == deinterlacing_mode_e::weave) &&
+        !kat_is_anti_tear_enabled())
+    {
+        dstFrame.timestamp = frame.timestamp;
+        dstFrame.sequence = frame.sequence;
+
+        if (isCurrentChannel)
+        {
+            CAPTURE_TO_SCALE_LATENCY.add_sample(frame.timestamp);
+        }
+
+        ks_evNewScaledImage.fire(dstFrame);
+
+        goto done;
+    }
+
     // If needed, convert the color data to BGRA, which is what the scaling filters
     // expect to receive. Note that this will only happen if the frame's bit depth
     // doesn't match with the expected value - a frame with the same bit depth but
@@ -600,11 +752,13 @@ void ks_scale_frame(const captured_frame_s &frame)
         pixelData = COLORCONV_BUFFER.data();
     }
 
-    pixelData = kat_anti_tear(pixelData, frameRes);
+    pixelData = kdi_deinterlace(pixelData, frameRes, frame.channel);
+
+    pixelData = kat_anti_tear(pixelData, frameRes, frame.channel);
 
     /// TODO: If anti-tearing has visualization options turned on, we'd ideally
     /// draw them AFTER applying filtering.
-    kf_apply_matching_filter_chain(pixelData, frameRes);
+    kf_apply_matching_filter_chain(pixelData, frameRes, outputRes, frame.channel);
 
     // Scale the frame to the desired output size.
     {
@@ -613,7 +767,7 @@ void ks_scale_frame(const captured_frame_s &frame)
             frameRes.w == outputRes.w &&
             frameRes.h == outputRes.h)
         {
-            memcpy(FRAME_BUFFER.pixels.data(), pixelData, FRAME_BUFFER.pixels.size_check(frameRes.w * frameRes.h * (frameRes.bpp / 8)));
+            memcpy(dstFrame.pixels.data(), pixelData, dstFrame.pixels.size_check(frameRes.w * frameRes.h * (frameRes.bpp / 8)));
         }
         else
         {
@@ -634,22 +788,35 @@ void ks_scale_frame(const captured_frame_s &frame)
                 NBENE(("Upscale or downscale filter is null. Refusing to scale."));
 
                 outputRes = frameRes;
-                memcpy(FRAME_BUFFER.pixels.data(), pixelData, FRAME_BUFFER.pixels.size_check(frameRes.w * frameRes.h * (frameRes.bpp / 8)));
+                memcpy(dstFrame.pixels.data(), pixelData, dstFrame.pixels.size_check(frameRes.w * frameRes.h * (frameRes.bpp / 8)));
             }
             else
             {
-                scaler->scale(pixelData, frameRes, outputRes);
+                scaler->scale(pixelData, dstFrame.pixels.data(), frameRes, outputRes);
             }
         }
 
-        if ((FRAME_BUFFER.r.w != outputRes.w) ||
-            (FRAME_BUFFER.r.h != outputRes.h))
+        if ((dstFrame.r.w != outputRes.w) ||
+            (dstFrame.r.h != outputRes.h))
         {
-            ks_evNewOutputResolution.fire(outputRes);
-            FRAME_BUFFER.r = outputRes;
+            if (isCurrentChannel)
+            {
+                ks_evNewOutputResolution.fire(outputRes);
+            }
+
+            dstFrame.r = outputRes;
+        }
+
+        dstFrame.timestamp = frame.timestamp;
+        dstFrame.sequence = frame.sequence;
+        dstFrame.channel = frame.channel;
+
+        if (isCurrentChannel)
+        {
+            CAPTURE_TO_SCALE_LATENCY.add_sample(frame.timestamp);
         }
 
-        ks_evNewScaledImage.fire(ks_frame_buffer());
+        ks_evNewScaledImage.fire(dstFrame);
     }
 
     done:
@@ -709,6 +876,10 @@ static void clear_frame_buffer(void)
 
     memset(FRAME_BUFFER.pixels.data(), 0, FRAME_BUFFER.pixels.size_check(MAX_NUM_BYTES_IN_OUTPUT_FRAME));
 
+    // The buffer no longer holds a captured image.
+    FRAME_BUFFER.timestamp = {};
+    FRAME_BUFFER.sequence = 0;
+
     return;
 }
 
@@ -731,6 +902,11 @@ const captured_frame_s& ks_frame_buffer(void)
     return FRAME_BUFFER;
 }
 
+latency_stats_s ks_capture_to_scale_latency(void)
+{
+    return CAPTURE_TO_SCALE_LATENCY.stats();
+}
+
 // Returns a list of GUI-displayable names of the scaling filters that're
 // available.
 //
@@ -62,6 +62,7 @@
 
 #include "common/globals.h"
 #include "common/propagate/vcs_event.h"
+#include "common/latency/latency_tracker.h"
 
 struct captured_frame_s;
 
@@ -83,6 +84,11 @@ extern vcs_event_c<const resolution_s&> ks_evNewOutputResolution;
 /*!
  * An event fired when the scaler subsystem has finished scaling a frame.
  * 
+ * The scaled frame's @a channel is that of the captured frame it was scaled
+ * from. Frames from input channels other than the current one (see
+ * kc_open_concurrent_input_channel()) are scaled into buffers of their own,
+ * which remain valid until the channel's next frame is scaled.
+ * 
  * @code
  * ks_evNewScaledImage.listen([](const captured_frame_s &scaledImage)
  * {
@@ -189,6 +195,10 @@ void ks_release_scaler(void);
  * 
  * After this call, the scaled image is available via ks_frame_buffer().
  * 
+ * A frame flagged as a duplicate of its channel's previous frame (see
+ * captured_frame_s::isDuplicate) isn't processed again if the previous frame's
+ * scaled image is still current; that image is passed on again instead.
+ * 
  * @code
  * ks_scale_frame(frame);
  * const auto &scaledFrame = ks_frame_buffer();
@@ -350,6 +360,19 @@ void ks_indicate_invalid_signal(void);
  */
 const captured_frame_s& ks_frame_buffer(void);
 
+/*!
+ * Returns statistics of the time elapsed between the capture of recent frames
+ * and their having been scaled by ks_scale_frame().
+ * 
+ * The scaled image in the subsystem's frame buffer inherits the timestamp and
+ * sequence number of the frame it was scaled from, so the latency of later
+ * stages of processing can be measured in the same way.
+ * 
+ * @see
+ * ks_scale_frame(), kd_capture_to_present_latency()
+ */
+latency_stats_s ks_capture_to_scale_latency(void);
+
 /*!
  * Returns the name of the current upscaling filter.
  * 
@@ -9,6 +9,17 @@ DEFINES += USE_OPENCV
 linux {
     DEFINES += CAPTURE_DEVICE_VISION_V4L
 
+    # Uncomment to run the capture code against an emulated Vision capture card
+    # instead of real hardware, e.g. for testing or profiling on a machine without
+    # the card or its driver. The emulated card's inputs replace /dev/videoX, and
+    # are configured via environment variables (see src/capture/vision_v4l/mock/
+    # v4l_mock_device.h). Stand-ins for the driver's header files are provided.
+    #DEFINES += MOCK_V4L_DEVICE
+
+    contains(DEFINES, MOCK_V4L_DEVICE) {
+        INCLUDEPATH += $$PWD/src/capture/vision_v4l/mock/
+    }
+
     # The base path for Datapath's Linux Vision driver header files. These are
     # bundled with the driver downloadable from Datapath's website. The files
     # are expected to be in a visionrgb subdirectory of this path e.g.
@@ -115,7 +126,14 @@ SOURCES += \
     src/filter/filter.cpp \
     src/common/command_line/command_line.cpp \
     src/capture/capture.cpp \
+    src/capture/captured_frame_ring.cpp \
+    src/capture/capture_event_queue.cpp \
+    src/capture/pixel_conversion.cpp \
+    src/capture/frame_hash.cpp \
+    src/capture/frame_interval_tracker.cpp \
+    src/capture/capture_thread.cpp \
     src/anti_tear/anti_tear.cpp \
+    src/deinterlace/deinterlace.cpp \
     src/display/qt/persistent_settings.cpp \
     src/common/memory/memory.cpp \
     src/record/record.cpp \
@@ -155,6 +173,7 @@ SOURCES += \
     src/record/recording_buffer.cpp \
     src/record/framerate_estimator.cpp \
     src/common/timer/timer.cpp \
+    src/common/latency/latency_tracker.cpp \
     src/display/qt/dialogs/linux_device_selector_dialog.cpp
 
 HEADERS += \
@@ -209,11 +228,18 @@ HEADERS += \
     src/filter/filters/unsharp_mask/gui/filtergui_unsharp_mask.h \
     src/scaler/scaler.h \
     src/capture/capture.h \
+    src/capture/captured_frame_ring.h \
+    src/capture/capture_event_queue.h \
+    src/capture/pixel_conversion.h \
+    src/capture/frame_hash.h \
+    src/capture/frame_interval_tracker.h \
+    src/capture/capture_thread.h \
     src/display/display.h \
     src/common/log/log.h \
     src/display/qt/dialogs/overlay_dialog.h \
     src/display/qt/dialogs/alias_dialog.h \
     src/anti_tear/anti_tear.h \
+    src/deinterlace/deinterlace.h \
     src/display/qt/dialogs/anti_tear_dialog.h \
     src/filter/filter.h \
     src/common/command_line/command_line.h \
@@ -259,6 +285,7 @@ HEADERS += \
     src/record/recording_meta.h \
     src/record/framerate_estimator.h \
     src/common/timer/timer.h \
+    src/common/latency/latency_tracker.h \
     src/display/qt/dialogs/linux_device_selector_dialog.h
 
 FORMS += \
@@ -277,7 +304,16 @@ FORMS += \
     src/display/qt/dialogs/ui/linux_device_selector_dialog.ui
 
 contains(DEFINES, CAPTURE_DEVICE_VIRTUAL) {
-    SOURCES += src/capture/virtual/capture_virtual.cpp
+    SOURCES += src/capture/virtual/capture_virtual.cpp \
+               src/capture/virtual/test_pattern.cpp
+
+    HEADERS += src/capture/virtual/test_pattern.h
+}
+
+contains(DEFINES, CAPTURE_DEVICE_REPLAY) {
+    SOURCES += src/capture/replay/capture_replay.cpp
+
+    HEADERS += src/capture/replay/frame_dump.h
 }
 
 contains(DEFINES, CAPTURE_DEVICE_DOSBOX_MMAP) {
@@ -288,10 +324,19 @@ contains(DEFINES, CAPTURE_DEVICE_DOSBOX_MMAP) {
 contains(DEFINES, CAPTURE_DEVICE_VISION_V4L) {
     SOURCES += src/capture/vision_v4l/capture_vision_v4l.cpp \
                src/capture/vision_v4l/input_channel_v4l.cpp \
-               src/capture/vision_v4l/ic_v4l_video_parameters.cpp
+               src/capture/vision_v4l/ic_v4l_video_parameters.cpp \
+               src/capture/vision_v4l/v4l_device_registry.cpp
 
     HEADERS += src/capture/vision_v4l/input_channel_v4l.h \
-               src/capture/vision_v4l/ic_v4l_video_parameters.h
+               src/capture/vision_v4l/v4l_device_registry.h \
+               src/capture/vision_v4l/ic_v4l_video_parameters.h \
+               src/capture/vision_v4l/v4l_device_io.h
+
+    contains(DEFINES, MOCK_V4L_DEVICE) {
+        SOURCES += src/capture/vision_v4l/mock/v4l_mock_device.cpp
+
+        HEADERS += src/capture/vision_v4l/mock/v4l_mock_device.h
+    }
 }
 
 contains(DEFINES, CAPTURE_DEVICE_RGBEASY) {